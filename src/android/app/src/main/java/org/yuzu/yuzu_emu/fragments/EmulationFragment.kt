@@ -491,6 +491,7 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback {
             val FPS = 1
             val FRAMETIME = 2
             val SPEED = 3
+            val GUEST_MEMORY = 4
             perfStatsUpdater = {
                 if (emulationViewModel.emulationStarted.value &&
                     !emulationViewModel.isEmulationStopping.value
@@ -499,8 +500,18 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback {
                     val cpuBackend = NativeLibrary.getCpuBackend()
                     val gpuDriver = NativeLibrary.getGpuDriver()
                     if (_binding != null) {
-                        binding.showFpsText.text =
+                        val guestMemoryMib = (perfStats[GUEST_MEMORY] / (1024 * 1024)).toLong()
+                        binding.showFpsText.text = if (guestMemoryMib > 0) {
+                            String.format(
+                                "FPS: %.1f\nRAM: %d MiB\n%s/%s",
+                                perfStats[FPS],
+                                guestMemoryMib,
+                                cpuBackend,
+                                gpuDriver
+                            )
+                        } else {
                             String.format("FPS: %.1f\n%s/%s", perfStats[FPS], cpuBackend, gpuDriver)
+                        }
                     }
                     perfStatsUpdateHandler.postDelayed(perfStatsUpdater!!, 800)
                 }
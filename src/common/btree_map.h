@@ -0,0 +1,644 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Ordered map stored as a B+ tree. Elements are kept sorted in leaves of a few cache lines that are
+ * linked to their neighbours, so a lookup touches a handful of contiguous nodes and iteration is a
+ * linear walk over arrays instead of the pointer chasing of a red-black tree.
+ *
+ * The interface mirrors std::map with these differences:
+ * - Inserting and erasing invalidate iterators and references to all elements.
+ * - Keys and values must be trivially copyable, elements are copied when nodes split and merge.
+ * - Keys must not be modified through iterators, values may be.
+ */
+template <typename Key, typename T>
+class BTreeMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<T>);
+
+    /// Nodes are sized to span a few cache lines
+    static constexpr size_t NODE_BYTES = 512;
+    static constexpr u32 LEAF_CAPACITY =
+        static_cast<u32>(std::max<size_t>(8, NODE_BYTES / sizeof(value_type)));
+    static constexpr u32 INTERNAL_CAPACITY =
+        static_cast<u32>(std::max<size_t>(8, NODE_BYTES / (sizeof(Key) + sizeof(void*))));
+    static constexpr u32 LEAF_MIN = LEAF_CAPACITY / 2;
+    static constexpr u32 INTERNAL_MIN = INTERNAL_CAPACITY / 2;
+    /// Internal nodes never drop below half their capacity, this is enough for any address space
+    static constexpr u32 MAX_HEIGHT = 16;
+
+    struct Node {
+        u32 count = 0;
+    };
+
+    struct Leaf : Node {
+        Leaf* prev = nullptr;
+        Leaf* next = nullptr;
+        std::array<value_type, LEAF_CAPACITY> values;
+    };
+
+    /// Holds count keys and count + 1 children, keys[i] is less or equal than all the keys in
+    /// children[i + 1] and greater than all the keys in children[i]
+    struct Internal : Node {
+        std::array<Key, INTERNAL_CAPACITY> keys;
+        std::array<Node*, INTERNAL_CAPACITY + 1> children;
+    };
+
+    /// Internal nodes walked from the root to a leaf and the index of the child taken on each
+    struct Path {
+        std::array<Internal*, MAX_HEIGHT> nodes;
+        std::array<u32, MAX_HEIGHT> indices;
+    };
+
+public:
+    template <bool is_const>
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = BTreeMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<is_const, const value_type*, value_type*>;
+        using reference = std::conditional_t<is_const, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        /// Allows converting an iterator to a const iterator
+        template <bool other_const>
+            requires(is_const && !other_const)
+        Iterator(const Iterator<other_const>& other)
+            : map{other.map}, leaf{other.leaf}, index{other.index} {}
+
+        reference operator*() const noexcept {
+            return leaf->values[index];
+        }
+
+        pointer operator->() const noexcept {
+            return &leaf->values[index];
+        }
+
+        Iterator& operator++() noexcept {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        Iterator& operator--() noexcept {
+            if (!leaf) {
+                leaf = map->last_leaf;
+                index = leaf->count - 1;
+            } else if (index == 0) {
+                leaf = leaf->prev;
+                index = leaf->count - 1;
+            } else {
+                --index;
+            }
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator result = *this;
+            --*this;
+            return result;
+        }
+
+        template <bool other_const>
+        bool operator==(const Iterator<other_const>& other) const noexcept {
+            return leaf == other.leaf && index == other.index;
+        }
+
+    private:
+        friend class BTreeMap;
+        template <bool>
+        friend class Iterator;
+
+        using MapPointer = std::conditional_t<is_const, const BTreeMap*, BTreeMap*>;
+
+        /// Points past the last element of a leaf are moved to the first element of the next one
+        explicit Iterator(MapPointer map_, Leaf* leaf_, u32 index_) : map{map_} {
+            if (leaf_ && index_ == leaf_->count) {
+                leaf_ = leaf_->next;
+                index_ = 0;
+            }
+            leaf = leaf_;
+            index = index_;
+        }
+
+        MapPointer map{};
+        /// Null on the end iterator
+        Leaf* leaf{};
+        u32 index{};
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    BTreeMap() = default;
+
+    BTreeMap(const BTreeMap&) = delete;
+    BTreeMap& operator=(const BTreeMap&) = delete;
+
+    BTreeMap(BTreeMap&& other) noexcept {
+        Swap(other);
+    }
+
+    BTreeMap& operator=(BTreeMap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    ~BTreeMap() {
+        clear();
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator{this, first_leaf, 0};
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator{this, first_leaf, 0};
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return iterator{this, nullptr, 0};
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator{this, nullptr, 0};
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return num_elements == 0;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return num_elements;
+    }
+
+    void clear() noexcept {
+        if (root) {
+            DeleteSubtree(root, height);
+        }
+        root = nullptr;
+        first_leaf = nullptr;
+        last_leaf = nullptr;
+        num_elements = 0;
+        height = 0;
+    }
+
+    /// Returns an iterator to the first element not less than key
+    [[nodiscard]] iterator lower_bound(const Key& key) noexcept {
+        return Bound<false>(this, key);
+    }
+
+    [[nodiscard]] const_iterator lower_bound(const Key& key) const noexcept {
+        return Bound<false>(this, key);
+    }
+
+    /// Returns an iterator to the first element greater than key
+    [[nodiscard]] iterator upper_bound(const Key& key) noexcept {
+        return Bound<true>(this, key);
+    }
+
+    [[nodiscard]] const_iterator upper_bound(const Key& key) const noexcept {
+        return Bound<true>(this, key);
+    }
+
+    [[nodiscard]] iterator find(const Key& key) noexcept {
+        const iterator it = lower_bound(key);
+        return it != end() && !(key < it->first) ? it : end();
+    }
+
+    [[nodiscard]] const_iterator find(const Key& key) const noexcept {
+        const const_iterator it = lower_bound(key);
+        return it != end() && !(key < it->first) ? it : end();
+    }
+
+    [[nodiscard]] bool contains(const Key& key) const noexcept {
+        return find(key) != end();
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        if (!root) {
+            Leaf* const leaf = new Leaf;
+            root = leaf;
+            first_leaf = leaf;
+            last_leaf = leaf;
+        }
+        Path path;
+        Leaf* leaf = Descend(key, path);
+        u32 pos = LeafLowerBound(leaf, key);
+        if (pos < leaf->count && !(key < leaf->values[pos].first)) {
+            return {iterator{this, leaf, pos}, false};
+        }
+        const value_type value{key, T(std::forward<Args>(args)...)};
+        if (leaf->count == LEAF_CAPACITY) {
+            Leaf* const right = SplitLeaf(leaf, pos);
+            if (pos >= leaf->count) {
+                pos -= leaf->count;
+                leaf = right;
+            }
+            InsertIntoLeaf(leaf, pos, value);
+            InsertIntoParents(path, right->values[0].first, right);
+        } else {
+            InsertIntoLeaf(leaf, pos, value);
+        }
+        ++num_elements;
+        return {iterator{this, leaf, pos}, true};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(const Key& key, Args&&... args) {
+        return try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if (!result.second) {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    /// Erases the element at pos, returns an iterator to the element that followed it
+    iterator erase(const_iterator pos) {
+        return EraseFromLeaf(pos, 1);
+    }
+
+    /// Erases the elements in [first, last), returns an iterator to the element that followed them
+    iterator erase(const_iterator first, const_iterator last) {
+        const bool to_end = last == end();
+        const Key last_key = to_end ? Key{} : last->first;
+        iterator it{this, first.leaf, first.index};
+        while (it != end() && (to_end || it->first < last_key)) {
+            // Elements are removed a leaf at a time
+            const u32 leaf_end = to_end ? it.leaf->count : LeafLowerBound(it.leaf, last_key);
+            it = EraseFromLeaf(it, leaf_end - it.index);
+        }
+        return it;
+    }
+
+    size_t erase(const Key& key) {
+        const const_iterator it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+private:
+    template <bool upper, typename MapPointer>
+    static auto Bound(MapPointer map, const Key& key) noexcept {
+        using ResultIterator =
+            std::conditional_t<std::is_const_v<std::remove_pointer_t<MapPointer>>, const_iterator,
+                               iterator>;
+        if (!map->root) {
+            return ResultIterator{map, nullptr, 0};
+        }
+        Path path;
+        Leaf* const leaf = map->Descend(key, path);
+        const u32 pos = upper ? LeafUpperBound(leaf, key) : LeafLowerBound(leaf, key);
+        return ResultIterator{map, leaf, pos};
+    }
+
+    /// Returns the number of leading elements of the range satisfying pred, which must hold for a
+    /// prefix of the range. The search is branchless, the next probe doesn't wait on a mispredict.
+    template <typename ForwardIt, typename Predicate>
+    static u32 PartitionPoint(ForwardIt first, u32 count, Predicate pred) noexcept {
+        if (count == 0) {
+            return 0;
+        }
+        u32 base = 0;
+        while (count > 1) {
+            const u32 half = count / 2;
+            base = pred(first[base + half]) ? base + half : base;
+            count -= half;
+        }
+        return base + (pred(first[base]) ? 1 : 0);
+    }
+
+    static u32 LeafLowerBound(const Leaf* leaf, const Key& key) noexcept {
+        return PartitionPoint(leaf->values.begin(), leaf->count,
+                              [&key](const value_type& value) { return value.first < key; });
+    }
+
+    static u32 LeafUpperBound(const Leaf* leaf, const Key& key) noexcept {
+        return PartitionPoint(leaf->values.begin(), leaf->count,
+                              [&key](const value_type& value) { return !(key < value.first); });
+    }
+
+    /// Walks from the root to the leaf where key belongs, recording the path taken
+    Leaf* Descend(const Key& key, Path& path) const noexcept {
+        Node* node = root;
+        for (u32 level = 0; level < height; ++level) {
+            Internal* const internal = static_cast<Internal*>(node);
+            const u32 index = PartitionPoint(internal->keys.begin(), internal->count,
+                                             [&key](const Key& other) { return !(key < other); });
+            path.nodes[level] = internal;
+            path.indices[level] = index;
+            node = internal->children[index];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    /// Erases count elements of a leaf starting at pos and rebalances the tree
+    iterator EraseFromLeaf(const_iterator pos, u32 count) {
+        const Key key = pos->first;
+        Path path;
+        Leaf* const leaf = Descend(key, path);
+        DEBUG_ASSERT(leaf == pos.leaf && pos.index + count <= leaf->count);
+        const u32 index = pos.index;
+        std::copy(leaf->values.begin() + index + count, leaf->values.begin() + leaf->count,
+                  leaf->values.begin() + index);
+        leaf->count -= count;
+        num_elements -= count;
+        if (height == 0) {
+            if (leaf->count == 0) {
+                clear();
+                return end();
+            }
+            return iterator{this, leaf, index};
+        }
+        if (leaf->count >= LEAF_MIN) {
+            return iterator{this, leaf, index};
+        }
+        RebalanceLeaf(leaf, path);
+        return lower_bound(key);
+    }
+
+    static void InsertIntoLeaf(Leaf* leaf, u32 pos, const value_type& value) noexcept {
+        std::copy_backward(leaf->values.begin() + pos, leaf->values.begin() + leaf->count,
+                           leaf->values.begin() + leaf->count + 1);
+        leaf->values[pos] = value;
+        ++leaf->count;
+    }
+
+    /// Moves the upper half of a full leaf to a new leaf linked after it and returns the new leaf.
+    /// Appending to the last leaf keeps it full and starts an empty one instead, so trees built in
+    /// ascending order are packed.
+    Leaf* SplitLeaf(Leaf* leaf, u32 pos) {
+        const u32 split = leaf == last_leaf && pos == leaf->count ? leaf->count : leaf->count / 2;
+        Leaf* const right = new Leaf;
+        std::copy(leaf->values.begin() + split, leaf->values.begin() + leaf->count,
+                  right->values.begin());
+        right->count = leaf->count - split;
+        leaf->count = split;
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next) {
+            leaf->next->prev = right;
+        } else {
+            last_leaf = right;
+        }
+        leaf->next = right;
+        return right;
+    }
+
+    /// Inserts a new child with its separator key after the nodes of the path, splitting full
+    /// internal nodes up to the root
+    void InsertIntoParents(const Path& path, Key key, Node* child) {
+        for (u32 level = height; level-- > 0;) {
+            Internal* const node = path.nodes[level];
+            const u32 index = path.indices[level];
+            if (node->count < INTERNAL_CAPACITY) {
+                InsertIntoInternal(node, index, key, child);
+                return;
+            }
+            // Split the node with the new child in place, the middle key moves up
+            std::array<Key, INTERNAL_CAPACITY + 1> keys;
+            std::array<Node*, INTERNAL_CAPACITY + 2> children;
+            std::copy_n(node->keys.begin(), index, keys.begin());
+            keys[index] = key;
+            std::copy(node->keys.begin() + index, node->keys.end(), keys.begin() + index + 1);
+            std::copy_n(node->children.begin(), index + 1, children.begin());
+            children[index + 1] = child;
+            std::copy(node->children.begin() + index + 1, node->children.end(),
+                      children.begin() + index + 2);
+
+            constexpr u32 middle = (INTERNAL_CAPACITY + 1) / 2;
+            Internal* const right = new Internal;
+            node->count = middle;
+            std::copy_n(keys.begin(), middle, node->keys.begin());
+            std::copy_n(children.begin(), middle + 1, node->children.begin());
+            right->count = INTERNAL_CAPACITY - middle;
+            std::copy(keys.begin() + middle + 1, keys.end(), right->keys.begin());
+            std::copy(children.begin() + middle + 1, children.end(), right->children.begin());
+            key = keys[middle];
+            child = right;
+        }
+        Internal* const new_root = new Internal;
+        new_root->count = 1;
+        new_root->keys[0] = key;
+        new_root->children[0] = root;
+        new_root->children[1] = child;
+        root = new_root;
+        ++height;
+        ASSERT(height < MAX_HEIGHT);
+    }
+
+    static void InsertIntoInternal(Internal* node, u32 index, const Key& key,
+                                   Node* child) noexcept {
+        std::copy_backward(node->keys.begin() + index, node->keys.begin() + node->count,
+                           node->keys.begin() + node->count + 1);
+        std::copy_backward(node->children.begin() + index + 1,
+                           node->children.begin() + node->count + 1,
+                           node->children.begin() + node->count + 2);
+        node->keys[index] = key;
+        node->children[index + 1] = child;
+        ++node->count;
+    }
+
+    /// Removes keys[index] and children[index + 1] from an internal node
+    static void RemoveFromInternal(Internal* node, u32 index) noexcept {
+        std::copy(node->keys.begin() + index + 1, node->keys.begin() + node->count,
+                  node->keys.begin() + index);
+        std::copy(node->children.begin() + index + 2, node->children.begin() + node->count + 1,
+                  node->children.begin() + index + 1);
+        --node->count;
+    }
+
+    void UnlinkLeaf(Leaf* leaf) noexcept {
+        if (leaf->prev) {
+            leaf->prev->next = leaf->next;
+        } else {
+            first_leaf = leaf->next;
+        }
+        if (leaf->next) {
+            leaf->next->prev = leaf->prev;
+        } else {
+            last_leaf = leaf->prev;
+        }
+        delete leaf;
+    }
+
+    /// Refills a leaf that dropped below half its capacity from a sibling or merges them. Leaves
+    /// may stay below half their capacity, but never empty.
+    void RebalanceLeaf(Leaf* leaf, const Path& path) {
+        const u32 level = height - 1;
+        Internal* const parent = path.nodes[level];
+        const u32 index = path.indices[level];
+        Leaf* const left = index > 0 ? static_cast<Leaf*>(parent->children[index - 1]) : nullptr;
+        Leaf* const right =
+            index < parent->count ? static_cast<Leaf*>(parent->children[index + 1]) : nullptr;
+        if (left && left->count > LEAF_MIN) {
+            InsertIntoLeaf(leaf, 0, left->values[left->count - 1]);
+            --left->count;
+            parent->keys[index - 1] = leaf->values[0].first;
+            return;
+        }
+        if (right && right->count > LEAF_MIN) {
+            leaf->values[leaf->count++] = right->values[0];
+            std::copy(right->values.begin() + 1, right->values.begin() + right->count,
+                      right->values.begin());
+            --right->count;
+            parent->keys[index] = right->values[0].first;
+            return;
+        }
+        if (left) {
+            std::copy_n(leaf->values.begin(), leaf->count, left->values.begin() + left->count);
+            left->count += leaf->count;
+            UnlinkLeaf(leaf);
+            RemoveFromInternal(parent, index - 1);
+        } else {
+            std::copy_n(right->values.begin(), right->count, leaf->values.begin() + leaf->count);
+            leaf->count += right->count;
+            UnlinkLeaf(right);
+            RemoveFromInternal(parent, index);
+        }
+        RebalanceInternal(path, level);
+    }
+
+    /// Restores the fill of the internal node at level of the path after one of its children was
+    /// removed, walking up while merges keep emptying parents
+    void RebalanceInternal(const Path& path, u32 level) {
+        for (;; --level) {
+            Internal* const node = path.nodes[level];
+            if (level == 0) {
+                if (node->count == 0) {
+                    root = node->children[0];
+                    --height;
+                    delete node;
+                }
+                return;
+            }
+            if (node->count >= INTERNAL_MIN) {
+                return;
+            }
+            Internal* const parent = path.nodes[level - 1];
+            const u32 index = path.indices[level - 1];
+            Internal* const left =
+                index > 0 ? static_cast<Internal*>(parent->children[index - 1]) : nullptr;
+            Internal* const right =
+                index < parent->count ? static_cast<Internal*>(parent->children[index + 1])
+                                      : nullptr;
+            if (left && left->count > INTERNAL_MIN) {
+                // Rotate the last child of the left sibling through the parent
+                std::copy_backward(node->keys.begin(), node->keys.begin() + node->count,
+                                   node->keys.begin() + node->count + 1);
+                std::copy_backward(node->children.begin(),
+                                   node->children.begin() + node->count + 1,
+                                   node->children.begin() + node->count + 2);
+                node->keys[0] = parent->keys[index - 1];
+                node->children[0] = left->children[left->count];
+                ++node->count;
+                parent->keys[index - 1] = left->keys[left->count - 1];
+                --left->count;
+                return;
+            }
+            if (right && right->count > INTERNAL_MIN) {
+                // Rotate the first child of the right sibling through the parent
+                node->keys[node->count] = parent->keys[index];
+                node->children[node->count + 1] = right->children[0];
+                ++node->count;
+                parent->keys[index] = right->keys[0];
+                std::copy(right->keys.begin() + 1, right->keys.begin() + right->count,
+                          right->keys.begin());
+                std::copy(right->children.begin() + 1, right->children.begin() + right->count + 1,
+                          right->children.begin());
+                --right->count;
+                return;
+            }
+            if (left) {
+                MergeInternal(left, parent->keys[index - 1], node);
+                RemoveFromInternal(parent, index - 1);
+            } else {
+                MergeInternal(node, parent->keys[index], right);
+                RemoveFromInternal(parent, index);
+            }
+        }
+    }
+
+    /// Appends the separator and the contents of right to left and deletes right
+    static void MergeInternal(Internal* left, const Key& separator, Internal* right) noexcept {
+        left->keys[left->count] = separator;
+        std::copy_n(right->keys.begin(), right->count, left->keys.begin() + left->count + 1);
+        std::copy_n(right->children.begin(), right->count + 1,
+                    left->children.begin() + left->count + 1);
+        left->count += right->count + 1;
+        delete right;
+    }
+
+    static void DeleteSubtree(Node* node, u32 levels) noexcept {
+        if (levels == 0) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        Internal* const internal = static_cast<Internal*>(node);
+        for (u32 i = 0; i <= internal->count; ++i) {
+            DeleteSubtree(internal->children[i], levels - 1);
+        }
+        delete internal;
+    }
+
+    void Swap(BTreeMap& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(first_leaf, other.first_leaf);
+        std::swap(last_leaf, other.last_leaf);
+        std::swap(num_elements, other.num_elements);
+        std::swap(height, other.height);
+    }
+
+    Node* root = nullptr;
+    Leaf* first_leaf = nullptr;
+    Leaf* last_leaf = nullptr;
+    size_t num_elements = 0;
+    /// Number of internal levels above the leaves
+    u32 height = 0;
+};
+
+} // namespace Common
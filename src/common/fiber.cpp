@@ -2,6 +2,13 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 #include "common/assert.h"
 #include "common/fiber.h"
@@ -12,9 +19,70 @@
 namespace Common {
 
 constexpr std::size_t default_stack_size = 512 * 1024;
+/// Inaccessible region below each stack to fault on overflows, large enough for any host page size
+constexpr std::size_t stack_guard_size = 64 * 1024;
+constexpr std::size_t max_pooled_stacks = 32;
+
+namespace {
+
+/**
+ * Stacks of destroyed fibers, reused by new fibers. Guest threads are created and destroyed
+ * often, this avoids mapping, protecting and unmapping a stack and faulting its pages in for
+ * every one of them.
+ */
+class StackPool {
+public:
+    VirtualBuffer<u8> Acquire() {
+        {
+            std::scoped_lock lk{mutex};
+            if (!free_stacks.empty()) {
+                VirtualBuffer<u8> stack = std::move(free_stacks.back());
+                free_stacks.pop_back();
+                return stack;
+            }
+        }
+        VirtualBuffer<u8> stack(stack_guard_size + default_stack_size);
+#ifdef _WIN32
+        DWORD old_protect;
+        ASSERT(VirtualProtect(stack.data(), stack_guard_size, PAGE_NOACCESS, &old_protect));
+#else
+        ASSERT(mprotect(stack.data(), stack_guard_size, PROT_NONE) == 0);
+#endif
+        return stack;
+    }
+
+    void Release(VirtualBuffer<u8>&& stack) {
+        if (stack.size() == 0) {
+            return;
+        }
+        std::scoped_lock lk{mutex};
+        if (free_stacks.size() < max_pooled_stacks) {
+            free_stacks.push_back(std::move(stack));
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<VirtualBuffer<u8>> free_stacks;
+};
+
+StackPool& GetStackPool() {
+    static StackPool pool;
+    return pool;
+}
+
+/// Returns the usable bottom of a stack acquired from the pool
+u8* StackLimit(VirtualBuffer<u8>& stack) {
+    return stack.data() + stack_guard_size;
+}
+
+} // Anonymous namespace
 
 struct Fiber::FiberImpl {
-    FiberImpl() : stack{default_stack_size}, rewind_stack{default_stack_size} {}
+    ~FiberImpl() {
+        GetStackPool().Release(std::move(stack));
+        GetStackPool().Release(std::move(rewind_stack));
+    }
 
     VirtualBuffer<u8> stack;
     VirtualBuffer<u8> rewind_stack;
@@ -34,6 +102,11 @@ struct Fiber::FiberImpl {
 
 void Fiber::SetRewindPoint(std::function<void()>&& rewind_func) {
     impl->rewind_point = std::move(rewind_func);
+    // Most fibers never rewind, only give a second stack to those that can
+    if (impl->rewind_stack.size() == 0) {
+        impl->rewind_stack = GetStackPool().Acquire();
+        impl->rewind_stack_limit = StackLimit(impl->rewind_stack);
+    }
 }
 
 void Fiber::Start(boost::context::detail::transfer_t& transfer) {
@@ -68,11 +141,11 @@ void Fiber::RewindStartFunc(boost::context::detail::transfer_t transfer) {
 
 Fiber::Fiber(std::function<void()>&& entry_point_func) : impl{std::make_unique<FiberImpl>()} {
     impl->entry_point = std::move(entry_point_func);
-    impl->stack_limit = impl->stack.data();
-    impl->rewind_stack_limit = impl->rewind_stack.data();
+    impl->stack = GetStackPool().Acquire();
+    impl->stack_limit = StackLimit(impl->stack);
     u8* stack_base = impl->stack_limit + default_stack_size;
     impl->context =
-        boost::context::detail::make_fcontext(stack_base, impl->stack.size(), FiberStartFunc);
+        boost::context::detail::make_fcontext(stack_base, default_stack_size, FiberStartFunc);
 }
 
 Fiber::Fiber() : impl{std::make_unique<FiberImpl>()} {}
@@ -103,7 +176,7 @@ void Fiber::Rewind() {
     ASSERT(impl->rewind_context == nullptr);
     u8* stack_base = impl->rewind_stack_limit + default_stack_size;
     impl->rewind_context =
-        boost::context::detail::make_fcontext(stack_base, impl->stack.size(), RewindStartFunc);
+        boost::context::detail::make_fcontext(stack_base, default_stack_size, RewindStartFunc);
     boost::context::detail::jump_fcontext(impl->rewind_context, this);
 }
 
@@ -111,10 +184,14 @@ void Fiber::YieldTo(std::weak_ptr<Fiber> weak_from, Fiber& to) {
     to.impl->guard.lock();
     to.impl->previous_fiber = weak_from.lock();
 
+    // "from" might no longer be valid if the thread was killed
+    Fiber* const from = to.impl->previous_fiber.get();
+
     auto transfer = boost::context::detail::jump_fcontext(to.impl->context, &to);
 
-    // "from" might no longer be valid if the thread was killed
-    if (auto from = weak_from.lock()) {
+    // Execution only comes back here when "from" is resumed, and a fiber that is being resumed is
+    // still alive, so it does not have to be locked again
+    if (from != nullptr) {
         if (from->impl->previous_fiber == nullptr) {
             ASSERT_MSG(false, "previous_fiber is nullptr!");
             return;
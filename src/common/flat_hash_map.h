@@ -0,0 +1,631 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#include "common/common_types.h"
+#include "common/uint128.h"
+
+namespace Common {
+
+namespace FlatHashMapDetail {
+
+/// Control bytes are negative for free slots and hold the low 7 bits of the hash for used slots
+using ControlByte = s8;
+
+constexpr ControlByte CONTROL_EMPTY = -128;
+constexpr ControlByte CONTROL_DELETED = -2;
+
+constexpr size_t GROUP_SIZE = 16;
+
+/// Bit mask of the slots of a group matched by a probe
+class GroupMask {
+public:
+#if defined(ARCHITECTURE_arm64)
+    /// NEON produces four bits per slot, only the highest of them is kept
+    static constexpr int SLOT_SHIFT = 2;
+#else
+    static constexpr int SLOT_SHIFT = 0;
+#endif
+
+    explicit GroupMask(u64 mask_) : mask{mask_} {}
+
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return mask != 0;
+    }
+
+    /// Returns the index in the group of the first matched slot
+    [[nodiscard]] size_t Lowest() const noexcept {
+        return static_cast<size_t>(std::countr_zero(mask)) >> SLOT_SHIFT;
+    }
+
+    void ClearLowest() noexcept {
+        mask &= mask - 1;
+    }
+
+    /// Clears the slots of the group before slot
+    void ClearBelow(size_t slot) noexcept {
+        mask &= ~u64{0} << (slot << SLOT_SHIFT);
+    }
+
+private:
+    u64 mask;
+};
+
+struct alignas(GROUP_SIZE) ControlGroup {
+    ControlByte bytes[GROUP_SIZE];
+};
+
+/// Compares all the control bytes of a group at once
+class Group {
+public:
+    explicit Group(const ControlGroup& group) {
+#if defined(ARCHITECTURE_x86_64)
+        ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(group.bytes));
+#elif defined(ARCHITECTURE_arm64)
+        ctrl = vld1q_s8(group.bytes);
+#else
+        std::memcpy(ctrl, group.bytes, sizeof(ctrl));
+#endif
+    }
+
+    [[nodiscard]] GroupMask Match(ControlByte h2) const noexcept {
+#if defined(ARCHITECTURE_x86_64)
+        return ToMask(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#elif defined(ARCHITECTURE_arm64)
+        return ToMask(vceqq_s8(ctrl, vdupq_n_s8(h2)));
+#else
+        return MatchIf([h2](ControlByte byte) { return byte == h2; });
+#endif
+    }
+
+    [[nodiscard]] GroupMask MatchEmpty() const noexcept {
+#if defined(ARCHITECTURE_x86_64)
+        return ToMask(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(CONTROL_EMPTY)));
+#elif defined(ARCHITECTURE_arm64)
+        return ToMask(vceqq_s8(ctrl, vdupq_n_s8(CONTROL_EMPTY)));
+#else
+        return MatchIf([](ControlByte byte) { return byte == CONTROL_EMPTY; });
+#endif
+    }
+
+    [[nodiscard]] GroupMask MatchUsed() const noexcept {
+#if defined(ARCHITECTURE_x86_64)
+        return GroupMask{static_cast<u32>(_mm_movemask_epi8(ctrl)) ^ 0xFFFFU};
+#elif defined(ARCHITECTURE_arm64)
+        return ToMask(vcgezq_s8(ctrl));
+#else
+        return MatchIf([](ControlByte byte) { return byte >= 0; });
+#endif
+    }
+
+    [[nodiscard]] GroupMask MatchFree() const noexcept {
+#if defined(ARCHITECTURE_x86_64)
+        return GroupMask{static_cast<u32>(_mm_movemask_epi8(ctrl))};
+#elif defined(ARCHITECTURE_arm64)
+        return ToMask(vcltzq_s8(ctrl));
+#else
+        return MatchIf([](ControlByte byte) { return byte < 0; });
+#endif
+    }
+
+private:
+#if defined(ARCHITECTURE_x86_64)
+    static GroupMask ToMask(__m128i match) noexcept {
+        return GroupMask{static_cast<u32>(_mm_movemask_epi8(match))};
+    }
+
+    __m128i ctrl;
+#elif defined(ARCHITECTURE_arm64)
+    static GroupMask ToMask(uint8x16_t match) noexcept {
+        // Narrowing shift packs each 8-bit lane into 4 bits
+        const uint8x8_t packed = vshrn_n_u16(vreinterpretq_u16_u8(match), 4);
+        return GroupMask{vget_lane_u64(vreinterpret_u64_u8(packed), 0) & 0x8888888888888888ULL};
+    }
+
+    int8x16_t ctrl;
+#else
+    template <typename Predicate>
+    GroupMask MatchIf(Predicate&& predicate) const noexcept {
+        u64 mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            mask |= static_cast<u64>(predicate(ctrl[i])) << i;
+        }
+        return GroupMask{mask};
+    }
+
+    ControlByte ctrl[GROUP_SIZE];
+#endif
+};
+
+} // namespace FlatHashMapDetail
+
+/**
+ * Open addressing hash map storing its elements inline in a single array, following the design of
+ * SwissTable. Slots are grouped by 16 and a parallel array of control bytes holding 7 bits of the
+ * hash of each slot is probed a group at a time with SIMD compares, so most lookups touch a
+ * single cache line of metadata and a single element.
+ *
+ * The interface mirrors std::unordered_map with these differences:
+ * - Inserting may move elements, invalidating references and iterators to all elements.
+ * - Erasing never moves other elements, erasing while iterating is valid.
+ * - Iteration order is unspecified and changes when the table grows.
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+    using ControlByte = FlatHashMapDetail::ControlByte;
+    using ControlGroup = FlatHashMapDetail::ControlGroup;
+    using Group = FlatHashMapDetail::Group;
+
+    static constexpr size_t GROUP_SIZE = FlatHashMapDetail::GROUP_SIZE;
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    template <bool is_const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<is_const, const value_type*, value_type*>;
+        using reference = std::conditional_t<is_const, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        /// Allows converting an iterator to a const iterator
+        template <bool other_const>
+            requires(is_const && !other_const)
+        Iterator(const Iterator<other_const>& other)
+            : map{other.map}, index{other.index} {}
+
+        reference operator*() const noexcept {
+            return map->slots[index];
+        }
+
+        pointer operator->() const noexcept {
+            return &map->slots[index];
+        }
+
+        Iterator& operator++() noexcept {
+            index = map->NextUsed(index + 1);
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        template <bool other_const>
+        bool operator==(const Iterator<other_const>& other) const noexcept {
+            return index == other.index;
+        }
+
+    private:
+        friend class FlatHashMap;
+        template <bool>
+        friend class Iterator;
+
+        using MapPointer = std::conditional_t<is_const, const FlatHashMap*, FlatHashMap*>;
+
+        explicit Iterator(MapPointer map_, size_t index_) : map{map_}, index{index_} {}
+
+        MapPointer map{};
+        size_t index{};
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    FlatHashMap(const FlatHashMap& other) {
+        if (other.empty()) {
+            return;
+        }
+        reserve(other.num_elements);
+        for (const value_type& value : other) {
+            InsertUnique(value);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept {
+        Swap(other);
+    }
+
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            FlatHashMap copy{other};
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        if (this != &other) {
+            Release();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    ~FlatHashMap() {
+        Release();
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator{this, NextUsed(0)};
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator{this, NextUsed(0)};
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return iterator{this, capacity};
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator{this, capacity};
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return end();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return num_elements == 0;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return num_elements;
+    }
+
+    /// Destroys all elements, the allocated capacity is kept
+    void clear() noexcept {
+        if (num_elements != 0) {
+            DestroySlots();
+        }
+        ResetControl();
+    }
+
+    /// Grows the table so at least count elements can be stored without rehashing
+    void reserve(size_t count) {
+        const size_t required = CapacityFor(count);
+        if (required > capacity) {
+            Rehash(required);
+        }
+    }
+
+    [[nodiscard]] iterator find(const Key& key) noexcept {
+        return iterator{this, Find(key)};
+    }
+
+    [[nodiscard]] const_iterator find(const Key& key) const noexcept {
+        return const_iterator{this, Find(key)};
+    }
+
+    [[nodiscard]] bool contains(const Key& key) const noexcept {
+        return Find(key) != capacity;
+    }
+
+    [[nodiscard]] size_t count(const Key& key) const noexcept {
+        return contains(key) ? 1 : 0;
+    }
+
+    [[nodiscard]] T& at(const Key& key) {
+        const size_t index = Find(key);
+        if (index == capacity) {
+            throw std::out_of_range("FlatHashMap::at");
+        }
+        return slots[index].second;
+    }
+
+    [[nodiscard]] const T& at(const Key& key) const {
+        const size_t index = Find(key);
+        if (index == capacity) {
+            throw std::out_of_range("FlatHashMap::at");
+        }
+        return slots[index].second;
+    }
+
+    T& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    T& operator[](Key&& key) {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const size_t hash = HashOf(key);
+        const size_t found = Find(key, hash);
+        if (found != capacity) {
+            return {iterator{this, found}, false};
+        }
+        const size_t index = PrepareInsert(hash);
+        std::construct_at(slots + index, std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iterator{this, index}, true};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return try_emplace(value.first, std::move(value.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return try_emplace(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return try_emplace(value.first, std::move(value.second));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value) {
+        auto result = try_emplace(key, std::forward<M>(value));
+        if (!result.second) {
+            result.first->second = std::forward<M>(value);
+        }
+        return result;
+    }
+
+    /// Erases the element at position, returns an iterator to the element after it
+    iterator erase(const_iterator position) noexcept {
+        EraseAt(position.index);
+        return iterator{this, NextUsed(position.index + 1)};
+    }
+
+    iterator erase(iterator position) noexcept {
+        return erase(const_iterator{position});
+    }
+
+    size_t erase(const Key& key) noexcept {
+        const size_t index = Find(key);
+        if (index == capacity) {
+            return 0;
+        }
+        EraseAt(index);
+        return 1;
+    }
+
+private:
+    /// Maximum load is 7/8 of the capacity
+    static constexpr size_t MaxElements(size_t slot_count) noexcept {
+        return slot_count - slot_count / 8;
+    }
+
+    static constexpr size_t CapacityFor(size_t count) noexcept {
+        size_t result = GROUP_SIZE;
+        while (MaxElements(result) < count) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    /// Spreads the bits of the user hash, std::hash is the identity for integers on most hosts
+    static size_t HashOf(const Key& key) noexcept {
+        const u64 hash = static_cast<u64>(Hash{}(key));
+        const u128 product = Multiply64Into128(hash, 0x9E3779B97F4A7C15ULL);
+        return static_cast<size_t>(product[0] ^ product[1]);
+    }
+
+    static ControlByte H2(size_t hash) noexcept {
+        return static_cast<ControlByte>(hash & 0x7F);
+    }
+
+    size_t FirstGroup(size_t hash) const noexcept {
+        return (hash >> 7) & (capacity / GROUP_SIZE - 1);
+    }
+
+    /// Triangular probing visits every group once when the group count is a power of two
+    size_t NextGroup(size_t group, size_t step) const noexcept {
+        return (group + step) & (capacity / GROUP_SIZE - 1);
+    }
+
+    size_t Find(const Key& key) const noexcept {
+        return Find(key, HashOf(key));
+    }
+
+    size_t Find(const Key& key, size_t hash) const noexcept {
+        if (capacity == 0) {
+            return 0;
+        }
+        const ControlByte h2 = H2(hash);
+        size_t group = FirstGroup(hash);
+        for (size_t step = 1;; ++step) {
+            const Group probe{ctrl[group]};
+            for (auto mask = probe.Match(h2); mask; mask.ClearLowest()) {
+                const size_t index = group * GROUP_SIZE + mask.Lowest();
+                if (KeyEqual{}(slots[index].first, key)) [[likely]] {
+                    return index;
+                }
+            }
+            // Lookups of a key stop at the first group that was never full
+            if (probe.MatchEmpty()) [[likely]] {
+                return capacity;
+            }
+            group = NextGroup(group, step);
+        }
+    }
+
+    /// Returns the first free slot in the probe sequence of hash
+    size_t FindFree(size_t hash) const noexcept {
+        size_t group = FirstGroup(hash);
+        for (size_t step = 1;; ++step) {
+            const auto mask = Group{ctrl[group]}.MatchFree();
+            if (mask) {
+                return group * GROUP_SIZE + mask.Lowest();
+            }
+            group = NextGroup(group, step);
+        }
+    }
+
+    /// Marks a free slot for hash as used and returns it, growing the table when needed
+    size_t PrepareInsert(size_t hash) {
+        if (capacity == 0) {
+            Allocate(GROUP_SIZE);
+        }
+        size_t index = FindFree(hash);
+        if (growth_left == 0 && Control(index) == FlatHashMapDetail::CONTROL_EMPTY) {
+            // Rehash at the same capacity when most of the free slots are tombstones
+            const bool has_tombstones = num_elements <= MaxElements(capacity) / 2;
+            Rehash(has_tombstones ? capacity : capacity * 2);
+            index = FindFree(hash);
+        }
+        if (Control(index) == FlatHashMapDetail::CONTROL_EMPTY) {
+            --growth_left;
+        }
+        Control(index) = H2(hash);
+        ++num_elements;
+        return index;
+    }
+
+    void EraseAt(size_t index) noexcept {
+        std::destroy_at(slots + index);
+        --num_elements;
+        // Lookups never stopped at this group if it had no empty slots, those need a tombstone
+        const size_t group = index / GROUP_SIZE;
+        if (Group{ctrl[group]}.MatchEmpty()) {
+            Control(index) = FlatHashMapDetail::CONTROL_EMPTY;
+            ++growth_left;
+        } else {
+            Control(index) = FlatHashMapDetail::CONTROL_DELETED;
+        }
+    }
+
+    /// Returns the first used slot at or after index, or the capacity if there are none
+    size_t NextUsed(size_t index) const noexcept {
+        while (index < capacity) {
+            const size_t group_base = index & ~(GROUP_SIZE - 1);
+            auto used = Group{ctrl[index / GROUP_SIZE]}.MatchUsed();
+            used.ClearBelow(index - group_base);
+            if (used) {
+                return group_base + used.Lowest();
+            }
+            index = group_base + GROUP_SIZE;
+        }
+        return capacity;
+    }
+
+    ControlByte& Control(size_t index) noexcept {
+        return ctrl[index / GROUP_SIZE].bytes[index % GROUP_SIZE];
+    }
+
+    ControlByte Control(size_t index) const noexcept {
+        return ctrl[index / GROUP_SIZE].bytes[index % GROUP_SIZE];
+    }
+
+    void Rehash(size_t new_capacity) {
+        FlatHashMap old;
+        Swap(old);
+        Allocate(new_capacity);
+        if (old.num_elements == 0) {
+            return;
+        }
+        for (size_t index = old.NextUsed(0); index != old.capacity;
+             index = old.NextUsed(index + 1)) {
+            value_type& value = old.slots[index];
+            InsertUnique(std::move(value));
+            std::destroy_at(&value);
+            old.Control(index) = FlatHashMapDetail::CONTROL_EMPTY;
+        }
+        old.num_elements = 0;
+    }
+
+    /// Inserts a value whose key is known not to be in the table
+    template <typename V>
+    void InsertUnique(V&& value) {
+        const size_t hash = HashOf(value.first);
+        const size_t index = PrepareInsert(hash);
+        std::construct_at(slots + index, std::forward<V>(value));
+    }
+
+    void Allocate(size_t new_capacity) {
+        ctrl = std::make_unique<ControlGroup[]>(new_capacity / GROUP_SIZE);
+        slots = std::allocator<value_type>{}.allocate(new_capacity);
+        capacity = new_capacity;
+        ResetControl();
+    }
+
+    void ResetControl() noexcept {
+        for (size_t group = 0; group < capacity / GROUP_SIZE; ++group) {
+            std::ranges::fill(ctrl[group].bytes, FlatHashMapDetail::CONTROL_EMPTY);
+        }
+        num_elements = 0;
+        growth_left = MaxElements(capacity);
+    }
+
+    void DestroySlots() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (size_t index = NextUsed(0); index != capacity; index = NextUsed(index + 1)) {
+                std::destroy_at(slots + index);
+            }
+        }
+    }
+
+    void Release() noexcept {
+        if (capacity == 0) {
+            return;
+        }
+        DestroySlots();
+        std::allocator<value_type>{}.deallocate(slots, capacity);
+        ctrl.reset();
+        slots = nullptr;
+        capacity = 0;
+        num_elements = 0;
+        growth_left = 0;
+    }
+
+    void Swap(FlatHashMap& other) noexcept {
+        std::swap(ctrl, other.ctrl);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(num_elements, other.num_elements);
+        std::swap(growth_left, other.growth_left);
+    }
+
+    std::unique_ptr<ControlGroup[]> ctrl;
+    value_type* slots = nullptr;
+    size_t capacity = 0;
+    size_t num_elements = 0;
+    /// Number of empty slots that can be used before the table has to grow
+    size_t growth_left = 0;
+};
+
+} // namespace Common
@@ -29,3 +29,4 @@
 // uzuy-specific files
 
 #define LOG_FILE "uzuy_log.txt"
+#define LOG_BINARY_FILE "uzuy_log.bin"
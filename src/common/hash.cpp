@@ -0,0 +1,307 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstring>
+#include <iterator>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "common/uint128.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+// The long input path follows the stripe accumulation of XXH3: 64 byte stripes are folded into
+// eight 64-bit lanes with 32x32->64 multiplies, which map directly to SSE2, AVX2 and NEON. All
+// kernels produce the same result.
+
+namespace Common {
+
+namespace {
+
+constexpr u64 PRIME32_1 = 0x9E3779B1U;
+constexpr u64 PRIME32_2 = 0x85EBCA77U;
+constexpr u64 PRIME32_3 = 0xC2B2AE3DU;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr u64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+constexpr size_t NUM_LANES = 8;
+constexpr size_t STRIPE_SIZE = NUM_LANES * sizeof(u64);
+constexpr size_t SECRET_SIZE = 256;
+/// Each stripe of a block uses the secret shifted by one lane
+constexpr size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_SIZE) / sizeof(u64);
+constexpr size_t BLOCK_SIZE = STRIPE_SIZE * STRIPES_PER_BLOCK;
+/// Inputs up to this size are hashed in 16 byte chunks without stripes
+constexpr size_t MAX_MEDIUM_SIZE = SECRET_SIZE;
+
+constexpr std::array<u8, SECRET_SIZE> MakeSecret() {
+    std::array<u8, SECRET_SIZE> secret{};
+    u64 state = PRIME64_1;
+    for (size_t i = 0; i < SECRET_SIZE; i += sizeof(u64)) {
+        // splitmix64
+        u64 value = (state += 0x9E3779B97F4A7C15ULL);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+        for (size_t byte = 0; byte < sizeof(u64); ++byte) {
+            secret[i + byte] = static_cast<u8>(value >> (byte * 8));
+        }
+    }
+    return secret;
+}
+
+alignas(64) constexpr std::array<u8, SECRET_SIZE> SECRET = MakeSecret();
+
+u64 Read64(const u8* data) noexcept {
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+u64 Read32(const u8* data) noexcept {
+    u32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/// Folds the 128-bit product of a and b into 64 bits
+u64 Mix(u64 a, u64 b) noexcept {
+    const u128 product = Multiply64Into128(a, b);
+    return product[0] ^ product[1];
+}
+
+u64 Avalanche(u64 hash) noexcept {
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ULL;
+    return hash ^ (hash >> 32);
+}
+
+u64 Mix16Values(u64 low, u64 high, const u8* secret, u64 seed) noexcept {
+    return Mix(low ^ (Read64(secret) + seed), high ^ (Read64(secret + 8) - seed));
+}
+
+u64 Mix16(const u8* data, const u8* secret, u64 seed) noexcept {
+    return Mix16Values(Read64(data), Read64(data + 8), secret, seed);
+}
+
+u64 HashShort(const u8* data, size_t size, u64 seed) noexcept {
+    u64 low = 0;
+    u64 high = 0;
+    if (size >= 8) {
+        low = Read64(data);
+        high = Read64(data + size - 8);
+    } else if (size >= 4) {
+        low = Read32(data);
+        high = Read32(data + size - 4);
+    } else if (size > 0) {
+        low = (u64{data[0]} << 16) | (u64{data[size >> 1]} << 8) | data[size - 1];
+    }
+    return Avalanche(Mix16Values(low, high, SECRET.data(), seed) ^ (size * PRIME64_5));
+}
+
+u64 HashMedium(const u8* data, size_t size, u64 seed) noexcept {
+    // Chunks are taken from both ends so they always cover the whole input, the sums only depend
+    // on independent multiplies
+    const u8* const secret = SECRET.data();
+    u64 hash = size * PRIME64_1 + seed;
+    if (size > 128) {
+        const size_t num_chunks = size / 16;
+        for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+            hash += Mix16(data + chunk * 16, secret + chunk * 16, seed);
+        }
+        hash = Avalanche(hash);
+        return Avalanche(hash + Mix16(data + size - 16, secret + SECRET_SIZE - 16 - 7, seed));
+    }
+    if (size > 32) {
+        if (size > 64) {
+            if (size > 96) {
+                hash += Mix16(data + 48, secret + 96, seed);
+                hash += Mix16(data + size - 64, secret + 112, seed);
+            }
+            hash += Mix16(data + 32, secret + 64, seed);
+            hash += Mix16(data + size - 48, secret + 80, seed);
+        }
+        hash += Mix16(data + 16, secret + 32, seed);
+        hash += Mix16(data + size - 32, secret + 48, seed);
+    }
+    hash += Mix16(data, secret, seed);
+    hash += Mix16(data + size - 16, secret + 16, seed);
+    return Avalanche(hash);
+}
+
+void AccumulateScalar(u64* acc, const u8* data, const u8* secret_base,
+                      size_t num_stripes) noexcept {
+    for (size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const u8* const input = data + stripe * STRIPE_SIZE;
+        const u8* const secret = secret_base + stripe * sizeof(u64);
+        for (size_t lane = 0; lane < NUM_LANES; ++lane) {
+            const u64 value = Read64(input + lane * sizeof(u64));
+            const u64 key = value ^ Read64(secret + lane * sizeof(u64));
+            acc[lane ^ 1] += value;
+            acc[lane] += (key & 0xFFFFFFFF) * (key >> 32);
+        }
+    }
+}
+
+#if defined(ARCHITECTURE_x86_64)
+
+void AccumulateSSE2(u64* acc, const u8* data, const u8* secret_base,
+                    size_t num_stripes) noexcept {
+    __m128i lanes[4];
+    for (size_t i = 0; i < std::size(lanes); ++i) {
+        lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+    }
+    for (size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const auto* const input = reinterpret_cast<const __m128i*>(data + stripe * STRIPE_SIZE);
+        const auto* const secret =
+            reinterpret_cast<const __m128i*>(secret_base + stripe * sizeof(u64));
+        for (size_t i = 0; i < std::size(lanes); ++i) {
+            const __m128i value = _mm_loadu_si128(input + i);
+            const __m128i key = _mm_xor_si128(value, _mm_loadu_si128(secret + i));
+            const __m128i key_high = _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1));
+            const __m128i product = _mm_mul_epu32(key, key_high);
+            const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+        }
+    }
+    for (size_t i = 0; i < std::size(lanes); ++i) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, lanes[i]);
+    }
+}
+
+#ifndef _MSC_VER
+__attribute__((target("avx2")))
+#endif
+void AccumulateAVX2(u64* acc, const u8* data, const u8* secret_base,
+                    size_t num_stripes) noexcept {
+    __m256i lanes[2];
+    for (size_t i = 0; i < std::size(lanes); ++i) {
+        lanes[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+    }
+    for (size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const auto* const input = reinterpret_cast<const __m256i*>(data + stripe * STRIPE_SIZE);
+        const auto* const secret =
+            reinterpret_cast<const __m256i*>(secret_base + stripe * sizeof(u64));
+        for (size_t i = 0; i < std::size(lanes); ++i) {
+            const __m256i value = _mm256_loadu_si256(input + i);
+            const __m256i key = _mm256_xor_si256(value, _mm256_loadu_si256(secret + i));
+            const __m256i key_high = _mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1));
+            const __m256i product = _mm256_mul_epu32(key, key_high);
+            const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm256_add_epi64(lanes[i], _mm256_add_epi64(product, swapped));
+        }
+    }
+    for (size_t i = 0; i < std::size(lanes); ++i) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, lanes[i]);
+    }
+}
+
+#elif defined(ARCHITECTURE_arm64)
+
+void AccumulateNEON(u64* acc, const u8* data, const u8* secret_base,
+                    size_t num_stripes) noexcept {
+    uint64x2_t lanes[4];
+    for (size_t i = 0; i < std::size(lanes); ++i) {
+        lanes[i] = vld1q_u64(acc + i * 2);
+    }
+    for (size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const u8* const input = data + stripe * STRIPE_SIZE;
+        const u8* const secret = secret_base + stripe * sizeof(u64);
+        for (size_t i = 0; i < std::size(lanes); ++i) {
+            const uint64x2_t value = vreinterpretq_u64_u8(vld1q_u8(input + i * 16));
+            const uint64x2_t key =
+                veorq_u64(value, vreinterpretq_u64_u8(vld1q_u8(secret + i * 16)));
+            lanes[i] = vaddq_u64(lanes[i], vextq_u64(value, value, 1));
+            lanes[i] = vmlal_u32(lanes[i], vmovn_u64(key), vshrn_n_u64(key, 32));
+        }
+    }
+    for (size_t i = 0; i < std::size(lanes); ++i) {
+        vst1q_u64(acc + i * 2, lanes[i]);
+    }
+}
+
+#endif
+
+using AccumulateFunction = void (*)(u64*, const u8*, const u8*, size_t) noexcept;
+
+AccumulateFunction SelectAccumulate() {
+#if defined(ARCHITECTURE_x86_64)
+    return GetCPUCaps().avx2 ? AccumulateAVX2 : AccumulateSSE2;
+#elif defined(ARCHITECTURE_arm64)
+    return AccumulateNEON;
+#else
+    return AccumulateScalar;
+#endif
+}
+
+void Scramble(u64* acc) noexcept {
+    const u8* const secret = SECRET.data() + SECRET_SIZE - STRIPE_SIZE;
+    for (size_t lane = 0; lane < NUM_LANES; ++lane) {
+        u64 value = acc[lane];
+        value ^= value >> 47;
+        value ^= Read64(secret + lane * sizeof(u64));
+        acc[lane] = value * PRIME32_1;
+    }
+}
+
+u64 HashLong(const u8* data, size_t size, u64 seed, AccumulateFunction accumulate_fn) noexcept {
+    alignas(32) std::array<u64, NUM_LANES> acc{
+        PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1,
+    };
+    const size_t num_blocks = (size - 1) / BLOCK_SIZE;
+    for (size_t block = 0; block < num_blocks; ++block) {
+        accumulate_fn(acc.data(), data + block * BLOCK_SIZE, SECRET.data(), STRIPES_PER_BLOCK);
+        Scramble(acc.data());
+    }
+    // The partial block never includes the last byte, it's covered by the final stripe below
+    const size_t tail = num_blocks * BLOCK_SIZE;
+    accumulate_fn(acc.data(), data + tail, SECRET.data(), (size - 1 - tail) / STRIPE_SIZE);
+
+    // The final stripe uses its own secret offset so it differs from the stripes before it
+    accumulate_fn(acc.data(), data + size - STRIPE_SIZE,
+                  SECRET.data() + SECRET_SIZE - STRIPE_SIZE - 7, 1);
+
+    u64 hash = size * PRIME64_1 + seed;
+    for (size_t lane = 0; lane < NUM_LANES; lane += 2) {
+        const u8* const merge_secret = SECRET.data() + 11 + lane * sizeof(u64);
+        hash += Mix(acc[lane] ^ Read64(merge_secret),
+                    acc[lane + 1] ^ (Read64(merge_secret + 8) - seed));
+    }
+    return Avalanche(hash);
+}
+
+} // Anonymous namespace
+
+u64 HashFast64(const void* data, size_t size, u64 seed) noexcept {
+    const u8* const bytes = static_cast<const u8*>(data);
+    if (size <= 16) {
+        return HashShort(bytes, size, seed);
+    }
+    if (size <= MAX_MEDIUM_SIZE) {
+        return HashMedium(bytes, size, seed);
+    }
+    static const AccumulateFunction accumulate = SelectAccumulate();
+    return HashLong(bytes, size, seed, accumulate);
+}
+
+namespace Detail {
+
+u64 HashFast64Scalar(const void* data, size_t size, u64 seed) noexcept {
+    const u8* const bytes = static_cast<const u8*>(data);
+    if (size <= MAX_MEDIUM_SIZE) {
+        return HashFast64(data, size, seed);
+    }
+    return HashLong(bytes, size, seed, AccumulateScalar);
+}
+
+} // namespace Detail
+
+} // namespace Common
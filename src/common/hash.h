@@ -7,6 +7,8 @@
 #include <utility>
 #include <boost/functional/hash.hpp>
 
+#include "common/common_types.h"
+
 namespace Common {
 
 struct PairHash {
@@ -25,4 +27,19 @@ struct IdentityHash {
     }
 };
 
+/**
+ * Hashes data with an XXH3-class algorithm using SSE2, AVX2 or NEON when available. It is faster
+ * than CityHash64 from a few hundred bytes and about twice as fast on large inputs, but slightly
+ * slower on inputs of a few dozen bytes, where CityHash64 remains the better choice.
+ *
+ * The result may change between versions and is only meant for in-memory containers, use
+ * CityHash64 for anything stored on disk.
+ */
+[[nodiscard]] u64 HashFast64(const void* data, size_t size, u64 seed = 0) noexcept;
+
+namespace Detail {
+/// Same as HashFast64 but without vector kernels, used to test that both match
+[[nodiscard]] u64 HashFast64Scalar(const void* data, size_t size, u64 seed = 0) noexcept;
+} // namespace Detail
+
 } // namespace Common
@@ -18,6 +18,7 @@
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/random.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include "common/scope_exit.h"
 
@@ -41,6 +42,9 @@ namespace Common {
 constexpr size_t PageAlignment = 0x1000;
 constexpr size_t HugePageSize = 0x200000;
 
+// Smallest zero fill done by releasing the host pages
+constexpr size_t MinDiscardSize = 0x10000;
+
 #ifdef _WIN32
 
 // Manually imported for MinGW compatibility
@@ -189,11 +193,15 @@ public:
         }
     }
 
-    bool ClearBackingRegion(size_t physical_offset, size_t length) {
+    bool DiscardBackingRegion(size_t physical_offset, size_t length) {
         // TODO: This does not seem to be possible on Windows.
         return false;
     }
 
+    std::optional<size_t> GetCommittedSize() const {
+        return std::nullopt;
+    }
+
     void EnableDirectMappedAddress() {
         // TODO
         UNREACHABLE();
@@ -549,10 +557,10 @@ public:
         ASSERT_MSG(ret == 0, "mprotect failed: {}", strerror(errno));
     }
 
-    bool ClearBackingRegion(size_t physical_offset, size_t length) {
+    bool DiscardBackingRegion(size_t physical_offset, size_t length) {
 #ifdef __linux__
         // Set MADV_REMOVE on backing map to destroy it instantly.
-        // This also deletes the area from the backing file.
+        // This also deletes the area from the backing file, like punching a hole in it.
         int ret = madvise(backing_base + physical_offset, length, MADV_REMOVE);
         ASSERT_MSG(ret == 0, "madvise failed: {}", strerror(errno));
 
@@ -562,6 +570,15 @@ public:
 #endif
     }
 
+    std::optional<size_t> GetCommittedSize() const {
+        // Pages of the backing file are only allocated once written, and freed by holes.
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(st.st_blocks) * 512;
+    }
+
     void EnableDirectMappedAddress() {
         virtual_base = nullptr;
     }
@@ -633,10 +650,14 @@ public:
 
     void Protect(size_t virtual_offset, size_t length, bool read, bool write, bool execute) {}
 
-    bool ClearBackingRegion(size_t physical_offset, size_t length) {
+    bool DiscardBackingRegion(size_t physical_offset, size_t length) {
         return false;
     }
 
+    std::optional<size_t> GetCommittedSize() const {
+        return std::nullopt;
+    }
+
     void EnableDirectMappedAddress() {}
 
     u8* backing_base{nullptr};
@@ -715,11 +736,38 @@ void HostMemory::Protect(size_t virtual_offset, size_t length, MemoryPermission
 }
 
 void HostMemory::ClearBackingRegion(size_t physical_offset, size_t length, u32 fill_value) {
-    if (!impl || fill_value != 0 || !impl->ClearBackingRegion(physical_offset, length)) {
+    // Small regions are cheaper to write than to release and fault back in.
+    if (fill_value != 0 || length < MinDiscardSize ||
+        !this->DiscardBackingRegion(physical_offset, length)) {
         std::memset(backing_base + physical_offset, fill_value, length);
     }
 }
 
+bool HostMemory::DiscardBackingRegion(size_t physical_offset, size_t length) {
+    ASSERT(physical_offset % PageAlignment == 0);
+    ASSERT(length % PageAlignment == 0);
+    ASSERT(physical_offset + length <= backing_size);
+    if (length == 0) {
+        return true;
+    }
+    if (impl) {
+        return impl->DiscardBackingRegion(physical_offset, length);
+    }
+#ifdef __linux__
+    // The fallback buffer is private anonymous memory, which reads as zero once discarded.
+    return madvise(backing_base + physical_offset, length, MADV_DONTNEED) == 0;
+#else
+    return false;
+#endif
+}
+
+std::optional<size_t> HostMemory::GetCommittedSize() const {
+    if (impl) {
+        return impl->GetCommittedSize();
+    }
+    return std::nullopt;
+}
+
 void HostMemory::EnableDirectMappedAddress() {
     if (impl) {
         impl->EnableDirectMappedAddress();
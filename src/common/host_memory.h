@@ -4,6 +4,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/virtual_buffer.h"
@@ -49,8 +50,17 @@ public:
 
     void EnableDirectMappedAddress();
 
+    /// Fills a backing region. Large regions filled with zero have their host pages released
+    /// instead of written to.
     void ClearBackingRegion(size_t physical_offset, size_t length, u32 fill_value);
 
+    /// Releases the host pages of a backing region, which reads as zero afterwards.
+    /// Returns false, leaving the region untouched, if the host can't do it.
+    bool DiscardBackingRegion(size_t physical_offset, size_t length);
+
+    /// Returns the host memory committed to the backing buffer, if the host can tell
+    [[nodiscard]] std::optional<size_t> GetCommittedSize() const;
+
     [[nodiscard]] u8* BackingBasePointer() noexcept {
         return backing_base;
     }
@@ -371,6 +371,11 @@ private:
         return freebsd::RB_INSERT(m_impl.m_root, node, CompareImpl);
     }
 
+    constexpr void InsertBeforeImpl(IntrusiveRedBlackTreeNode* pos,
+                                    IntrusiveRedBlackTreeNode* node) {
+        freebsd::RB_INSERT_BEFORE(m_impl.m_root, pos, node);
+    }
+
     constexpr IntrusiveRedBlackTreeNode* FindImpl(IntrusiveRedBlackTreeNode const* node) const {
         return freebsd::RB_FIND(const_cast<ImplType::RootType&>(m_impl.m_root),
                                 const_cast<IntrusiveRedBlackTreeNode*>(node), CompareImpl);
@@ -469,6 +474,13 @@ public:
         return iterator(node);
     }
 
+    // Inserts ref right before pos, which the caller guarantees is where it sorts.
+    constexpr iterator insert_before(iterator pos, reference ref) {
+        ImplType::pointer node = Traits::GetNode(std::addressof(ref));
+        this->InsertBeforeImpl(Traits::GetNode(std::addressof(*pos)), node);
+        return iterator(node);
+    }
+
     constexpr iterator find(const_reference ref) const {
         return iterator(this->FindImpl(Traits::GetNode(std::addressof(ref))));
     }
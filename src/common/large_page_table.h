@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "common/virtual_buffer.h"
+
+namespace Common {
+
+/**
+ * Flat page table where an aligned block of pages holding consecutive values can be stored as a
+ * single large page entry. Page n of a large page holds base + n * step.
+ *
+ * Zero marks an unmapped page. Mapping a whole block as a large page writes one entry instead of
+ * one per page, and the per page entries of large pages are never touched, so they are not
+ * committed. Writing a single page of a large page splits it back into per page entries.
+ *
+ * A block is either a large page with all per page entries zero, or has a zero large page entry.
+ * Reads may race with writes, readers see either the old or the new entries of a page.
+ */
+template <typename Value, Value step, size_t large_page_bits>
+class LargePageTable {
+public:
+    static constexpr size_t PAGES_PER_LARGE_PAGE = 1ULL << large_page_bits;
+    static constexpr size_t LARGE_PAGE_MASK = PAGES_PER_LARGE_PAGE - 1;
+
+    explicit LargePageTable(size_t num_pages)
+        : pages(num_pages), large_pages(num_pages >> large_page_bits),
+          used_pages(num_pages >> large_page_bits) {}
+
+    /// Returns the value of a page, zero if it is unmapped
+    [[nodiscard]] Value Get(size_t page) const noexcept {
+        // The large page table is much smaller and usually stays in cache
+        const Value large = large_pages[page >> large_page_bits];
+        if (large != 0) {
+            return large + static_cast<Value>(page & LARGE_PAGE_MASK) * step;
+        }
+        return pages[page];
+    }
+
+    /// Returns true if the page is part of a large page
+    [[nodiscard]] bool IsLarge(size_t page) const noexcept {
+        return large_pages[page >> large_page_bits] != 0;
+    }
+
+    /// Sets the value of a single page, splitting the large page it belongs to
+    void Set(size_t page, Value value) noexcept {
+        Split(page);
+        if (value != 0) {
+            used_pages[page >> large_page_bits] = true;
+        }
+        pages[page] = value;
+    }
+
+    /// Maps the aligned block starting at page as a large page with the given base value
+    void SetLarge(size_t page, Value base) noexcept {
+        DEBUG_ASSERT((page & LARGE_PAGE_MASK) == 0 && base != 0);
+        large_pages[page >> large_page_bits] = base;
+        ClearPages(page);
+    }
+
+    /// Unmaps the whole aligned block starting at page
+    void ClearLarge(size_t page) noexcept {
+        DEBUG_ASSERT((page & LARGE_PAGE_MASK) == 0);
+        large_pages[page >> large_page_bits] = 0;
+        ClearPages(page);
+    }
+
+    /// Replaces the large page containing page with the equivalent per page entries
+    void Split(size_t page) noexcept {
+        Value& large = large_pages[page >> large_page_bits];
+        if (large == 0) [[likely]] {
+            return;
+        }
+        // Fill the per page entries before dropping the large one, so readers seeing a zero large
+        // page entry find the per page entries
+        const size_t first_page = page & ~LARGE_PAGE_MASK;
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+            pages[first_page + i] = large + static_cast<Value>(i) * step;
+        }
+        used_pages[page >> large_page_bits] = true;
+        large = 0;
+    }
+
+private:
+    /// Zeroes the per page entries of the aligned block starting at page
+    void ClearPages(size_t page) noexcept {
+        bool& used = used_pages[page >> large_page_bits];
+        if (!used) {
+            // Blocks that never had per page entries are not touched, to keep them uncommitted
+            return;
+        }
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+            pages[page + i] = 0;
+        }
+        used = false;
+    }
+
+    VirtualBuffer<Value> pages;
+    VirtualBuffer<Value> large_pages;
+    /// Whether each block may have nonzero per page entries
+    VirtualBuffer<bool> used_pages;
+};
+
+} // namespace Common
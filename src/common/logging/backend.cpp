@@ -1,11 +1,19 @@
 // SPDX-FileCopyrightText: 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <climits>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include <fmt/args.h>
 #include <fmt/format.h>
 
 #ifdef _WIN32
@@ -129,6 +137,10 @@ public:
         bytes_written = 0;
     }
 
+    void SetEnabled(bool enabled_) {
+        enabled = enabled_;
+    }
+
 private:
     std::unique_ptr<FS::IOFile> file;
     bool enabled = true;
@@ -175,8 +187,211 @@ public:
 };
 #endif
 
+/// Message captured on the calling thread in deferred mode. It holds either a format string and
+/// its arguments, or the formatted text of messages that could not be deferred.
+struct DeferredEntry {
+    std::chrono::microseconds timestamp{};
+    Class log_class{};
+    Level log_level{};
+    const char* filename = nullptr;
+    unsigned int line_num = 0;
+    const char* function = nullptr;
+    const char* format = nullptr;
+    size_t num_args = 0;
+    std::array<DeferredArg, MAX_DEFERRED_ARGS> args{};
+    std::string message;
+};
+
+std::string FormatDeferredMessage(const char* format, std::span<const DeferredArg> args) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    for (const DeferredArg& arg : args) {
+        switch (arg.type) {
+        case DeferredArgType::Bool:
+            store.push_back(arg.value != 0);
+            break;
+        case DeferredArgType::Char:
+            store.push_back(static_cast<char>(arg.value));
+            break;
+        case DeferredArgType::Signed:
+            store.push_back(static_cast<s64>(arg.value));
+            break;
+        case DeferredArgType::Unsigned:
+            store.push_back(arg.value);
+            break;
+        case DeferredArgType::Float:
+            store.push_back(Common::BitCast<f32>(static_cast<u32>(arg.value)));
+            break;
+        case DeferredArgType::Double:
+            store.push_back(Common::BitCast<f64>(arg.value));
+            break;
+        case DeferredArgType::Pointer:
+            store.push_back(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(arg.value)));
+            break;
+        }
+    }
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("{} (format error: {})", format, e.what());
+    }
+}
+
+/**
+ * Lock-free ring written by a single logging thread. Producers never wait on the logger thread,
+ * messages are dropped and counted when it falls behind.
+ */
+class DeferredRing {
+public:
+    static constexpr size_t CAPACITY = 512;
+
+    bool TryPush(DeferredEntry&& entry) {
+        const size_t write = write_index.load(std::memory_order_relaxed);
+        if (write - read_index.load(std::memory_order_acquire) == CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[write % CAPACITY] = std::move(entry);
+        write_index.store(write + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    /// Returns the oldest message of the ring, only called from the logger thread
+    DeferredEntry* Front() {
+        const size_t read = read_index.load(std::memory_order_relaxed);
+        if (read == write_index.load(std::memory_order_seq_cst)) {
+            return nullptr;
+        }
+        return &slots[read % CAPACITY];
+    }
+
+    void Pop() {
+        read_index.store(read_index.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+    }
+
+    std::atomic_bool in_use{true};
+    std::atomic<u64> dropped{0};
+
+private:
+    alignas(128) std::atomic_size_t read_index{0};
+    alignas(128) std::atomic_size_t write_index{0};
+    std::array<DeferredEntry, CAPACITY> slots;
+};
+
+/**
+ * Backend that writes deferred messages in a compact binary format without formatting them.
+ * tools/decode-binary-log.py converts it back to text.
+ */
+class BinaryFileBackend final {
+public:
+    explicit BinaryFileBackend(const std::filesystem::path& filename) {
+        auto old_filename = filename;
+        old_filename += ".old.bin";
+        static_cast<void>(FS::RemoveFile(old_filename));
+        static_cast<void>(FS::RenameFile(filename, old_filename));
+
+        file = std::make_unique<FS::IOFile>(filename, FS::FileAccessMode::Write,
+                                            FS::FileType::BinaryFile);
+        buffer.insert(buffer.end(), MAGIC.begin(), MAGIC.end());
+        Append(VERSION);
+    }
+
+    ~BinaryFileBackend() {
+        Flush();
+    }
+
+    void Write(const DeferredEntry& entry) {
+        if (!enabled) {
+            return;
+        }
+        // Strings are defined before the record referencing them
+        const u64 class_id = StringId(GetLogClassName(entry.log_class));
+        const u64 level_id = StringId(GetLevelName(entry.log_level));
+        const u64 filename_id = StringId(entry.filename);
+        const u64 function_id = StringId(entry.function);
+        const u64 format_id = entry.format ? StringId(entry.format) : 0;
+        Append(entry.format ? RecordType::Message : RecordType::Text);
+        Append(static_cast<u64>(entry.timestamp.count()));
+        Append(class_id);
+        Append(level_id);
+        Append(filename_id);
+        Append(static_cast<u32>(entry.line_num));
+        Append(function_id);
+        if (entry.format) {
+            Append(format_id);
+            Append(static_cast<u8>(entry.num_args));
+            for (size_t i = 0; i < entry.num_args; ++i) {
+                Append(entry.args[i].type);
+                Append(entry.args[i].value);
+            }
+        } else {
+            AppendString(entry.message);
+        }
+
+        using namespace Common::Literals;
+        const auto write_limit = Settings::values.extended_logging.GetValue() ? 1_GiB : 100_MiB;
+        if (buffer.size() >= 64_KiB || entry.log_level >= Level::Error ||
+            bytes_written + buffer.size() > write_limit) {
+            Flush();
+            // Stop writing after the write limit is exceeded, like the text file backend
+            enabled = bytes_written <= write_limit;
+        }
+    }
+
+    void Flush() {
+        bytes_written += file->WriteSpan(std::span<const u8>(buffer));
+        buffer.clear();
+        file->Flush();
+    }
+
+private:
+    static constexpr std::array<u8, 8> MAGIC{'U', 'Z', 'L', 'O', 'G', 'B', 'I', 'N'};
+    static constexpr u32 VERSION = 1;
+
+    enum class RecordType : u8 {
+        String,
+        Message,
+        Text,
+    };
+
+    template <typename T>
+    void Append(const T& value) {
+        const auto* const bytes = reinterpret_cast<const u8*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void AppendString(std::string_view string) {
+        Append(static_cast<u32>(string.size()));
+        buffer.insert(buffer.end(), string.begin(), string.end());
+    }
+
+    /// Strings are written once and referenced by their id afterwards. They are keyed by their
+    /// contents, the same text can live at several addresses and an address can be reused.
+    u64 StringId(const char* string) {
+        const std::string_view contents = string ? std::string_view{string} : std::string_view{};
+        if (const auto it = string_ids.find(contents); it != string_ids.end()) {
+            return it->second;
+        }
+        const u64 id = strings.size();
+        string_ids.emplace(strings.emplace_back(contents), id);
+        Append(RecordType::String);
+        Append(id);
+        AppendString(contents);
+        return id;
+    }
+
+    std::unique_ptr<FS::IOFile> file;
+    std::vector<u8> buffer;
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, u64> string_ids;
+    bool enabled = true;
+    std::size_t bytes_written = 0;
+};
+
 bool initialization_in_progress_suppress_logging = true;
 
+std::atomic_bool deferred_formatting_enabled{false};
+
 /**
  * Static state as a singleton.
  */
@@ -199,8 +414,8 @@ public:
         void(CreateDir(log_dir));
         Filter filter;
         filter.ParseFilterString(Settings::values.log_filter.GetValue());
-        instance = std::unique_ptr<Impl, decltype(&Deleter)>(new Impl(log_dir / LOG_FILE, filter),
-                                                             Deleter);
+        instance = std::unique_ptr<Impl, decltype(&Deleter)>(
+            new Impl(log_dir / LOG_FILE, log_dir / LOG_BINARY_FILE, filter), Deleter);
         initialization_in_progress_suppress_logging = false;
     }
 
@@ -226,22 +441,80 @@ public:
         color_console_backend.SetEnabled(enabled);
     }
 
+    bool CheckFilter(Class log_class, Level log_level) const {
+        return filter.CheckMessage(log_class, log_level);
+    }
+
     void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, std::string&& message) {
-        if (!filter.CheckMessage(log_class, log_level)) {
+        if (deferred_formatting_enabled.load(std::memory_order_relaxed)) {
+            PushDeferred(DeferredEntry{
+                .timestamp = Timestamp(),
+                .log_class = log_class,
+                .log_level = log_level,
+                .filename = filename,
+                .line_num = line_num,
+                .function = function,
+                .message = std::move(message),
+            });
             return;
         }
         message_queue.EmplaceWait(
             CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
     }
 
+    void PushDeferredEntry(Class log_class, Level log_level, const char* filename,
+                           unsigned int line_num, const char* function, const char* format,
+                           std::span<const DeferredArg> args) {
+        DeferredEntry entry{
+            .timestamp = Timestamp(),
+            .log_class = log_class,
+            .log_level = log_level,
+            .filename = filename,
+            .line_num = line_num,
+            .function = function,
+            .format = format,
+            .num_args = args.size(),
+        };
+        std::ranges::copy(args, entry.args.begin());
+        PushDeferred(std::move(entry));
+    }
+
 private:
-    Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename} {}
+    static constexpr size_t MAX_DEFERRED_RINGS = 128;
+
+    /// Releases the ring of a thread when it exits so other threads can reuse it
+    struct ThreadRing {
+        ~ThreadRing() {
+            if (ring) {
+                ring->in_use.store(false, std::memory_order_release);
+            }
+        }
+
+        DeferredRing* ring = nullptr;
+        bool claimed = false;
+    };
+
+    Impl(const std::filesystem::path& file_backend_filename,
+         const std::filesystem::path& binary_backend_filename_, const Filter& filter_)
+        : filter{filter_}, file_backend{file_backend_filename},
+          binary_backend_filename{binary_backend_filename_} {}
 
     ~Impl() = default;
 
     void StartBackendThread() {
+        if (Settings::values.deferred_logging.GetValue()) {
+            if (Settings::values.binary_logging.GetValue() && !binary_backend) {
+                binary_backend = std::make_unique<BinaryFileBackend>(binary_backend_filename);
+                file_backend.SetEnabled(false);
+            }
+            deferred_formatting_enabled = true;
+            backend_thread = std::jthread([this](std::stop_token stop_token) {
+                Common::SetCurrentThreadName("Logger");
+                DeferredLoggerLoop(stop_token);
+            });
+            return;
+        }
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("Logger");
             Entry entry;
@@ -264,22 +537,232 @@ private:
     }
 
     void StopBackendThread() {
+        deferred_formatting_enabled = false;
         backend_thread.request_stop();
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
 
         ForEachBackend([](Backend& backend) { backend.Flush(); });
+        if (binary_backend) {
+            binary_backend->Flush();
+        }
     }
 
-    Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
-                      const char* function, std::string&& message) const {
+    void DeferredLoggerLoop(std::stop_token stop_token) {
+        const std::stop_callback wake_on_stop{stop_token, [this] { WakeLogger(); }};
+        while (WriteNextQueued()) {
+        }
+        while (!stop_token.stop_requested()) {
+            if (WriteNextQueued() || WriteNextDeferred()) {
+                continue;
+            }
+            ReportDroppedMessages();
+
+            // Producers only wake the logger when it announced it is going to sleep. Check the
+            // rings again after announcing it so a message pushed in between is not missed.
+            const u64 wake_value = wake_counter.load();
+            logger_sleeping = true;
+            if (!HasDeferredEntries() && !stop_token.stop_requested()) {
+                wake_counter.wait(wake_value);
+            }
+            logger_sleeping = false;
+        }
+        // Same limit as the regular logger when draining on close
+        int max_logs_to_write = filter.IsDebug() ? INT_MAX : 100;
+        while (max_logs_to_write-- && (WriteNextQueued() || WriteNextDeferred())) {
+        }
+        ReportDroppedMessages();
+    }
+
+    /// Writes a message of a thread without a ring, returns false when there are none
+    bool WriteNextQueued() {
+        Entry entry;
+        if (!message_queue.TryPop(entry)) {
+            return false;
+        }
+        // Messages queued before the logger started are not counted
+        size_t queued = num_queued.load(std::memory_order_relaxed);
+        while (queued > 0 && !num_queued.compare_exchange_weak(queued, queued - 1)) {
+        }
+        if (binary_backend) {
+            binary_backend->Write(DeferredEntry{
+                .timestamp = entry.timestamp,
+                .log_class = entry.log_class,
+                .log_level = entry.log_level,
+                .filename = entry.filename,
+                .line_num = entry.line_num,
+                .function = entry.function.c_str(),
+                .message = entry.message,
+            });
+        }
+        ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+        return true;
+    }
+
+    /// Writes the oldest message across all threads, returns false when there are none
+    bool WriteNextDeferred() {
+        DeferredRing* next_ring = nullptr;
+        DeferredEntry* next = nullptr;
+        const size_t count = num_rings.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            DeferredEntry* const front = rings[i]->Front();
+            if (front && (!next || front->timestamp < next->timestamp)) {
+                next_ring = rings[i];
+                next = front;
+            }
+        }
+        if (!next) {
+            return false;
+        }
+        if (binary_backend) {
+            binary_backend->Write(*next);
+        }
+        Entry entry{
+            .timestamp = next->timestamp,
+            .log_class = next->log_class,
+            .log_level = next->log_level,
+            .filename = next->filename,
+            .line_num = next->line_num,
+            .function = next->function,
+            .message = next->format ? FormatDeferredMessage(
+                                          next->format, std::span(next->args.data(), next->num_args))
+                                    : std::move(next->message),
+        };
+        next_ring->Pop();
+        ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+        if (++written_since_drop_report == DROP_REPORT_INTERVAL) {
+            ReportDroppedMessages();
+        }
+        return true;
+    }
+
+    bool HasDeferredEntries() {
+        if (num_queued.load() > 0) {
+            return true;
+        }
+        const size_t count = num_rings.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (rings[i]->Front()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ReportDroppedMessages() {
+        written_since_drop_report = 0;
+        u64 dropped = 0;
+        const size_t count = num_rings.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            dropped += rings[i]->dropped.load(std::memory_order_relaxed);
+        }
+        if (dropped == reported_dropped) {
+            return;
+        }
+        DeferredEntry report{
+            .timestamp = Timestamp(),
+            .log_class = Class::Log,
+            .log_level = Level::Warning,
+            .filename = TrimSourcePath(__FILE__),
+            .line_num = __LINE__,
+            .function = __func__,
+            .message = fmt::format("Dropped {} log messages, the logger thread fell behind",
+                                   dropped - reported_dropped),
+        };
+        reported_dropped = dropped;
+        if (binary_backend) {
+            binary_backend->Write(report);
+        }
+        Entry entry{
+            .timestamp = report.timestamp,
+            .log_class = report.log_class,
+            .log_level = report.log_level,
+            .filename = report.filename,
+            .line_num = report.line_num,
+            .function = report.function,
+            .message = std::move(report.message),
+        };
+        ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+    }
+
+    void PushDeferred(DeferredEntry&& entry) {
+        DeferredRing* const ring = GetThreadRing();
+        if (!ring) {
+            PushQueued(std::move(entry));
+            return;
+        }
+        if (ring->TryPush(std::move(entry)) && logger_sleeping.load()) {
+            WakeLogger();
+        }
+    }
+
+    /// Threads that found every ring taken format on their side and go through the shared queue,
+    /// like the synchronous logger
+    void PushQueued(DeferredEntry&& entry) {
+        if (entry.format) {
+            entry.message =
+                FormatDeferredMessage(entry.format, std::span(entry.args.data(), entry.num_args));
+        }
+        message_queue.EmplaceWait(Entry{
+            .timestamp = entry.timestamp,
+            .log_class = entry.log_class,
+            .log_level = entry.log_level,
+            .filename = entry.filename,
+            .line_num = entry.line_num,
+            .function = entry.function,
+            .message = std::move(entry.message),
+        });
+        num_queued.fetch_add(1);
+        if (logger_sleeping.load()) {
+            WakeLogger();
+        }
+    }
+
+    void WakeLogger() {
+        wake_counter.fetch_add(1);
+        wake_counter.notify_one();
+    }
+
+    DeferredRing* GetThreadRing() {
+        thread_local ThreadRing thread_ring;
+        if (!thread_ring.claimed) {
+            thread_ring.ring = ClaimRing();
+            thread_ring.claimed = true;
+        }
+        return thread_ring.ring;
+    }
+
+    DeferredRing* ClaimRing() {
+        std::scoped_lock lock{rings_mutex};
+        const size_t count = num_rings.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            bool expected = false;
+            if (rings[i]->in_use.compare_exchange_strong(expected, true,
+                                                         std::memory_order_acq_rel)) {
+                return rings[i];
+            }
+        }
+        if (count == MAX_DEFERRED_RINGS) {
+            return nullptr;
+        }
+        ring_storage.push_back(std::make_unique<DeferredRing>());
+        rings[count] = ring_storage.back().get();
+        num_rings.store(count + 1, std::memory_order_release);
+        return rings[count];
+    }
+
+    std::chrono::microseconds Timestamp() const {
         using std::chrono::duration_cast;
         using std::chrono::microseconds;
         using std::chrono::steady_clock;
+        return duration_cast<microseconds>(steady_clock::now() - time_origin);
+    }
 
+    Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+                      const char* function, std::string&& message) const {
         return {
-            .timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin),
+            .timestamp = Timestamp(),
             .log_class = log_class,
             .log_level = log_level,
             .filename = filename,
@@ -315,6 +798,21 @@ private:
     MPSCQueue<Entry> message_queue{};
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
+
+    static constexpr size_t DROP_REPORT_INTERVAL = 4096;
+
+    std::filesystem::path binary_backend_filename;
+    std::unique_ptr<BinaryFileBackend> binary_backend;
+
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<DeferredRing>> ring_storage;
+    std::array<DeferredRing*, MAX_DEFERRED_RINGS> rings{};
+    std::atomic_size_t num_rings{0};
+    std::atomic<u64> wake_counter{0};
+    std::atomic_bool logger_sleeping{false};
+    std::atomic_size_t num_queued{0};
+    u64 reported_dropped = 0;
+    size_t written_since_drop_report = 0;
 };
 } // namespace
 
@@ -342,12 +840,34 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+bool IsDeferredFormattingEnabled() {
+    return deferred_formatting_enabled.load(std::memory_order_relaxed);
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
-    if (!initialization_in_progress_suppress_logging) {
-        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
-                                   fmt::vformat(format, args));
+    if (initialization_in_progress_suppress_logging) {
+        return;
+    }
+    // Check the filter before formatting, filtered messages should cost as little as possible
+    Impl& instance = Impl::Instance();
+    if (instance.CheckFilter(log_class, log_level)) {
+        instance.PushEntry(log_class, log_level, filename, line_num, function,
+                           fmt::vformat(format, args));
+    }
+}
+
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::span<const DeferredArg> args) {
+    if (initialization_in_progress_suppress_logging) {
+        return;
+    }
+    Impl& instance = Impl::Instance();
+    if (instance.CheckFilter(log_class, log_level)) {
+        instance.PushDeferredEntry(log_class, log_level, filename, line_num, function, format,
+                                   args);
     }
 }
 } // namespace Common::Log
@@ -4,10 +4,15 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
 #include <string_view>
+#include <type_traits>
 
 #include <fmt/format.h>
 
+#include "common/bit_cast.h"
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
 
@@ -22,14 +27,88 @@ constexpr const char* TrimSourcePath(std::string_view source) {
     return source.data() + idx;
 }
 
+/// Type of an argument captured for deferred formatting
+enum class DeferredArgType : u8 {
+    Bool,
+    Char,
+    Signed,
+    Unsigned,
+    Float,
+    Double,
+    Pointer,
+};
+
+/// Argument captured by value on the calling thread, formatted later by the logger thread
+struct DeferredArg {
+    u64 value;
+    DeferredArgType type;
+};
+
+/// Messages with more arguments than this are always formatted on the calling thread
+constexpr size_t MAX_DEFERRED_ARGS = 8;
+
+template <typename T>
+constexpr bool IsDeferrableArg() {
+    if constexpr (std::is_enum_v<T>) {
+        // Only enums printed through the generic formatter, custom formatters may print names
+        return std::is_base_of_v<fmt::formatter<std::underlying_type_t<T>>, fmt::formatter<T>> &&
+               IsDeferrableArg<std::underlying_type_t<T>>();
+    } else if constexpr (std::is_same_v<T, wchar_t> || std::is_same_v<T, char8_t> ||
+                         std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>) {
+        return false;
+    } else {
+        return (std::is_integral_v<T> && sizeof(T) <= sizeof(u64)) ||
+               std::is_same_v<T, float> || std::is_same_v<T, double> ||
+               std::is_same_v<T, void*> || std::is_same_v<T, const void*>;
+    }
+}
+
+template <typename T>
+DeferredArg MakeDeferredArg(const T& arg) {
+    if constexpr (std::is_enum_v<T>) {
+        return MakeDeferredArg(static_cast<std::underlying_type_t<T>>(arg));
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return {arg ? 1ULL : 0ULL, DeferredArgType::Bool};
+    } else if constexpr (std::is_same_v<T, char>) {
+        return {static_cast<unsigned char>(arg), DeferredArgType::Char};
+    } else if constexpr (std::is_same_v<T, float>) {
+        return {Common::BitCast<u32>(arg), DeferredArgType::Float};
+    } else if constexpr (std::is_same_v<T, double>) {
+        return {Common::BitCast<u64>(arg), DeferredArgType::Double};
+    } else if constexpr (std::is_pointer_v<T>) {
+        return {reinterpret_cast<std::uintptr_t>(arg), DeferredArgType::Pointer};
+    } else if constexpr (std::is_signed_v<T>) {
+        return {static_cast<u64>(static_cast<s64>(arg)), DeferredArgType::Signed};
+    } else {
+        return {static_cast<u64>(arg), DeferredArgType::Unsigned};
+    }
+}
+
+/// Returns true when messages are captured and formatted on the logger thread
+bool IsDeferredFormattingEnabled();
+
 /// Logs a message to the global logger, using fmt
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Logs a message to the global logger, formatting it on the logger thread.
+/// The format string has to outlive the logger, as string literals do.
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::span<const DeferredArg> args);
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if constexpr (sizeof...(Args) <= MAX_DEFERRED_ARGS && (IsDeferrableArg<Args>() && ...)) {
+        if (IsDeferredFormattingEnabled()) {
+            const std::array<DeferredArg, sizeof...(Args)> deferred_args{MakeDeferredArg(args)...};
+            DeferredLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                                   deferred_args);
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -11,7 +11,12 @@
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #include <sys/sysctl.h>
 #elif defined(__linux__)
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
 #include <sys/sysinfo.h>
+#include <unistd.h>
 #else
 #include <unistd.h>
 #endif
@@ -69,4 +74,29 @@ const MemoryInfo& GetMemInfo() {
     return mem_info;
 }
 
+ProcessMemoryUsage GetProcessMemoryUsage() {
+    ProcessMemoryUsage usage{};
+#ifdef __linux__
+    // Returns the value of the line if it is the given field, 0 otherwise
+    const auto parse_field = [](const std::string& line, std::string_view field) -> u64 {
+        if (!line.starts_with(field)) {
+            return 0;
+        }
+        return std::strtoull(line.c_str() + field.size(), nullptr, 10);
+    };
+
+    // Sizes are in kB, summed over every mapping of the process
+    std::ifstream smaps{"/proc/self/smaps_rollup"};
+    std::string line;
+    while (std::getline(smaps, line)) {
+        usage.ResidentMemory += parse_field(line, "Rss:") * 1024;
+        usage.SharedMemory += (parse_field(line, "Shared_Clean:") +
+                               parse_field(line, "Shared_Dirty:")) * 1024;
+        usage.PrivateMemory += (parse_field(line, "Private_Clean:") +
+                                parse_field(line, "Private_Dirty:")) * 1024;
+    }
+#endif
+    return usage;
+}
+
 } // namespace Common
@@ -18,4 +18,16 @@ struct MemoryInfo {
  */
 [[nodiscard]] const MemoryInfo& GetMemInfo();
 
+struct ProcessMemoryUsage {
+    u64 ResidentMemory{}; ///< Memory of the process held in RAM
+    u64 SharedMemory{};   ///< Resident memory also mapped by other processes or files
+    u64 PrivateMemory{};  ///< Resident memory mapped by this process only
+};
+
+/**
+ * Gets the memory usage of the current process
+ * @return The usage in bytes, zero for what the host can't tell
+ */
+[[nodiscard]] ProcessMemoryUsage GetProcessMemoryUsage();
+
 } // namespace Common
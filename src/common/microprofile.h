@@ -21,4 +21,30 @@ typedef void* HANDLE;
 
 #include <microprofile.h>
 
+#include "common/trace.h"
+
 #define MP_RGB(r, g, b) ((r) << 16 | (g) << 8 | (b) << 0)
+
+#if MICROPROFILE_ENABLED
+/// MicroProfile scope that is also recorded in trace captures
+struct MicroProfileTraceScopeHandler {
+    MicroProfileToken token;
+    uint64_t tick;
+    uint64_t trace_begin;
+
+    explicit MicroProfileTraceScopeHandler(MicroProfileToken token_)
+        : token{token_}, tick{MicroProfileEnter(token)},
+          trace_begin{Common::Trace::IsRecording() ? Common::Trace::Now() : 0} {}
+
+    ~MicroProfileTraceScopeHandler() {
+        if (trace_begin != 0 && Common::Trace::IsRecording()) {
+            Common::Trace::RecordProfileSpan(token, trace_begin, Common::Trace::Now());
+        }
+        MicroProfileLeave(token, tick);
+    }
+};
+
+#undef MICROPROFILE_SCOPE
+#define MICROPROFILE_SCOPE(var)                                                                    \
+    MicroProfileTraceScopeHandler MICROPROFILE_TOKEN_PASTE(foo, __LINE__)(g_mp_##var)
+#endif
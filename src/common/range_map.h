@@ -3,9 +3,11 @@
 
 #pragma once
 
-#include <map>
+#include <iterator>
+#include <limits>
 #include <type_traits>
 
+#include "common/btree_map.h"
 #include "common/common_types.h"
 
 namespace Common {
@@ -55,7 +57,7 @@ public:
     }
 
 private:
-    using MapType = std::map<KeyT, ValueT>;
+    using MapType = BTreeMap<KeyT, ValueT>;
     using IteratorType = typename MapType::iterator;
     using ConstIteratorType = typename MapType::const_iterator;
 
@@ -119,11 +121,7 @@ private:
         const bool must_add_start = GetFirstValueWithin(address) != value;
         const ValueT last_value = GetLastValueWithin(address_end);
         const bool must_add_end = last_value != value;
-        auto it = container.lower_bound(address);
-        const auto it_end = container.upper_bound(address_end);
-        while (it != it_end) {
-            it = container.erase(it);
-        }
+        container.erase(container.lower_bound(address), container.upper_bound(address_end));
         if (must_add_start) {
             container.emplace(address, value);
         }
@@ -23,6 +23,11 @@ public:
 
     void Add(AddressType base_address, size_t size);
     void Subtract(AddressType base_address, size_t size);
+
+    /// Adds or subtracts all the ranges of another set at once
+    void Add(const RangeSet& other);
+    void Subtract(const RangeSet& other);
+
     void Clear();
     bool Empty() const;
 
@@ -210,6 +210,7 @@ struct Values {
                                              true,
                                              true,
                                              &use_speed_limit};
+    Setting<bool> reclaim_idle_memory{linkage, false, "reclaim_idle_memory", Category::Core};
 
     // Cpu
     SwitchableSetting<CpuBackend, true> cpu_backend{linkage,
@@ -230,6 +231,10 @@ struct Values {
                                                       CpuAccuracy::Auto, CpuAccuracy::Paranoid,
                                                       "cpu_accuracy",    Category::Cpu};
     SwitchableSetting<bool> cpu_debug_mode{linkage, false, "cpu_debug_mode", Category::CpuDebug};
+    Setting<bool> cpu_jit_warmup{linkage, false, "cpu_jit_warmup", Category::Cpu};
+    Setting<bool> cpu_park_spinning_threads{linkage, false, "cpu_park_spinning_threads",
+                                            Category::Cpu};
+    Setting<bool> cpu_inline_svcs{linkage, false, "cpu_inline_svcs", Category::CpuDebug};
 
     Setting<bool> cpuopt_page_tables{linkage, true, "cpuopt_page_tables", Category::CpuDebug};
     Setting<bool> cpuopt_block_linking{linkage, true, "cpuopt_block_linking", Category::CpuDebug};
@@ -594,6 +599,10 @@ struct Values {
     Setting<bool> extended_logging{
         linkage, false, "extended_logging", Category::Debugging, Specialization::Default, false};
     Setting<bool> use_debug_asserts{linkage, false, "use_debug_asserts", Category::Debugging};
+    Setting<bool> record_svc_statistics{linkage, false, "record_svc_statistics",
+                                        Category::Debugging};
+    Setting<bool> deferred_logging{linkage, false, "deferred_logging", Category::Debugging};
+    Setting<bool> binary_logging{linkage, false, "binary_logging", Category::Debugging};
     Setting<bool> use_auto_stub{
         linkage, false, "use_auto_stub", Category::Debugging, Specialization::Default, false};
     Setting<bool> enable_all_controllers{linkage, false, "enable_all_controllers",
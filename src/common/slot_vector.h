@@ -3,21 +3,31 @@
 
 #pragma once
 
-#include <algorithm>
-#include <bit>
-#include <numeric>
-#include <type_traits>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <utility>
-#include <vector>
 
 #include "common/assert.h"
 #include "common/common_types.h"
-#include "common/polyfill_ranges.h"
 
 namespace Common {
 
+/**
+ * Identifier of a slot in a SlotVector. The low bits hold the index of the slot and the high bits
+ * the generation of the slot when the id was created, so ids of erased objects can be told apart
+ * from ids of objects later inserted in the same slot.
+ */
 struct SlotId {
     static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+    static constexpr u32 INDEX_BITS = 20;
+    static constexpr u32 INDEX_MASK = (1U << INDEX_BITS) - 1;
+    static constexpr u32 GENERATION_MASK = (1U << (32 - INDEX_BITS)) - 1;
+
+    static constexpr SlotId Make(u32 slot_index, u32 generation) noexcept {
+        return SlotId{slot_index | ((generation & GENERATION_MASK) << INDEX_BITS)};
+    }
 
     constexpr auto operator<=>(const SlotId&) const noexcept = default;
 
@@ -25,12 +35,28 @@ struct SlotId {
         return index != INVALID_INDEX;
     }
 
+    [[nodiscard]] constexpr u32 Index() const noexcept {
+        return index & INDEX_MASK;
+    }
+
+    [[nodiscard]] constexpr u32 Generation() const noexcept {
+        return index >> INDEX_BITS;
+    }
+
     u32 index = INVALID_INDEX;
 };
 
+/**
+ * Storage of objects addressed by SlotId with O(1) insertion and removal.
+ *
+ * Slots live in fixed size chunks that are never reallocated, so objects never move and
+ * other threads may access objects they hold ids to while new objects are inserted. Inserting and
+ * erasing must be externally synchronized. Debug builds check the generation of every id used.
+ */
 template <class T>
-    requires std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_constructible_v<T>
 class SlotVector {
+    struct Entry;
+
 public:
     class Iterator {
         friend SlotVector<T>;
@@ -39,16 +65,7 @@ public:
         constexpr Iterator() = default;
 
         Iterator& operator++() noexcept {
-            const u64* const bitset = slot_vector->stored_bitset.data();
-            const u32 size = static_cast<u32>(slot_vector->stored_bitset.size()) * 64;
-            if (id.index < size) {
-                do {
-                    ++id.index;
-                } while (id.index < size && !IsValid(bitset));
-                if (id.index == size) {
-                    id.index = SlotId::INVALID_INDEX;
-                }
-            }
+            index = slot_vector->NextUsed(index + 1);
             return *this;
         }
 
@@ -59,162 +76,163 @@ public:
         }
 
         bool operator==(const Iterator& other) const noexcept {
-            return id.index == other.id.index;
+            return index == other.index;
         }
 
         bool operator!=(const Iterator& other) const noexcept {
-            return id.index != other.id.index;
+            return index != other.index;
         }
 
         std::pair<SlotId, T*> operator*() const noexcept {
-            return {id, std::addressof((*slot_vector)[id])};
+            const Entry& entry = slot_vector->GetEntry(index);
+            return {SlotId::Make(index, entry.generation), std::addressof(Object())};
         }
 
         T* operator->() const noexcept {
-            return std::addressof((*slot_vector)[id]);
+            return std::addressof(Object());
         }
 
     private:
-        Iterator(SlotVector<T>* slot_vector_, SlotId id_) noexcept
-            : slot_vector{slot_vector_}, id{id_} {}
+        Iterator(SlotVector<T>* slot_vector_, u32 index_) noexcept
+            : slot_vector{slot_vector_}, index{index_} {}
 
-        bool IsValid(const u64* bitset) const noexcept {
-            return ((bitset[id.index / 64] >> (id.index % 64)) & 1) != 0;
+        T& Object() const noexcept {
+            return slot_vector->GetEntry(index).object;
         }
 
-        SlotVector<T>* slot_vector;
-        SlotId id;
+        SlotVector<T>* slot_vector{};
+        u32 index{};
     };
 
+    SlotVector() = default;
+    SlotVector(const SlotVector&) = delete;
+    SlotVector& operator=(const SlotVector&) = delete;
+
     ~SlotVector() noexcept {
-        size_t index = 0;
-        for (u64 bits : stored_bitset) {
-            for (size_t bit = 0; bits; ++bit, bits >>= 1) {
-                if ((bits & 1) != 0) {
-                    values[index + bit].object.~T();
-                }
-            }
-            index += 64;
+        for (u32 index = NextUsed(0); index < num_indices; index = NextUsed(index + 1)) {
+            std::destroy_at(std::addressof(GetEntry(index).object));
+        }
+        for (std::atomic<Entry*>& chunk : chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
         }
-        delete[] values;
     }
 
     [[nodiscard]] T& operator[](SlotId id) noexcept {
-        ValidateIndex(id);
-        return values[id.index].object;
+        ValidateId(id);
+        return GetEntry(id.Index()).object;
     }
 
     [[nodiscard]] const T& operator[](SlotId id) const noexcept {
-        ValidateIndex(id);
-        return values[id.index].object;
+        ValidateId(id);
+        return GetEntry(id.Index()).object;
     }
 
     template <typename... Args>
     [[nodiscard]] SlotId insert(Args&&... args) noexcept {
-        const u32 index = FreeValueIndex();
-        new (&values[index].object) T(std::forward<Args>(args)...);
-        SetStorageBit(index);
-
-        return SlotId{index};
+        const u32 index = AllocateIndex();
+        Entry& entry = GetEntry(index);
+        std::construct_at(std::addressof(entry.object), std::forward<Args>(args)...);
+        entry.used = true;
+        ++num_used;
+        return SlotId::Make(index, entry.generation);
     }
 
     void erase(SlotId id) noexcept {
-        values[id.index].object.~T();
-        free_list.push_back(id.index);
-        ResetStorageBit(id.index);
+        ValidateId(id);
+        const u32 index = id.Index();
+        Entry& entry = GetEntry(index);
+        std::destroy_at(std::addressof(entry.object));
+        entry.used = false;
+        ++entry.generation;
+        entry.next_free = free_head;
+        free_head = index;
+        --num_used;
     }
 
     [[nodiscard]] Iterator begin() noexcept {
-        const auto it = std::ranges::find_if(stored_bitset, [](u64 value) { return value != 0; });
-        if (it == stored_bitset.end()) {
-            return end();
-        }
-        const u32 word_index = static_cast<u32>(std::distance(it, stored_bitset.begin()));
-        const SlotId first_id{word_index * 64 + static_cast<u32>(std::countr_zero(*it))};
-        return Iterator(this, first_id);
+        return Iterator(this, NextUsed(0));
     }
 
     [[nodiscard]] Iterator end() noexcept {
-        return Iterator(this, SlotId{SlotId::INVALID_INDEX});
+        return Iterator(this, num_indices);
     }
 
     [[nodiscard]] size_t size() const noexcept {
-        return values_capacity - free_list.size();
+        return num_used;
     }
 
 private:
-    struct NonTrivialDummy {
-        NonTrivialDummy() noexcept {}
-    };
+    static constexpr u32 CHUNK_SHIFT = 8;
+    static constexpr u32 CHUNK_SIZE = 1U << CHUNK_SHIFT;
+    static constexpr u32 NUM_CHUNKS = 1U << (SlotId::INDEX_BITS - CHUNK_SHIFT);
+    /// Keep the last indices free, they would alias the invalid and corrupt ids
+    static constexpr u32 MAX_INDICES = SlotId::INDEX_MASK - 1;
 
-    union Entry {
-        Entry() noexcept : dummy{} {}
+    static constexpr u32 NO_FREE_INDEX = std::numeric_limits<u32>::max();
+
+    struct Entry {
+        Entry() noexcept : next_free{NO_FREE_INDEX} {}
         ~Entry() noexcept {}
 
-        NonTrivialDummy dummy;
-        T object;
+        union {
+            T object;
+            u32 next_free;
+        };
+        u32 generation = 0;
+        bool used = false;
     };
 
-    void SetStorageBit(u32 index) noexcept {
-        stored_bitset[index / 64] |= u64(1) << (index % 64);
-    }
-
-    void ResetStorageBit(u32 index) noexcept {
-        stored_bitset[index / 64] &= ~(u64(1) << (index % 64));
+    Entry& GetEntry(u32 index) noexcept {
+        return chunks[index >> CHUNK_SHIFT].load(std::memory_order_acquire)[index % CHUNK_SIZE];
     }
 
-    bool ReadStorageBit(u32 index) noexcept {
-        return ((stored_bitset[index / 64] >> (index % 64)) & 1) != 0;
+    const Entry& GetEntry(u32 index) const noexcept {
+        return chunks[index >> CHUNK_SHIFT].load(std::memory_order_acquire)[index % CHUNK_SIZE];
     }
 
-    void ValidateIndex(SlotId id) const noexcept {
+    void ValidateId([[maybe_unused]] SlotId id) const noexcept {
         DEBUG_ASSERT(id);
-        DEBUG_ASSERT(id.index / 64 < stored_bitset.size());
-        DEBUG_ASSERT(((stored_bitset[id.index / 64] >> (id.index % 64)) & 1) != 0);
-    }
-
-    [[nodiscard]] u32 FreeValueIndex() noexcept {
-        if (free_list.empty()) {
-            Reserve(values_capacity ? (values_capacity << 1) : 1);
+        DEBUG_ASSERT(id.Index() < num_indices);
+        DEBUG_ASSERT_MSG(GetEntry(id.Index()).used &&
+                             (GetEntry(id.Index()).generation & SlotId::GENERATION_MASK) ==
+                                 id.Generation(),
+                         "Stale slot id index={} generation={}, current generation={}",
+                         id.Index(), id.Generation(), GetEntry(id.Index()).generation);
+    }
+
+    [[nodiscard]] u32 AllocateIndex() noexcept {
+        if (free_head != NO_FREE_INDEX) {
+            const u32 index = free_head;
+            free_head = GetEntry(index).next_free;
+            return index;
         }
-        const u32 free_index = free_list.back();
-        free_list.pop_back();
-        return free_index;
-    }
-
-    void Reserve(size_t new_capacity) noexcept {
-        Entry* const new_values = new Entry[new_capacity];
-        size_t index = 0;
-        for (u64 bits : stored_bitset) {
-            for (size_t bit = 0; bits; ++bit, bits >>= 1) {
-                const size_t i = index + bit;
-                if ((bits & 1) == 0) {
-                    continue;
-                }
-                T& old_value = values[i].object;
-                new (&new_values[i].object) T(std::move(old_value));
-                old_value.~T();
-            }
-            index += 64;
+        const u32 index = num_indices;
+        if (index >= MAX_INDICES) [[unlikely]] {
+            // Ids have no bits left for more slots, an aliased id would corrupt another object
+            UNREACHABLE_MSG("Slot vector is full");
         }
-
-        stored_bitset.resize((new_capacity + 63) / 64);
-
-        const size_t old_free_size = free_list.size();
-        free_list.resize(old_free_size + (new_capacity - values_capacity));
-        std::iota(free_list.begin() + old_free_size, free_list.end(),
-                  static_cast<u32>(values_capacity));
-
-        delete[] values;
-        values = new_values;
-        values_capacity = new_capacity;
+        if (index % CHUNK_SIZE == 0) {
+            chunks[index >> CHUNK_SHIFT].store(new Entry[CHUNK_SIZE], std::memory_order_release);
+        }
+        ++num_indices;
+        return index;
     }
 
-    Entry* values = nullptr;
-    size_t values_capacity = 0;
+    /// Returns the first used index at or after index, or the number of indices if there are none
+    u32 NextUsed(u32 index) noexcept {
+        while (index < num_indices && !GetEntry(index).used) {
+            ++index;
+        }
+        return index;
+    }
 
-    std::vector<u64> stored_bitset;
-    std::vector<u32> free_list;
+    /// Each pointer is published once before any id into its chunk exists, readers acquire it so
+    /// the chunk is visible to them even when the id reached them without synchronization
+    std::array<std::atomic<Entry*>, NUM_CHUNKS> chunks{};
+    /// Number of indices handed out so far, used or not
+    u32 num_indices = 0;
+    u32 num_used = 0;
+    u32 free_head = NO_FREE_INDEX;
 };
 
 } // namespace Common
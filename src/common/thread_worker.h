@@ -3,15 +3,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <type_traits>
 #include <vector>
-#include <queue>
 
 #include "common/polyfill_thread.h"
 #include "common/thread.h"
@@ -19,9 +21,30 @@
 
 namespace Common {
 
+enum class WorkPriority : size_t {
+    /// Work that something is waiting on, e.g. a pipeline needed this frame
+    High,
+    /// Work done ahead of time, e.g. prebuilding pipelines from the disk cache
+    Background,
+};
+
+namespace Detail {
+/// Worker pool and worker index of the current thread, used to queue nested work locally
+inline thread_local const void* current_worker_pool = nullptr;
+inline thread_local size_t current_worker_index = 0;
+} // namespace Detail
+
+/**
+ * Thread pool with per-worker queues. Work queued from outside the pool is spread across the
+ * workers, work queued from a worker is kept on its own queue, and idle workers steal from the
+ * others. High priority work is always taken before background work.
+ * With a single worker, work runs in the order it was queued.
+ */
 template <class StateType = void>
 class StatefulThreadWorker {
     static constexpr bool with_state = !std::is_same_v<StateType, void>;
+    static constexpr size_t NUM_PRIORITIES = 2;
+    static constexpr size_t SPIN_ITERATIONS = 16;
 
     struct DummyCallable {
         int operator()() const noexcept {
@@ -33,42 +56,44 @@ class StatefulThreadWorker {
         std::conditional_t<with_state, UniqueFunction<void, StateType*>, UniqueFunction<void>>;
     using StateMaker = std::conditional_t<with_state, std::function<StateType()>, DummyCallable>;
 
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::array<std::deque<Task>, NUM_PRIORITIES> lanes;
+    };
+
 public:
     explicit StatefulThreadWorker(size_t num_workers, std::string name, StateMaker func = {})
-        : workers_queued{num_workers}, thread_name{std::move(name)} {
-        const auto lambda = [this, func](std::stop_token stop_token) {
+        : queues(std::max<size_t>(num_workers, 1)), workers_queued{num_workers},
+          thread_name{std::move(name)} {
+        const auto lambda = [this, func](std::stop_token stop_token, size_t index) {
             Common::SetCurrentThreadName(thread_name.c_str());
+            Detail::current_worker_pool = this;
+            Detail::current_worker_index = index;
             {
                 [[maybe_unused]] std::conditional_t<with_state, StateType, int> state{func()};
                 while (!stop_token.stop_requested()) {
                     Task task;
-                    {
-                        std::unique_lock lock{queue_mutex};
-                        if (requests.empty()) {
-                            wait_condition.notify_all();
-                        }
-                        Common::CondvarWait(condition, lock, stop_token,
-                                            [this] { return !requests.empty(); });
-                        if (stop_token.stop_requested()) {
-                            break;
-                        }
-                        task = std::move(requests.front());
-                        requests.pop();
+                    if (!TryTakeTask(index, task)) {
+                        WaitForTask(stop_token);
+                        continue;
                     }
                     if constexpr (with_state) {
                         task(&state);
                     } else {
                         task();
                     }
-                    ++work_done;
+                    if (work_done.fetch_add(1) + 1 == work_scheduled.load()) {
+                        NotifyWaiters();
+                    }
                 }
             }
+            Detail::current_worker_pool = nullptr;
             ++workers_stopped;
-            wait_condition.notify_all();
+            NotifyWaiters();
         };
         threads.reserve(num_workers);
         for (size_t i = 0; i < num_workers; ++i) {
-            threads.emplace_back(lambda);
+            threads.emplace_back(lambda, i);
         }
     }
 
@@ -78,13 +103,28 @@ public:
     StatefulThreadWorker& operator=(StatefulThreadWorker&&) = delete;
     StatefulThreadWorker(StatefulThreadWorker&&) = delete;
 
-    void QueueWork(Task work) {
+    void QueueWork(Task work, WorkPriority priority = WorkPriority::High) {
+        size_t index;
+        if (Detail::current_worker_pool == this) {
+            index = Detail::current_worker_index;
+        } else {
+            index = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        }
+        ++work_scheduled;
         {
-            std::unique_lock lock{queue_mutex};
-            requests.emplace(std::move(work));
-            ++work_scheduled;
+            WorkerQueue& queue = queues[index];
+            std::scoped_lock lock{queue.mutex};
+            queue.lanes[static_cast<size_t>(priority)].push_back(std::move(work));
+        }
+        // Pairs with the sleeping worker count in WaitForTask, either the worker sees the new
+        // task or this sees the sleeping worker
+        num_pending.fetch_add(1);
+        if (num_sleeping.load() > 0) {
+            {
+                std::scoped_lock lock{idle_mutex};
+            }
+            idle_condition.notify_one();
         }
-        condition.notify_one();
     }
 
     void WaitForRequests(std::stop_token stop_token = {}) {
@@ -93,16 +133,68 @@ public:
                 thread.request_stop();
             }
         });
-        std::unique_lock lock{queue_mutex};
+        std::unique_lock lock{wait_mutex};
         wait_condition.wait(lock, [this] {
             return workers_stopped >= workers_queued || work_done >= work_scheduled;
         });
     }
 
 private:
-    std::queue<Task> requests;
-    std::mutex queue_mutex;
-    std::condition_variable_any condition;
+    bool TryTakeTask(size_t index, Task& task) {
+        while (num_pending.load() != 0) {
+            for (size_t priority = 0; priority < NUM_PRIORITIES; ++priority) {
+                // Own queue first, then steal starting from the next worker
+                for (size_t i = 0; i < queues.size(); ++i) {
+                    WorkerQueue& queue = queues[(index + i) % queues.size()];
+                    std::scoped_lock lock{queue.mutex};
+                    auto& lane = queue.lanes[priority];
+                    if (lane.empty()) {
+                        continue;
+                    }
+                    task = std::move(lane.front());
+                    lane.pop_front();
+                    num_pending.fetch_sub(1);
+                    return true;
+                }
+            }
+            // Another worker took the task between the pending check and the search
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    void WaitForTask(std::stop_token stop_token) {
+        // Work often arrives in bursts, spin for a bit before going to sleep
+        for (size_t i = 0; i < SPIN_ITERATIONS; ++i) {
+            if (num_pending.load() != 0 || stop_token.stop_requested()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock lock{idle_mutex};
+        num_sleeping.fetch_add(1);
+        if (work_done.load() >= work_scheduled.load()) {
+            NotifyWaiters();
+        }
+        Common::CondvarWait(idle_condition, lock, stop_token,
+                            [this] { return num_pending.load() != 0; });
+        num_sleeping.fetch_sub(1);
+    }
+
+    void NotifyWaiters() {
+        {
+            std::scoped_lock lock{wait_mutex};
+        }
+        wait_condition.notify_all();
+    }
+
+    std::vector<WorkerQueue> queues;
+    std::atomic<size_t> next_queue{};
+    std::atomic<size_t> num_pending{};
+    std::atomic<size_t> num_sleeping{};
+    std::mutex idle_mutex;
+    std::condition_variable_any idle_condition;
+    std::mutex wait_mutex;
     std::condition_variable wait_condition;
     std::atomic<size_t> work_scheduled{};
     std::atomic<size_t> work_done{};
@@ -0,0 +1,246 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/fs/file.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/trace.h"
+
+namespace Common::Trace {
+
+namespace Detail {
+std::atomic_bool is_recording{false};
+} // namespace Detail
+
+namespace {
+
+/// Number of spans kept per thread, older spans are overwritten
+constexpr size_t SPANS_PER_THREAD = 1 << 16;
+
+/// Spans this close to the write position of a full ring may be overwritten while writing
+constexpr size_t UNSTABLE_SPANS = 64;
+
+struct Span {
+    u64 begin;
+    u64 end;
+    u64 id;
+    bool is_token;
+};
+
+struct ThreadBuffer {
+    std::array<Span, SPANS_PER_THREAD> spans;
+    std::atomic<u64> write_index{0};
+    /// Write index when the capture started, only the owning thread moves write_index
+    u64 start_index = 0;
+    u32 tid = 0;
+    bool has_exited = false;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::unordered_set<std::string> names;
+    u32 next_tid = 1;
+};
+
+/// Marks the buffer of a thread as exited when the thread exits
+struct ThreadBufferOwner {
+    ~ThreadBufferOwner();
+
+    ThreadBuffer* buffer = nullptr;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+const std::chrono::steady_clock::time_point time_origin = std::chrono::steady_clock::now();
+
+thread_local ThreadBufferOwner thread_buffer;
+thread_local std::string thread_name;
+
+/// Frees the buffers of exited threads, their spans are written by the capture they belong to
+void ReleaseExitedBuffers(Registry& registry) {
+    std::erase_if(registry.buffers, [](const auto& buffer) { return buffer->has_exited; });
+}
+
+ThreadBufferOwner::~ThreadBufferOwner() {
+    if (!buffer) {
+        return;
+    }
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    buffer->has_exited = true;
+    // The recording flag only changes with the registry lock held
+    if (!Detail::is_recording.load(std::memory_order_relaxed)) {
+        ReleaseExitedBuffers(registry);
+    }
+    buffer = nullptr;
+}
+
+ThreadBuffer* GetThreadBuffer() {
+    if (thread_buffer.buffer) {
+        return thread_buffer.buffer;
+    }
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    auto& buffer = registry.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+    buffer->tid = registry.next_tid++;
+    buffer->name = thread_name.empty() ? fmt::format("Thread {}", buffer->tid) : thread_name;
+    thread_buffer.buffer = buffer.get();
+    return thread_buffer.buffer;
+}
+
+void Record(u64 id, bool is_token, u64 begin_ns, u64 end_ns) noexcept {
+    ThreadBuffer* const buffer = GetThreadBuffer();
+    const u64 index = buffer->write_index.load(std::memory_order_relaxed);
+    buffer->spans[index % SPANS_PER_THREAD] = Span{
+        .begin = begin_ns,
+        .end = end_ns,
+        .id = id,
+        .is_token = is_token,
+    };
+    buffer->write_index.store(index + 1, std::memory_order_release);
+}
+
+std::string EscapeJson(std::string_view string) {
+    std::string escaped;
+    escaped.reserve(string.size());
+    for (const char c : string) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string SpanName(const Span& span) {
+    if (!span.is_token) {
+        return EscapeJson(reinterpret_cast<const char*>(span.id));
+    }
+#if MICROPROFILE_ENABLED
+    const MicroProfileToken token = span.id;
+    const MicroProfile& profile = *MicroProfileGet();
+    const auto& timer = profile.TimerInfo[MicroProfileGetTimerIndex(token)];
+    const auto& group = profile.GroupInfo[MicroProfileGetGroupIndex(token)];
+    return EscapeJson(fmt::format("{}: {}", group.pName, timer.pName));
+#else
+    return "MicroProfile";
+#endif
+}
+
+} // Anonymous namespace
+
+void Start() {
+    Registry& registry = GetRegistry();
+    {
+        std::scoped_lock lock{registry.mutex};
+        ReleaseExitedBuffers(registry);
+        // Threads may be writing spans, skip the older ones instead of moving their write index
+        for (const auto& buffer : registry.buffers) {
+            buffer->start_index = buffer->write_index.load(std::memory_order_acquire);
+        }
+        Detail::is_recording.store(true, std::memory_order_release);
+    }
+    LOG_INFO(Common, "Trace capture started");
+}
+
+bool StopAndWrite(const std::filesystem::path& path) {
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    Detail::is_recording.store(false, std::memory_order_release);
+
+    FS::IOFile file{path, FS::FileAccessMode::Write, FS::FileType::TextFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common, "Failed to open trace file {}", FS::PathToUTF8String(path));
+        return false;
+    }
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    size_t num_spans = 0;
+    bool first = true;
+    const auto append = [&](std::string_view event) {
+        if (!first) {
+            json += ",\n";
+        }
+        first = false;
+        json += event;
+        if (json.size() >= 1 << 20) {
+            static_cast<void>(file.WriteString(json));
+            json.clear();
+        }
+    };
+    for (const auto& buffer : registry.buffers) {
+        append(fmt::format(R"({{"ph":"M","name":"thread_name","pid":1,"tid":{},)"
+                           R"("args":{{"name":"{}"}}}})",
+                           buffer->tid, EscapeJson(buffer->name)));
+
+        const u64 end = buffer->write_index.load(std::memory_order_acquire);
+        u64 begin = buffer->start_index;
+        if (end - begin > SPANS_PER_THREAD) {
+            begin = end - SPANS_PER_THREAD + UNSTABLE_SPANS;
+        }
+        for (u64 index = begin; index < end; ++index) {
+            const Span& span = buffer->spans[index % SPANS_PER_THREAD];
+            // Timestamps are in microseconds, keep the nanoseconds as fractions
+            append(fmt::format(R"({{"ph":"X","name":"{}","pid":1,"tid":{},"ts":{}.{:03},)"
+                               R"("dur":{}.{:03}}})",
+                               SpanName(span), buffer->tid, span.begin / 1000, span.begin % 1000,
+                               (span.end - span.begin) / 1000, (span.end - span.begin) % 1000));
+            ++num_spans;
+        }
+    }
+    json += "\n]}\n";
+    static_cast<void>(file.WriteString(json));
+    ReleaseExitedBuffers(registry);
+    LOG_INFO(Common, "Wrote {} trace spans to {}", num_spans, FS::PathToUTF8String(path));
+    return true;
+}
+
+void SetThreadName(std::string_view name) {
+    thread_name = name;
+    if (thread_buffer.buffer) {
+        std::scoped_lock lock{GetRegistry().mutex};
+        thread_buffer.buffer->name = thread_name;
+    }
+}
+
+const char* InternName(std::string_view name) {
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    return registry.names.emplace(name).first->c_str();
+}
+
+u64 Now() noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - time_origin;
+    // Never return zero, it means that the span started while not recording
+    return static_cast<u64>(std::chrono::nanoseconds(elapsed).count()) + 1;
+}
+
+void RecordSpan(const char* name, u64 begin_ns, u64 end_ns) noexcept {
+    Record(reinterpret_cast<u64>(name), false, begin_ns, end_ns);
+}
+
+void RecordProfileSpan(u64 token, u64 begin_ns, u64 end_ns) noexcept {
+    Record(token, true, begin_ns, end_ns);
+}
+
+} // namespace Common::Trace
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string_view>
+
+#include "common/common_types.h"
+
+/**
+ * Headless trace capture. Spans are recorded into per-thread ring buffers while a capture is
+ * running and written as a Chrome trace event JSON file, which can be opened in Perfetto or
+ * chrome://tracing. When no capture is running a span costs a single relaxed atomic load.
+ */
+namespace Common::Trace {
+
+namespace Detail {
+extern std::atomic_bool is_recording;
+} // namespace Detail
+
+/// Returns true while a capture is running
+[[nodiscard]] inline bool IsRecording() noexcept {
+    return Detail::is_recording.load(std::memory_order_relaxed);
+}
+
+/// Starts a capture, spans recorded by a previous capture are discarded
+void Start();
+
+/// Stops the capture and writes the recorded spans to path, returns false on failure
+bool StopAndWrite(const std::filesystem::path& path);
+
+/// Sets the name shown for the calling thread in captures
+void SetThreadName(std::string_view name);
+
+/// Returns the time in nanoseconds used for span timestamps
+[[nodiscard]] u64 Now() noexcept;
+
+/// Returns a copy of name that lives until the process exits, for names built at runtime
+[[nodiscard]] const char* InternName(std::string_view name);
+
+/// Records a span named by a static string on the calling thread
+void RecordSpan(const char* name, u64 begin_ns, u64 end_ns) noexcept;
+
+/// Records a span named by a MicroProfile token on the calling thread
+void RecordProfileSpan(u64 token, u64 begin_ns, u64 end_ns) noexcept;
+
+/// Records a span for the lifetime of the object, the name must be a static string.
+/// Nothing is recorded when the name is null.
+class ScopedSpan {
+public:
+    explicit ScopedSpan(const char* name_) noexcept
+        : name{name_}, begin{name && IsRecording() ? Now() : 0} {}
+
+    ~ScopedSpan() {
+        if (begin != 0 && IsRecording()) {
+            RecordSpan(name, begin, Now());
+        }
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    const char* name;
+    u64 begin;
+};
+
+} // namespace Common::Trace
+
+#define TRACE_SCOPE_PASTE_IMPL(a, b) a##b
+#define TRACE_SCOPE_PASTE(a, b) TRACE_SCOPE_PASTE_IMPL(a, b)
+
+/// Records a span named name until the end of the current scope
+#define TRACE_SCOPE(name)                                                                          \
+    const ::Common::Trace::ScopedSpan TRACE_SCOPE_PASTE(trace_scope_, __LINE__) {                  \
+        name                                                                                       \
+    }
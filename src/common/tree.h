@@ -533,6 +533,24 @@ constexpr T* RB_INSERT(RBHead<T>& head, T* elm, Compare cmp) {
     return nullptr;
 }
 
+template <typename T>
+    requires HasRBEntry<T>
+constexpr void RB_INSERT_BEFORE(RBHead<T>& head, T* pos, T* elm) {
+    // Link the element as the in-order predecessor of pos, without searching from the root.
+    if (T* tmp = RB_LEFT(pos); tmp == nullptr) {
+        RB_SET(elm, pos);
+        RB_SET_LEFT(pos, elm);
+    } else {
+        while (RB_RIGHT(tmp) != nullptr) {
+            tmp = RB_RIGHT(tmp);
+        }
+        RB_SET(elm, tmp);
+        RB_SET_RIGHT(tmp, elm);
+    }
+
+    RB_INSERT_COLOR(head, elm);
+}
+
 template <typename T, typename Compare>
     requires HasRBEntry<T>
 constexpr T* RB_FIND(RBHead<T>& head, T* elm, Compare cmp) {
@@ -33,10 +33,11 @@ public:
     VirtualBuffer& operator=(const VirtualBuffer&) = delete;
 
     VirtualBuffer(VirtualBuffer&& other) noexcept
-        : alloc_size{std::exchange(other.alloc_size, 0)}, base_ptr{std::exchange(other.base_ptr),
-                                                                   nullptr} {}
+        : alloc_size{std::exchange(other.alloc_size, 0)},
+          base_ptr{std::exchange(other.base_ptr, nullptr)} {}
 
     VirtualBuffer& operator=(VirtualBuffer&& other) noexcept {
+        FreeMemoryPages(base_ptr, alloc_size);
         alloc_size = std::exchange(other.alloc_size, 0);
         base_ptr = std::exchange(other.base_ptr, nullptr);
         return *this;
@@ -26,6 +26,8 @@ class KProcess;
 } // namespace Kernel
 
 namespace Core {
+class JitWarmupProfile;
+
 using WatchpointArray = std::array<Kernel::DebugWatchpoint, Core::Hardware::NUM_WATCHPOINTS>;
 
 // NOTE: these values match the HaltReason enum in Dynarmic
@@ -35,6 +37,7 @@ enum class HaltReason : u64 {
     BreakLoop = 0x02000000,
     SupervisorCall = 0x04000000,
     InstructionBreakpoint = 0x08000000,
+    Reschedule = 0x10000000,
     PrefetchAbort = 0x20000000,
 };
 DECLARE_ENUM_FLAG_OPERATORS(HaltReason);
@@ -72,6 +75,12 @@ public:
     // Clear a range of the instruction cache for this CPU.
     virtual void InvalidateCacheRange(u64 addr, std::size_t size) = 0;
 
+    // Translate the blocks of a JIT warm-up profile ahead of time, and record the blocks translated
+    // on demand to it from then on. Returns the number of blocks translated.
+    virtual std::size_t WarmUp(JitWarmupProfile& profile) {
+        return 0;
+    }
+
     // Get the current architecture.
     // This returns AArch64 when PSTATE.nRW == 0 and AArch32 when PSTATE.nRW == 1.
     virtual Architecture GetArchitecture() const = 0;
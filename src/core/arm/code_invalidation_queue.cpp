@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/logging/log.h"
+#include "common/range_sets.inc"
+#include "core/arm/code_invalidation_queue.h"
+
+namespace Core {
+
+CodeInvalidationQueue::CodeInvalidationQueue()
+    : m_creation_time{std::chrono::steady_clock::now()} {}
+
+CodeInvalidationQueue::~CodeInvalidationQueue() {
+    const Statistics statistics = GetStatistics();
+    if (statistics.num_requests == 0) {
+        return;
+    }
+    const auto lifetime = std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now() - m_creation_time);
+    LOG_DEBUG(Core_ARM,
+              "Code invalidations: {} requested, {} skipped, {} ranges applied, {} bytes "
+              "({:.0f} bytes/s)",
+              statistics.num_requests, statistics.num_skipped, statistics.num_ranges,
+              statistics.invalidated_bytes,
+              static_cast<double>(statistics.invalidated_bytes) / lifetime.count());
+}
+
+bool CodeInvalidationQueue::Push(u64 addr, u64 size) {
+    std::scoped_lock lk{m_mutex};
+    ++m_statistics.num_requests;
+
+    bool has_translated_code = false;
+    m_translated.ForEachInRange(addr, size, [&](u64, u64) { has_translated_code = true; });
+    if (!has_translated_code) {
+        ++m_statistics.num_skipped;
+        return false;
+    }
+
+    m_pending.Add(addr, size);
+    m_has_pending.store(true, std::memory_order_release);
+    return true;
+}
+
+void CodeInvalidationQueue::Clear() {
+    std::scoped_lock lk{m_mutex};
+    m_clear_requested = true;
+    m_pending.Clear();
+    m_has_pending.store(true, std::memory_order_release);
+}
+
+CodeInvalidationQueue::Statistics CodeInvalidationQueue::GetStatistics() {
+    std::scoped_lock lk{m_mutex};
+    return m_statistics;
+}
+
+void CodeInvalidationQueue::RecordTranslatedPage(u64 page) {
+    std::scoped_lock lk{m_mutex};
+    m_translated.Add(page, PAGE_SIZE);
+    m_last_translated_page = page;
+}
+
+std::vector<std::pair<u64, u64>> CodeInvalidationQueue::TakePending() {
+    std::vector<std::pair<u64, u64>> ranges;
+    std::scoped_lock lk{m_mutex};
+    if (m_clear_requested) {
+        m_translated.Clear();
+        m_clear_requested = false;
+    }
+    m_pending.ForEach([&](u64 start, u64 end) {
+        ranges.emplace_back(start, end - start);
+        m_statistics.invalidated_bytes += end - start;
+    });
+    for (const auto& [addr, size] : ranges) {
+        // Blocks overlapping the range are invalidated, translations outside of it stay tracked
+        m_translated.Subtract(addr, size);
+    }
+    m_statistics.num_ranges += ranges.size();
+    m_pending.Clear();
+    m_has_pending.store(false, std::memory_order_relaxed);
+
+    // Pages of the invalidated ranges have to be recorded again when they are retranslated
+    m_last_translated_page = ~u64{0};
+    return ranges;
+}
+
+} // namespace Core
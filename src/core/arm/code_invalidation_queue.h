@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/range_sets.h"
+
+namespace Core {
+
+/**
+ * Instruction cache invalidations requested for the JIT of one core.
+ *
+ * The pages read by the translator are tracked, so invalidations of ranges holding no translated
+ * code are dropped. The others are coalesced until the core next enters the JIT, which applies
+ * them all at once.
+ */
+class CodeInvalidationQueue {
+public:
+    struct Statistics {
+        u64 num_requests;      ///< Invalidations requested
+        u64 num_skipped;       ///< Requests dropped, their range held no translated code
+        u64 num_ranges;        ///< Coalesced ranges applied to the JIT
+        u64 invalidated_bytes; ///< Bytes covered by the applied ranges
+    };
+
+    CodeInvalidationQueue();
+    ~CodeInvalidationQueue();
+
+    CodeInvalidationQueue(const CodeInvalidationQueue&) = delete;
+    CodeInvalidationQueue& operator=(const CodeInvalidationQueue&) = delete;
+
+    /// Records that the translator reads code at addr, must be called by the thread running the
+    /// JIT before the code is read
+    void RecordTranslation(u64 addr) {
+        const u64 page = addr & ~(PAGE_SIZE - 1);
+        if (page != m_last_translated_page) {
+            RecordTranslatedPage(page);
+        }
+    }
+
+    /// Queues the invalidation of a range, thread safe.
+    /// Returns false if no translated code overlaps it, the request is dropped then.
+    bool Push(u64 addr, u64 size);
+
+    /// Drops the pending ranges and the tracked translations once the core next enters the JIT,
+    /// for when its whole cache is cleared. Thread safe.
+    void Clear();
+
+    /// Calls invalidate with every pending range, must be called by the thread running the JIT
+    /// before entering it
+    template <typename Func>
+    void Flush(Func&& invalidate) {
+        if (!m_has_pending.load(std::memory_order_acquire)) {
+            return;
+        }
+        for (const auto& [addr, size] : TakePending()) {
+            invalidate(addr, size);
+        }
+    }
+
+    [[nodiscard]] Statistics GetStatistics();
+
+private:
+    static constexpr u64 PAGE_SIZE = 0x1000;
+
+    void RecordTranslatedPage(u64 page);
+    std::vector<std::pair<u64, u64>> TakePending();
+
+    std::mutex m_mutex;
+    Common::RangeSet<u64> m_translated;
+    Common::RangeSet<u64> m_pending;
+    bool m_clear_requested{};
+    std::atomic<bool> m_has_pending{};
+    Statistics m_statistics{};
+    std::chrono::steady_clock::time_point m_creation_time;
+
+    /// Last page recorded, only accessed by the thread running the JIT
+    u64 m_last_translated_page{~u64{0}};
+};
+
+} // namespace Core
@@ -8,11 +8,14 @@
 namespace Core {
 
 constexpr Dynarmic::HaltReason StepThread = Dynarmic::HaltReason::Step;
+constexpr Dynarmic::HaltReason CodeInvalidation = Dynarmic::HaltReason::UserDefined1;
 constexpr Dynarmic::HaltReason DataAbort = Dynarmic::HaltReason::MemoryAbort;
 constexpr Dynarmic::HaltReason BreakLoop = Dynarmic::HaltReason::UserDefined2;
 constexpr Dynarmic::HaltReason SupervisorCall = Dynarmic::HaltReason::UserDefined3;
 constexpr Dynarmic::HaltReason InstructionBreakpoint = Dynarmic::HaltReason::UserDefined4;
+constexpr Dynarmic::HaltReason Reschedule = Dynarmic::HaltReason::UserDefined5;
 constexpr Dynarmic::HaltReason PrefetchAbort = Dynarmic::HaltReason::UserDefined6;
+constexpr Dynarmic::HaltReason JitWarmUp = Dynarmic::HaltReason::UserDefined7;
 
 constexpr HaltReason TranslateHaltReason(Dynarmic::HaltReason hr) {
     static_assert(static_cast<u64>(HaltReason::StepThread) == static_cast<u64>(StepThread));
@@ -21,6 +24,7 @@ constexpr HaltReason TranslateHaltReason(Dynarmic::HaltReason hr) {
     static_assert(static_cast<u64>(HaltReason::SupervisorCall) == static_cast<u64>(SupervisorCall));
     static_assert(static_cast<u64>(HaltReason::InstructionBreakpoint) ==
                   static_cast<u64>(InstructionBreakpoint));
+    static_assert(static_cast<u64>(HaltReason::Reschedule) == static_cast<u64>(Reschedule));
     static_assert(static_cast<u64>(HaltReason::PrefetchAbort) == static_cast<u64>(PrefetchAbort));
 
     return static_cast<HaltReason>(hr);
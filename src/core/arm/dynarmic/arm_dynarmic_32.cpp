@@ -8,6 +8,7 @@
 #include "core/arm/dynarmic/dynarmic_exclusive_monitor.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/svc.h"
 
 namespace Core {
 
@@ -19,7 +20,8 @@ public:
         : m_parent{parent}, m_memory(process->GetMemory()),
           m_process(process), m_debugger_enabled{parent.m_system.DebuggerEnabled()},
           m_check_memory_access{m_debugger_enabled ||
-                                !Settings::values.cpuopt_ignore_memory_aborts.GetValue()} {}
+                                !Settings::values.cpuopt_ignore_memory_aborts.GetValue()},
+          m_inline_svcs{Settings::values.cpu_inline_svcs.GetValue()} {}
 
     u8 MemoryRead8(u32 vaddr) override {
         CheckMemoryAccess(vaddr, 1, Kernel::DebugWatchpointType::Read);
@@ -41,6 +43,7 @@ public:
         if (!m_memory.IsValidVirtualAddressRange(vaddr, sizeof(u32))) {
             return std::nullopt;
         }
+        m_parent.m_code_invalidations.RecordTranslation(vaddr);
         return m_memory.Read32(vaddr);
     }
 
@@ -109,6 +112,16 @@ public:
     }
 
     void CallSVC(u32 swi) override {
+        // Calls that cannot block are performed without leaving the JIT
+        bool needs_scheduling{};
+        if (m_inline_svcs &&
+            Kernel::Svc::CallInline(m_parent.m_system, swi, std::addressof(needs_scheduling))) {
+            if (needs_scheduling) {
+                m_parent.m_jit->HaltExecution(Reschedule);
+            }
+            return;
+        }
+
         m_parent.m_svc_swi = swi;
         m_parent.m_jit->HaltExecution(SupervisorCall);
     }
@@ -172,6 +185,7 @@ public:
     Kernel::KProcess* m_process{};
     const bool m_debugger_enabled{};
     const bool m_check_memory_access{};
+    const bool m_inline_svcs{};
     static constexpr u64 MinimumRunCycles = 10000U;
 };
 
@@ -300,6 +314,11 @@ std::shared_ptr<Dynarmic::A32::Jit> ArmDynarmic32::MakeJit(Common::PageTable* pa
         }
     }
 
+    // Kernel exclusive accesses have to share reservations with the JIT only if it uses them
+    if (!config.HasOptimization(Dynarmic::OptimizationFlag::Unsafe_IgnoreGlobalMonitor)) {
+        m_exclusive_monitor.SetUsedByJit();
+    }
+
     return std::make_unique<Dynarmic::A32::Jit>(config);
 }
 
@@ -333,6 +352,7 @@ bool ArmDynarmic32::IsInThumbMode() const {
 HaltReason ArmDynarmic32::RunThread(Kernel::KThread* thread) {
     ScopedJitExecution sj(thread->GetOwnerProcess());
 
+    ApplyCodeInvalidations();
     m_jit->ClearExclusiveState();
     return TranslateHaltReason(m_jit->Run());
 }
@@ -340,6 +360,7 @@ HaltReason ArmDynarmic32::RunThread(Kernel::KThread* thread) {
 HaltReason ArmDynarmic32::StepThread(Kernel::KThread* thread) {
     ScopedJitExecution sj(thread->GetOwnerProcess());
 
+    ApplyCodeInvalidations();
     m_jit->ClearExclusiveState();
     return TranslateHaltReason(m_jit->Step());
 }
@@ -437,11 +458,21 @@ void ArmDynarmic32::SignalInterrupt(Kernel::KThread* thread) {
 }
 
 void ArmDynarmic32::ClearInstructionCache() {
+    m_code_invalidations.Clear();
     m_jit->ClearCache();
 }
 
 void ArmDynarmic32::InvalidateCacheRange(u64 addr, std::size_t size) {
-    m_jit->InvalidateCacheRange(static_cast<u32>(addr), size);
+    // Applied when the core next enters the JIT, which it has to leave if it is running code of
+    // the range
+    if (m_code_invalidations.Push(addr, size)) {
+        m_jit->HaltExecution(CodeInvalidation);
+    }
+}
+
+void ArmDynarmic32::ApplyCodeInvalidations() {
+    m_code_invalidations.Flush(
+        [this](u64 addr, u64 size) { m_jit->InvalidateCacheRange(static_cast<u32>(addr), size); });
 }
 
 } // namespace Core
@@ -6,6 +6,7 @@
 #include <dynarmic/interface/A32/a32.h>
 
 #include "core/arm/arm_interface.h"
+#include "core/arm/code_invalidation_queue.h"
 #include "core/arm/dynarmic/dynarmic_exclusive_monitor.h"
 
 namespace Core::Memory {
@@ -58,6 +59,7 @@ private:
     friend class DynarmicCP15;
 
     std::shared_ptr<Dynarmic::A32::Jit> MakeJit(Common::PageTable* page_table) const;
+    void ApplyCodeInvalidations();
 
     std::unique_ptr<DynarmicCallbacks32> m_cb{};
     std::shared_ptr<DynarmicCP15> m_cp15{};
@@ -65,6 +67,9 @@ private:
 
     std::shared_ptr<Dynarmic::A32::Jit> m_jit{};
 
+    // Instruction cache invalidations applied before entering the JIT
+    CodeInvalidationQueue m_code_invalidations;
+
     // SVC callback
     u32 m_svc_swi{};
 
@@ -5,8 +5,10 @@
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_64.h"
 #include "core/arm/dynarmic/dynarmic_exclusive_monitor.h"
+#include "core/arm/jit_warmup_profile.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/svc.h"
 
 namespace Core {
 
@@ -19,7 +21,8 @@ public:
         : m_parent{parent}, m_memory(process->GetMemory()),
           m_process(process), m_debugger_enabled{parent.m_system.DebuggerEnabled()},
           m_check_memory_access{m_debugger_enabled ||
-                                !Settings::values.cpuopt_ignore_memory_aborts.GetValue()} {}
+                                !Settings::values.cpuopt_ignore_memory_aborts.GetValue()},
+          m_inline_svcs{Settings::values.cpu_inline_svcs.GetValue()} {}
 
     u8 MemoryRead8(u64 vaddr) override {
         CheckMemoryAccess(vaddr, 1, Kernel::DebugWatchpointType::Read);
@@ -45,6 +48,12 @@ public:
         if (!m_memory.IsValidVirtualAddressRange(vaddr, sizeof(u32))) {
             return std::nullopt;
         }
+        m_parent.m_code_invalidations.RecordTranslation(vaddr);
+        // The translator reads the first instruction of a block with the PC set to it
+        if (m_parent.m_warmup_profile && vaddr == m_parent.m_jit->GetPC()) [[unlikely]] {
+            m_parent.m_warmup_profile->Record(m_parent.m_core_index, vaddr,
+                                              m_parent.m_jit->GetFpcr());
+        }
         return m_memory.Read32(vaddr);
     }
 
@@ -151,12 +160,25 @@ public:
     }
 
     void CallSVC(u32 svc) override {
+        // Calls that cannot block are performed without leaving the JIT
+        bool needs_scheduling{};
+        if (m_inline_svcs &&
+            Kernel::Svc::CallInline(m_parent.m_system, svc, std::addressof(needs_scheduling))) {
+            if (needs_scheduling) {
+                m_parent.m_jit->HaltExecution(Reschedule);
+            }
+            return;
+        }
+
         m_parent.m_svc = svc;
         m_parent.m_jit->HaltExecution(SupervisorCall);
     }
 
     void AddTicks(u64 ticks) override {
         ASSERT_MSG(!m_parent.m_uses_wall_clock, "Dynarmic ticking disabled");
+        if (m_warming_up) {
+            return;
+        }
 
         // Divide the number of ticks by the amount of CPU cores. TODO(Subv): This yields only a
         // rough approximation of the amount of executed ticks in the system, it may be thrown off
@@ -219,6 +241,8 @@ public:
     Kernel::KProcess* m_process{};
     const bool m_debugger_enabled{};
     const bool m_check_memory_access{};
+    const bool m_inline_svcs{};
+    bool m_warming_up{};
     static constexpr u64 MinimumRunCycles = 10000U;
 };
 
@@ -358,12 +382,18 @@ std::shared_ptr<Dynarmic::A64::Jit> ArmDynarmic64::MakeJit(Common::PageTable* pa
         }
     }
 
+    // Kernel exclusive accesses have to share reservations with the JIT only if it uses them
+    if (!config.HasOptimization(Dynarmic::OptimizationFlag::Unsafe_IgnoreGlobalMonitor)) {
+        m_exclusive_monitor.SetUsedByJit();
+    }
+
     return std::make_shared<Dynarmic::A64::Jit>(config);
 }
 
 HaltReason ArmDynarmic64::RunThread(Kernel::KThread* thread) {
     ScopedJitExecution sj(thread->GetOwnerProcess());
 
+    ApplyCodeInvalidations();
     m_jit->ClearExclusiveState();
     return TranslateHaltReason(m_jit->Run());
 }
@@ -371,6 +401,7 @@ HaltReason ArmDynarmic64::RunThread(Kernel::KThread* thread) {
 HaltReason ArmDynarmic64::StepThread(Kernel::KThread* thread) {
     ScopedJitExecution sj(thread->GetOwnerProcess());
 
+    ApplyCodeInvalidations();
     m_jit->ClearExclusiveState();
     return TranslateHaltReason(m_jit->Step());
 }
@@ -467,11 +498,47 @@ void ArmDynarmic64::SignalInterrupt(Kernel::KThread* thread) {
 }
 
 void ArmDynarmic64::ClearInstructionCache() {
+    m_code_invalidations.Clear();
     m_jit->ClearCache();
 }
 
 void ArmDynarmic64::InvalidateCacheRange(u64 addr, std::size_t size) {
-    m_jit->InvalidateCacheRange(addr, size);
+    // Applied when the core next enters the JIT, which it has to leave if it is running code of
+    // the range
+    if (m_code_invalidations.Push(addr, size)) {
+        m_jit->HaltExecution(CodeInvalidation);
+    }
+}
+
+void ArmDynarmic64::ApplyCodeInvalidations() {
+    m_code_invalidations.Flush(
+        [this](u64 addr, u64 size) { m_jit->InvalidateCacheRange(addr, size); });
+}
+
+std::size_t ArmDynarmic64::WarmUp(JitWarmupProfile& profile) {
+    Kernel::Svc::ThreadContext ctx{};
+    this->GetContext(ctx);
+    m_cb->m_warming_up = true;
+
+    // Running the JIT with a halt already requested translates the block at the PC, then returns
+    // before executing any of it
+    std::size_t num_blocks = 0;
+    for (const JitWarmupProfile::Block& block : profile.GetBlocks(m_core_index)) {
+        const std::optional<u64> pc = profile.GetAddress(block);
+        if (!pc || !m_cb->m_memory.IsValidVirtualAddressRange(*pc, sizeof(u32))) {
+            continue;
+        }
+        m_jit->SetPC(*pc);
+        m_jit->SetFpcr(block.fpcr);
+        m_jit->HaltExecution(JitWarmUp);
+        m_jit->Run();
+        ++num_blocks;
+    }
+
+    m_cb->m_warming_up = false;
+    this->SetContext(ctx);
+    m_warmup_profile = &profile;
+    return num_blocks;
 }
 
 } // namespace Core
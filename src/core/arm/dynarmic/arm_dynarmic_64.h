@@ -11,6 +11,7 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "core/arm/arm_interface.h"
+#include "core/arm/code_invalidation_queue.h"
 #include "core/arm/dynarmic/dynarmic_exclusive_monitor.h"
 
 namespace Core::Memory {
@@ -47,6 +48,7 @@ public:
     void SignalInterrupt(Kernel::KThread* thread) override;
     void ClearInstructionCache() override;
     void InvalidateCacheRange(u64 addr, std::size_t size) override;
+    std::size_t WarmUp(JitWarmupProfile& profile) override;
 
 protected:
     const Kernel::DebugWatchpoint* HaltedWatchpoint() const override;
@@ -61,11 +63,18 @@ private:
 
     std::shared_ptr<Dynarmic::A64::Jit> MakeJit(Common::PageTable* page_table,
                                                 std::size_t address_space_bits) const;
+    void ApplyCodeInvalidations();
     std::unique_ptr<DynarmicCallbacks64> m_cb{};
     std::size_t m_core_index{};
 
     std::shared_ptr<Dynarmic::A64::Jit> m_jit{};
 
+    // Instruction cache invalidations applied before entering the JIT
+    CodeInvalidationQueue m_code_invalidations;
+
+    // Profile recording the blocks translated on demand
+    JitWarmupProfile* m_warmup_profile{};
+
     // SVC callback
     u32 m_svc{};
 
@@ -1,34 +1,59 @@
 // SPDX-FileCopyrightText: Copyright 2018 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/logging/log.h"
 #include "core/arm/dynarmic/dynarmic_exclusive_monitor.h"
 #include "core/memory.h"
 
 namespace Core {
 
 DynarmicExclusiveMonitor::DynarmicExclusiveMonitor(Memory::Memory& memory_, std::size_t core_count_)
-    : monitor{core_count_}, memory{memory_} {}
+    : monitor{core_count_}, reservations{core_count_}, memory{memory_} {}
+
+DynarmicExclusiveMonitor::~DynarmicExclusiveMonitor() {
+    const auto statistics = reservations.GetStatistics();
+    if (statistics.num_writes != 0) {
+        LOG_DEBUG(Core_ARM,
+                  "Exclusive writes: {}, failed: {}, reservations of other cores cleared: {}",
+                  statistics.num_writes, statistics.num_failed, statistics.num_invalidated);
+    }
+}
+
+template <typename T, typename Function>
+T DynarmicExclusiveMonitor::ReadAndMark(std::size_t core_index, VAddr addr, Function op) {
+    if (used_by_jit) {
+        return monitor.ReadAndMark<T>(core_index, addr, op);
+    }
+    return reservations.ReadAndMark<T>(core_index, addr, op);
+}
 
-DynarmicExclusiveMonitor::~DynarmicExclusiveMonitor() = default;
+template <typename T, typename Function>
+bool DynarmicExclusiveMonitor::DoExclusiveOperation(std::size_t core_index, VAddr addr,
+                                                    Function op) {
+    if (used_by_jit) {
+        return monitor.DoExclusiveOperation<T>(core_index, addr, op);
+    }
+    return reservations.DoExclusiveOperation<T>(core_index, addr, op);
+}
 
 u8 DynarmicExclusiveMonitor::ExclusiveRead8(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u8>(core_index, addr, [&]() -> u8 { return memory.Read8(addr); });
+    return ReadAndMark<u8>(core_index, addr, [&]() -> u8 { return memory.Read8(addr); });
 }
 
 u16 DynarmicExclusiveMonitor::ExclusiveRead16(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u16>(core_index, addr, [&]() -> u16 { return memory.Read16(addr); });
+    return ReadAndMark<u16>(core_index, addr, [&]() -> u16 { return memory.Read16(addr); });
 }
 
 u32 DynarmicExclusiveMonitor::ExclusiveRead32(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u32>(core_index, addr, [&]() -> u32 { return memory.Read32(addr); });
+    return ReadAndMark<u32>(core_index, addr, [&]() -> u32 { return memory.Read32(addr); });
 }
 
 u64 DynarmicExclusiveMonitor::ExclusiveRead64(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u64>(core_index, addr, [&]() -> u64 { return memory.Read64(addr); });
+    return ReadAndMark<u64>(core_index, addr, [&]() -> u64 { return memory.Read64(addr); });
 }
 
 u128 DynarmicExclusiveMonitor::ExclusiveRead128(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u128>(core_index, addr, [&]() -> u128 {
+    return ReadAndMark<u128>(core_index, addr, [&]() -> u128 {
         u128 result;
         result[0] = memory.Read64(addr);
         result[1] = memory.Read64(addr + 8);
@@ -37,35 +62,39 @@ u128 DynarmicExclusiveMonitor::ExclusiveRead128(std::size_t core_index, VAddr ad
 }
 
 void DynarmicExclusiveMonitor::ClearExclusive(std::size_t core_index) {
-    monitor.ClearProcessor(core_index);
+    if (used_by_jit) {
+        monitor.ClearProcessor(core_index);
+        return;
+    }
+    reservations.ClearProcessor(core_index);
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite8(std::size_t core_index, VAddr vaddr, u8 value) {
-    return monitor.DoExclusiveOperation<u8>(core_index, vaddr, [&](u8 expected) -> bool {
+    return DoExclusiveOperation<u8>(core_index, vaddr, [&](u8 expected) -> bool {
         return memory.WriteExclusive8(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite16(std::size_t core_index, VAddr vaddr, u16 value) {
-    return monitor.DoExclusiveOperation<u16>(core_index, vaddr, [&](u16 expected) -> bool {
+    return DoExclusiveOperation<u16>(core_index, vaddr, [&](u16 expected) -> bool {
         return memory.WriteExclusive16(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite32(std::size_t core_index, VAddr vaddr, u32 value) {
-    return monitor.DoExclusiveOperation<u32>(core_index, vaddr, [&](u32 expected) -> bool {
+    return DoExclusiveOperation<u32>(core_index, vaddr, [&](u32 expected) -> bool {
         return memory.WriteExclusive32(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite64(std::size_t core_index, VAddr vaddr, u64 value) {
-    return monitor.DoExclusiveOperation<u64>(core_index, vaddr, [&](u64 expected) -> bool {
+    return DoExclusiveOperation<u64>(core_index, vaddr, [&](u64 expected) -> bool {
         return memory.WriteExclusive64(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) {
-    return monitor.DoExclusiveOperation<u128>(core_index, vaddr, [&](u128 expected) -> bool {
+    return DoExclusiveOperation<u128>(core_index, vaddr, [&](u128 expected) -> bool {
         return memory.WriteExclusive128(vaddr, value, expected);
     });
 }
@@ -7,6 +7,7 @@
 
 #include "common/common_types.h"
 #include "core/arm/exclusive_monitor.h"
+#include "core/arm/exclusive_reservations.h"
 
 namespace Core::Memory {
 class Memory;
@@ -38,7 +39,22 @@ public:
 private:
     friend class ArmDynarmic32;
     friend class ArmDynarmic64;
+
+    template <typename T, typename Function>
+    T ReadAndMark(std::size_t core_index, VAddr addr, Function op);
+
+    template <typename T, typename Function>
+    bool DoExclusiveOperation(std::size_t core_index, VAddr addr, Function op);
+
+    /// Called by JITs that take reservations through the Dynarmic monitor, before they run
+    void SetUsedByJit() {
+        used_by_jit = true;
+    }
+
     Dynarmic::ExclusiveMonitor monitor;
+    /// Lock free reservations, used instead of the monitor when no JIT shares it
+    ExclusiveReservations reservations;
+    bool used_by_jit{};
     Core::Memory::Memory& memory;
 };
 
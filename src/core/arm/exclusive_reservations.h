@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Lock free exclusive monitor with one reservation slot per core.
+ *
+ * Exclusive writes are compare and swap operations against the value read when the reservation
+ * was taken, so the slots only have to track which reservations were lost. A core checks its own
+ * slot and clears the slots of other cores holding the same granule, without any lock shared
+ * between cores. A write of the same value that was read can make a concurrent write to the
+ * same granule succeed, which compare and swap based exclusives allow anyway.
+ */
+class ExclusiveReservations {
+public:
+    /// Size of a reservation granule, a cache line, as reported to the guest by CTR_EL0.ERG
+    static constexpr VAddr GRANULE_SIZE = 64;
+
+    struct Statistics {
+        u64 num_writes;      ///< Exclusive writes attempted
+        u64 num_failed;      ///< Exclusive writes that failed
+        u64 num_invalidated; ///< Reservations of other cores cleared by exclusive writes
+    };
+
+    explicit ExclusiveReservations(std::size_t core_count) : slots(core_count) {}
+
+    /// Takes a reservation on the granule of addr and returns the value read by op
+    template <typename T, typename Function>
+    T ReadAndMark(std::size_t core_index, VAddr addr, Function op) {
+        Slot& slot = slots[core_index];
+        slot.address.store(addr & GRANULE_MASK, std::memory_order_relaxed);
+        const T value = op();
+        std::memcpy(slot.value, &value, sizeof(T));
+        return value;
+    }
+
+    /// Calls op with the value read by the reservation if the core still holds it on the granule
+    /// of addr, op must perform a compare and swap against it and return whether it succeeded
+    template <typename T, typename Function>
+    bool DoExclusiveOperation(std::size_t core_index, VAddr addr, Function op) {
+        Slot& slot = slots[core_index];
+        const VAddr granule = addr & GRANULE_MASK;
+        Increment(slot.num_writes);
+        if (slot.address.exchange(INVALID_ADDRESS, std::memory_order_relaxed) != granule) {
+            Increment(slot.num_failed);
+            return false;
+        }
+        for (Slot& other : slots) {
+            // Read first to keep the cache lines of unrelated cores shared
+            VAddr expected = granule;
+            if (&other != &slot && other.address.load(std::memory_order_relaxed) == granule &&
+                other.address.compare_exchange_strong(expected, INVALID_ADDRESS,
+                                                      std::memory_order_relaxed)) {
+                Increment(slot.num_invalidated);
+            }
+        }
+        T saved_value;
+        std::memcpy(&saved_value, slot.value, sizeof(T));
+        if (!op(saved_value)) {
+            Increment(slot.num_failed);
+            return false;
+        }
+        return true;
+    }
+
+    /// Drops the reservation of a core
+    void ClearProcessor(std::size_t core_index) {
+        slots[core_index].address.store(INVALID_ADDRESS, std::memory_order_relaxed);
+    }
+
+    /// Returns the counters of all cores, may be called while other cores are running
+    [[nodiscard]] Statistics GetStatistics() const {
+        Statistics statistics{};
+        for (const Slot& slot : slots) {
+            statistics.num_writes += slot.num_writes.load(std::memory_order_relaxed);
+            statistics.num_failed += slot.num_failed.load(std::memory_order_relaxed);
+            statistics.num_invalidated += slot.num_invalidated.load(std::memory_order_relaxed);
+        }
+        return statistics;
+    }
+
+private:
+    static constexpr VAddr GRANULE_MASK = ~(GRANULE_SIZE - 1);
+    static constexpr VAddr INVALID_ADDRESS = std::numeric_limits<VAddr>::max();
+
+    /// Reservation of a core, on its own cache line so cores only share lines they contend on
+    struct alignas(64) Slot {
+        std::atomic<VAddr> address{INVALID_ADDRESS};
+        alignas(16) u8 value[16]{};
+        std::atomic<u64> num_writes{};
+        std::atomic<u64> num_failed{};
+        std::atomic<u64> num_invalidated{};
+    };
+
+    /// Counters are only written by their own core
+    static void Increment(std::atomic<u64>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::vector<Slot> slots;
+};
+
+} // namespace Core
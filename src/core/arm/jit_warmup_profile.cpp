@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <span>
+
+#include <fmt/format.h>
+
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/hex_util.h"
+#include "common/logging/log.h"
+#include "core/arm/jit_warmup_profile.h"
+
+namespace Core {
+
+namespace {
+
+constexpr u32 PROFILE_MAGIC = 0x50574A55; // "UJWP"
+constexpr u32 PROFILE_VERSION = 2;
+
+/// Bounds the size of the profile and the time spent warming up
+constexpr size_t MAX_BLOCKS = 0x40000;
+
+struct ProfileHeader {
+    u32 magic;
+    u32 version;
+    u64 num_blocks;
+};
+
+} // Anonymous namespace
+
+JitWarmupProfile::JitWarmupProfile(u64 program_id, const std::array<u8, 0x20>& build_id,
+                                   u64 module_begin_, u64 module_size_)
+    : module_begin{module_begin_}, module_size{module_size_} {
+    const auto build_id_hex = Common::HexToString(std::span(build_id).first<0x10>());
+    path = Common::FS::GetUzuyPath(Common::FS::UzuyPath::CacheDir) / "jit" /
+           fmt::format("{:016X}", program_id) / fmt::format("{}.bin", build_id_hex);
+    Load();
+}
+
+void JitWarmupProfile::Load() {
+    const Common::FS::IOFile file(path, Common::FS::FileAccessMode::Read,
+                                  Common::FS::FileType::BinaryFile);
+    if (!file.IsOpen()) {
+        return;
+    }
+    ProfileHeader header{};
+    if (!file.ReadObject(header) || header.magic != PROFILE_MAGIC ||
+        header.version != PROFILE_VERSION || header.num_blocks > MAX_BLOCKS) {
+        LOG_WARNING(Core_ARM, "Ignoring invalid JIT warm-up profile {}",
+                    Common::FS::PathToUTF8String(path));
+        return;
+    }
+    std::vector<Block> blocks(header.num_blocks);
+    if (file.ReadSpan<Block>(blocks) != blocks.size()) {
+        LOG_WARNING(Core_ARM, "Ignoring truncated JIT warm-up profile {}",
+                    Common::FS::PathToUTF8String(path));
+        return;
+    }
+    for (const Block& block : blocks) {
+        if (block.core < Hardware::NUM_CPU_CORES) {
+            loaded_blocks[block.core].push_back(block);
+            ++num_loaded;
+        }
+    }
+}
+
+void JitWarmupProfile::Record(size_t core, u64 address, u32 fpcr) {
+    const u64 offset = address - module_begin;
+    if (offset >= module_size) {
+        return;
+    }
+    std::scoped_lock lk{mutex};
+    if (num_loaded + recorded_blocks.size() >= MAX_BLOCKS) {
+        return;
+    }
+    recorded_blocks.push_back(Block{
+        .offset = offset,
+        .fpcr = fpcr,
+        .core = static_cast<u32>(core),
+    });
+}
+
+void JitWarmupProfile::Save() {
+    std::scoped_lock lk{mutex};
+    const size_t num_warmed_up_blocks = num_warmed_up.load(std::memory_order_relaxed);
+    LOG_INFO(Core_ARM,
+             "JIT warm-up: {} blocks translated ahead of time, {} blocks translated on demand",
+             num_warmed_up_blocks, recorded_blocks.size());
+    if (recorded_blocks.empty()) {
+        return;
+    }
+
+    // Blocks are recorded again when they are retranslated after an invalidation
+    std::vector<Block> blocks = std::move(recorded_blocks);
+    recorded_blocks.clear();
+    for (const auto& core_blocks : loaded_blocks) {
+        blocks.insert(blocks.end(), core_blocks.begin(), core_blocks.end());
+    }
+    std::ranges::sort(blocks);
+    const auto [first, last] = std::ranges::unique(blocks);
+    blocks.erase(first, last);
+
+    if (!Common::FS::CreateParentDirs(path)) {
+        LOG_ERROR(Core_ARM, "Failed to create the JIT warm-up profile directory");
+        return;
+    }
+    const Common::FS::IOFile file(path, Common::FS::FileAccessMode::Write,
+                                  Common::FS::FileType::BinaryFile);
+    const ProfileHeader header{
+        .magic = PROFILE_MAGIC,
+        .version = PROFILE_VERSION,
+        .num_blocks = blocks.size(),
+    };
+    if (!file.WriteObject(header) || file.WriteSpan<Block>(blocks) != blocks.size()) {
+        LOG_ERROR(Core_ARM, "Failed to write the JIT warm-up profile {}",
+                  Common::FS::PathToUTF8String(path));
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "common/common_types.h"
+#include "core/hardware_properties.h"
+
+namespace Core {
+
+/**
+ * Guest code blocks of the main module translated by the JIT of each emulated core, recorded per
+ * title and build of the main module. The next boot of the same build translates them before the
+ * guest starts running, instead of translating them on demand on the emulated core threads.
+ * Code of other modules is not recorded, NROs and JIT service code are mapped at different
+ * addresses on every boot.
+ */
+class JitWarmupProfile {
+public:
+    struct Block {
+        u64 offset; ///< Address of the block relative to the base of the main module
+        u32 fpcr;   ///< FPCR the block was translated with, it is part of the translation key
+        u32 core;   ///< Core whose code cache the block was translated into
+
+        auto operator<=>(const Block&) const = default;
+    };
+
+    /// Loads the profile recorded for the given build of the main module, if any
+    explicit JitWarmupProfile(u64 program_id, const std::array<u8, 0x20>& build_id,
+                              u64 module_begin, u64 module_size);
+
+    JitWarmupProfile(const JitWarmupProfile&) = delete;
+    JitWarmupProfile& operator=(const JitWarmupProfile&) = delete;
+
+    /// Returns the address of a block, or nullopt if it lies outside of the main module
+    [[nodiscard]] std::optional<u64> GetAddress(const Block& block) const noexcept {
+        if (block.offset >= module_size) {
+            return std::nullopt;
+        }
+        return module_begin + block.offset;
+    }
+
+    /// Returns the blocks recorded by previous sessions for a core
+    [[nodiscard]] const std::vector<Block>& GetBlocks(size_t core) const noexcept {
+        return loaded_blocks[core];
+    }
+
+    /// Records a block translated on demand if it belongs to the main module, thread safe
+    void Record(size_t core, u64 address, u32 fpcr);
+
+    /// Accounts blocks translated ahead of time
+    void AddWarmedUpBlocks(size_t count) noexcept {
+        num_warmed_up.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /// Writes the loaded and newly recorded blocks back to disk and logs statistics
+    void Save();
+
+private:
+    void Load();
+
+    std::filesystem::path path;
+    u64 module_begin{};
+    u64 module_size{};
+    std::array<std::vector<Block>, Hardware::NUM_CPU_CORES> loaded_blocks;
+    size_t num_loaded{};
+
+    std::mutex mutex;
+    std::vector<Block> recorded_blocks;
+    std::atomic<size_t> num_warmed_up{};
+};
+
+} // namespace Core
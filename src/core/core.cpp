@@ -3,8 +3,11 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <memory>
+#include <numeric>
+#include <thread>
 #include <utility>
 
 #include "audio_core/audio_core.h"
@@ -15,6 +18,7 @@
 #include "common/settings_enums.h"
 #include "common/string_util.h"
 #include "core/arm/exclusive_monitor.h"
+#include "core/arm/jit_warmup_profile.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/cpu_manager.h"
@@ -391,6 +395,8 @@ struct System::Impl {
         applet_manager.CreateAndInsertByFrontendAppletParameters(main_process->GetProcessId(),
                                                                  params);
 
+        WarmUpJit(*main_process, params.program_id);
+
         // All threads are started, begin main process execution, now that we're in the clear.
         main_process->Run(load_parameters->main_thread_priority,
                           load_parameters->main_thread_stack_size);
@@ -429,6 +435,36 @@ struct System::Impl {
         return status;
     }
 
+    /// Translates the code recorded by previous sessions of the application before it starts
+    void WarmUpJit(Kernel::KProcess& process, u64 program_id) {
+        if (!Settings::values.cpu_jit_warmup.GetValue() || program_id == 0 ||
+            main_module_build_id == CurrentBuildProcessID{}) {
+            return;
+        }
+        jit_warmup_profile = std::make_unique<JitWarmupProfile>(
+            program_id, main_module_build_id, main_module_begin, main_module_size);
+
+        const auto start_time = std::chrono::steady_clock::now();
+        std::array<std::size_t, Core::Hardware::NUM_CPU_CORES> num_blocks{};
+        {
+            // The code caches of the cores are independent, fill them in parallel
+            std::array<std::jthread, Core::Hardware::NUM_CPU_CORES> threads;
+            for (std::size_t core = 0; core < threads.size(); ++core) {
+                threads[core] = std::jthread([&, core] {
+                    num_blocks[core] = process.GetArmInterface(core)->WarmUp(*jit_warmup_profile);
+                });
+            }
+        }
+        const std::size_t total_blocks = std::reduce(num_blocks.begin(), num_blocks.end());
+        jit_warmup_profile->AddWarmedUpBlocks(total_blocks);
+        if (total_blocks != 0) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            LOG_INFO(Core, "Translated {} JIT blocks ahead of time in {} ms", total_blocks,
+                     elapsed.count());
+        }
+    }
+
     void ShutdownMainProcess() {
         SetShuttingDown(true);
 
@@ -461,6 +497,10 @@ struct System::Impl {
         kernel.SuspendEmulation(true);
         kernel.CloseServices();
         kernel.ShutdownCores();
+        if (jit_warmup_profile) {
+            jit_warmup_profile->Save();
+        }
+        main_module_build_id = {};
         applet_manager.Reset();
         services.reset();
         service_manager.reset();
@@ -476,6 +516,7 @@ struct System::Impl {
         cpu_manager.Shutdown();
         debugger.reset();
         kernel.Shutdown();
+        jit_warmup_profile.reset();
         stop_event = {};
         Network::RestartSocketOperations();
 
@@ -534,7 +575,9 @@ struct System::Impl {
     }
 
     PerfStatsResults GetAndResetPerfStats() {
-        return perf_stats->GetAndResetStats(core_timing.GetGlobalTimeUs());
+        auto results = perf_stats->GetAndResetStats(core_timing.GetGlobalTimeUs());
+        results.guest_memory_committed = device_memory->buffer.GetCommittedSize().value_or(0);
+        return results;
     }
 
     mutable std::mutex suspend_guard;
@@ -569,6 +612,11 @@ struct System::Impl {
     std::unique_ptr<Tools::Freezer> memory_freezer;
     std::array<u8, 0x20> build_id{};
 
+    /// Build ID and code region of the main module, the JIT warm-up profile is keyed on them
+    CurrentBuildProcessID main_module_build_id{};
+    u64 main_module_begin{};
+    u64 main_module_size{};
+
     std::unique_ptr<Tools::RenderdocAPI> renderdoc_api;
 
     /// Applets
@@ -603,6 +651,9 @@ struct System::Impl {
     std::unique_ptr<Core::PerfStats> perf_stats;
     Core::SpeedLimiter speed_limiter;
 
+    /// Code translated by the application JIT, recorded for the next boot
+    std::unique_ptr<Core::JitWarmupProfile> jit_warmup_profile;
+
     bool is_multicore{};
     bool is_async_gpu{};
     bool extended_memory_layout{};
@@ -983,6 +1034,13 @@ const System::CurrentBuildProcessID& System::GetApplicationProcessBuildID() cons
     return impl->build_id;
 }
 
+void System::SetApplicationMainModule(const CurrentBuildProcessID& id, u64 region_begin,
+                                      u64 region_size) {
+    impl->main_module_build_id = id;
+    impl->main_module_begin = region_begin;
+    impl->main_module_size = region_size;
+}
+
 Service::SM::ServiceManager& System::ServiceManager() {
     return *impl->service_manager;
 }
@@ -404,6 +404,10 @@ public:
     void SetApplicationProcessBuildID(const CurrentBuildProcessID& id);
     [[nodiscard]] const CurrentBuildProcessID& GetApplicationProcessBuildID() const;
 
+    /// Sets the build ID and the code region of the main module of the application
+    void SetApplicationMainModule(const CurrentBuildProcessID& id, u64 region_begin,
+                                  u64 region_size);
+
     /// Register a host thread as an emulated CPU Core.
     void RegisterCoreThread(std::size_t id);
 
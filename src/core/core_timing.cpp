@@ -115,6 +115,15 @@ bool CoreTiming::HasPendingEvents() const {
     return !(wait_set && event_queue.empty());
 }
 
+std::optional<std::chrono::nanoseconds> CoreTiming::GetTimeUntilNextEvent() const {
+    std::scoped_lock lock{basic_lock};
+    if (event_queue.empty()) {
+        return std::nullopt;
+    }
+    const std::chrono::nanoseconds next_time{event_queue.top().time};
+    return std::max(next_time - GetGlobalTimeNs(), std::chrono::nanoseconds::zero());
+}
+
 void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
                                const std::shared_ptr<EventType>& event_type, bool absolute_time) {
     {
@@ -213,15 +222,22 @@ std::optional<s64> CoreTiming::Advance() {
 
                 basic_lock.unlock();
 
-                event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
+                {
+                    TRACE_SCOPE(event_type->trace_name);
+                    event_type->callback(
+                        evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
+                }
 
                 basic_lock.lock();
             } else {
                 basic_lock.unlock();
 
-                const auto new_schedule_time{event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
+                std::optional<std::chrono::nanoseconds> new_schedule_time;
+                {
+                    TRACE_SCOPE(event_type->trace_name);
+                    new_schedule_time = event_type->callback(
+                        evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
+                }
 
                 basic_lock.lock();
 
@@ -16,6 +16,7 @@
 
 #include "common/common_types.h"
 #include "common/thread.h"
+#include "common/trace.h"
 #include "common/wall_clock.h"
 
 namespace Core::Timing {
@@ -27,12 +28,15 @@ using TimedCallback = std::function<std::optional<std::chrono::nanoseconds>(
 /// Contains the characteristics of a particular event.
 struct EventType {
     explicit EventType(TimedCallback&& callback_, std::string&& name_)
-        : callback{std::move(callback_)}, name{std::move(name_)}, sequence_number{0} {}
+        : callback{std::move(callback_)}, name{std::move(name_)},
+          trace_name{Common::Trace::InternName("CoreTiming: " + name)}, sequence_number{0} {}
 
     /// The event's callback function.
     TimedCallback callback;
     /// A pointer to the name of the event.
     const std::string name;
+    /// Name of the event in trace captures
+    const char* trace_name;
     /// A monotonic sequence number, incremented when this event is
     /// changed externally.
     size_t sequence_number;
@@ -134,6 +138,9 @@ public:
     /// Checks for events manually and returns time in nanoseconds for next event, threadsafe.
     std::optional<s64> Advance();
 
+    /// Returns the time left until the next pending event, if any, threadsafe.
+    std::optional<std::chrono::nanoseconds> GetTimeUntilNextEvent() const;
+
 #ifdef _WIN32
     void SetTimerResolutionNs(std::chrono::nanoseconds ns);
 #endif
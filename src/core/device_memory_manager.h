@@ -11,6 +11,7 @@
 #include <mutex>
 
 #include "common/common_types.h"
+#include "common/large_page_table.h"
 #include "common/range_mutex.h"
 #include "common/scratch_buffer.h"
 #include "common/virtual_buffer.h"
@@ -38,6 +39,7 @@ template <typename Traits>
 class DeviceMemoryManager {
     using DeviceInterface = typename Traits::DeviceInterface;
     using DeviceMethods = typename Traits::DeviceMethods;
+    using ProcessMemory = typename Traits::ProcessMemory;
 
 public:
     DeviceMemoryManager(const DeviceMemory& device_memory);
@@ -89,7 +91,7 @@ public:
 
     PAddr GetPhysicalRawAddressFromDAddr(DAddr address) const {
         PAddr subbits = static_cast<PAddr>(address & page_mask);
-        auto paddr = compressed_physical_ptr[(address >> page_bits)];
+        auto paddr = compressed_physical_ptr.Get(address >> page_bits);
         if (paddr == 0) {
             return 0;
         }
@@ -110,7 +112,7 @@ public:
     void WriteBlock(DAddr address, const void* src_pointer, size_t size);
     void WriteBlockUnsafe(DAddr address, const void* src_pointer, size_t size);
 
-    Asid RegisterProcess(Memory::Memory* memory);
+    Asid RegisterProcess(ProcessMemory* memory);
     void UnregisterProcess(Asid id);
 
     void UpdatePagesCachedCount(DAddr addr, size_t size, s32 delta);
@@ -126,6 +128,10 @@ private:
     static constexpr size_t page_size = 1ULL << page_bits;
     static constexpr size_t page_mask = page_size - 1ULL;
     static constexpr u32 physical_address_base = 1U << page_bits;
+    /// Aligned blocks mapped to contiguous memory are translated with a single entry
+    static constexpr size_t large_page_bits = 16;
+    static constexpr size_t large_page_size = 1ULL << large_page_bits;
+    static constexpr size_t pages_per_large_page = 1ULL << (large_page_bits - page_bits);
     static constexpr u32 MULTI_FLAG_BITS = 31;
     static constexpr u32 MULTI_FLAG = 1U << MULTI_FLAG_BITS;
     static constexpr u32 MULTI_MASK = ~MULTI_FLAG;
@@ -150,18 +156,27 @@ private:
 
     void InnerGatherDeviceAddresses(Common::ScratchBuffer<u32>& buffer, PAddr address);
 
+    bool TryMapLargePage(size_t page_index, VAddr virtual_address, Asid asid,
+                         ProcessMemory* process_memory);
+
+    void RegisterDeviceAddress(u32 phys_addr, u32 device_page);
+    void UnregisterDeviceAddress(u32 phys_addr, u32 device_page);
+
     std::unique_ptr<DeviceMemoryManagerAllocator<Traits>> impl;
 
     const uintptr_t physical_base;
     DeviceInterface* device_inter;
-    Common::VirtualBuffer<u32> compressed_physical_ptr;
+    template <typename Value, Value step>
+    using PageTable = Common::LargePageTable<Value, step, large_page_bits - page_bits>;
+
+    PageTable<u32, 1> compressed_physical_ptr;
     Common::VirtualBuffer<u32> compressed_device_addr;
     Common::VirtualBuffer<u32> continuity_tracker;
 
     // Process memory interfaces
 
     std::deque<size_t> id_pool;
-    std::deque<Memory::Memory*> registered_processes;
+    std::deque<ProcessMemory*> registered_processes;
 
     // Memory protection management
 
@@ -171,17 +186,17 @@ private:
     static constexpr size_t asid_start_bit = guest_max_as_bits;
 
     std::pair<Asid, VAddr> ExtractCPUBacking(size_t page_index) {
-        auto content = cpu_backing_address[page_index];
+        auto content = cpu_backing_address.Get(page_index);
         const VAddr address = content & guest_mask;
         const Asid asid{static_cast<size_t>(content >> asid_start_bit)};
         return std::make_pair(asid, address);
     }
 
     void InsertCPUBacking(size_t page_index, VAddr address, Asid asid) {
-        cpu_backing_address[page_index] = address | (asid.id << asid_start_bit);
+        cpu_backing_address.Set(page_index, address | (asid.id << asid_start_bit));
     }
 
-    Common::VirtualBuffer<VAddr> cpu_backing_address;
+    PageTable<VAddr, page_size> cpu_backing_address;
     using CounterType = u8;
     using CounterAtomicType = std::atomic_uint8_t;
     static constexpr size_t subentries = 8 / sizeof(CounterType);
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+
+#include "core/hle/kernel/idle_loop_detector.h"
+#include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_results.h"
+
+namespace Kernel {
+
+bool IdleLoopDetector::IsPollingCall(u32 svc_id, std::span<const u64, 8> args, bool is_64bit) {
+    // Reading the system tick is not counted, as threads also read it between units of real work
+    switch (static_cast<Svc::SvcId>(svc_id)) {
+    case Svc::SvcId::WaitSynchronization:
+        // Waits that timed out without sleeping are told apart by the duration of the call
+        return static_cast<u32>(args[0]) == ResultTimedOut.raw;
+    case Svc::SvcId::SleepThread: {
+        // Yields have a negative or zero duration and leave the arguments untouched
+        const s64 ns = is_64bit ? static_cast<s64>(args[0])
+                                : static_cast<s64>((args[1] << 32) | static_cast<u32>(args[0]));
+        return ns <= 0;
+    }
+    default:
+        return false;
+    }
+}
+
+std::chrono::nanoseconds IdleLoopDetector::OnSupervisorCall(const KThread* thread,
+                                                            bool is_polling,
+                                                            Clock::time_point start_time,
+                                                            Clock::time_point end_time) {
+    const bool is_loop = is_polling && thread == m_thread &&
+                         start_time - m_last_call_end <= MaxLoopTime &&
+                         end_time - start_time <= MaxLoopTime;
+    m_thread = thread;
+    m_last_call_end = end_time;
+    if (!is_loop) {
+        m_num_polling_calls = is_polling ? 1 : 0;
+        m_park_time = MinParkTime;
+        return {};
+    }
+    if (++m_num_polling_calls < SpinThreshold) {
+        return {};
+    }
+    const auto park_time = m_park_time;
+    m_park_time = std::min(m_park_time * 2, MaxParkTime);
+    return park_time;
+}
+
+void IdleLoopDetector::OnParked(Clock::time_point start_time, Clock::time_point end_time) {
+    m_last_call_end = end_time;
+    ++m_statistics.num_parks;
+    m_statistics.parked_time += end_time - start_time;
+}
+
+} // namespace Kernel
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <span>
+
+#include "common/common_types.h"
+
+namespace Kernel {
+
+class KThread;
+
+/**
+ * Detects guest threads spinning on supervisor calls that make no progress, like polling
+ * synchronization objects or yielding with nothing else to run.
+ * A thread making such calls in a tight loop can only observe time passing or other cores, so its
+ * core can be parked for a while instead of keeping a host thread busy.
+ */
+class IdleLoopDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Calls that make no progress made in a row before a thread is considered spinning
+    static constexpr u32 SpinThreshold = 64;
+
+    /// Longest time between two calls, and longest call, of a spinning thread
+    static constexpr std::chrono::nanoseconds MaxLoopTime{std::chrono::microseconds{10}};
+
+    /// Parks start short and double while the thread keeps spinning, up to MaxParkTime
+    static constexpr std::chrono::nanoseconds MinParkTime{std::chrono::microseconds{20}};
+    static constexpr std::chrono::nanoseconds MaxParkTime{std::chrono::microseconds{500}};
+
+    struct Statistics {
+        u64 num_parks;
+        std::chrono::nanoseconds parked_time;
+    };
+
+    /// Returns whether a call that returned the given arguments made no progress
+    static bool IsPollingCall(u32 svc_id, std::span<const u64, 8> args, bool is_64bit);
+
+    /// Accounts a call of a thread. Returns how long its core should be parked before going back
+    /// to the guest, zero unless the thread is spinning.
+    std::chrono::nanoseconds OnSupervisorCall(const KThread* thread, bool is_polling,
+                                              Clock::time_point start_time,
+                                              Clock::time_point end_time);
+
+    /// Accounts a park, the loop of the thread goes on from its end
+    void OnParked(Clock::time_point start_time, Clock::time_point end_time);
+
+    [[nodiscard]] Statistics GetStatistics() const {
+        return m_statistics;
+    }
+
+private:
+    const KThread* m_thread{};
+    Clock::time_point m_last_call_end{};
+    u32 m_num_polling_calls{};
+    std::chrono::nanoseconds m_park_time{MinParkTime};
+    Statistics m_statistics{};
+};
+
+} // namespace Kernel
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/bit_util.h"
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+
+namespace Kernel {
+
+/**
+ * Pages of a heap found free by the last scan and not freed since. A page that is found free
+ * by two scans in a row stayed idle for the time between them.
+ */
+class KIdlePageBitmap {
+public:
+    using Run = std::pair<size_t, size_t>;
+
+    KIdlePageBitmap() = default;
+
+    UZUY_NON_COPYABLE(KIdlePageBitmap);
+    UZUY_NON_MOVEABLE(KIdlePageBitmap);
+
+    void Initialize(size_t num_pages) {
+        m_words = std::make_unique<u64[]>(Common::DivCeil(num_pages, BitsPerWord));
+    }
+
+    bool IsInitialized() const {
+        return m_words != nullptr;
+    }
+
+    /// Marks a run of free pages from index as idle. Appends to runs the pages of it that already
+    /// were, leaving out those whose bit is set in get_zeroed(word), the word of a bitmap of the
+    /// same layout. Runs that follow each other are merged.
+    template <typename GetZeroedFunc>
+    void Mark(size_t index, size_t num_pages, GetZeroedFunc&& get_zeroed,
+              std::vector<Run>& runs) {
+        const size_t end = index + num_pages;
+        while (index < end) {
+            const size_t bit = index % BitsPerWord;
+            const size_t count = std::min(BitsPerWord - bit, end - index);
+            const u64 mask = GetMask(bit, count);
+            const size_t word = index / BitsPerWord;
+            u64 idle = m_words[word] & ~get_zeroed(word) & mask;
+            m_words[word] |= mask;
+
+            while (idle != 0) {
+                const size_t first = static_cast<size_t>(std::countr_zero(idle));
+                const size_t length = static_cast<size_t>(std::countr_one(idle >> first));
+                const size_t start = word * BitsPerWord + first;
+                if (!runs.empty() && runs.back().first + runs.back().second == start) {
+                    runs.back().second += length;
+                } else {
+                    runs.emplace_back(start, length);
+                }
+                idle &= first + length == BitsPerWord ? 0 : ~u64(0) << (first + length);
+            }
+            index += count;
+        }
+    }
+
+    /// Marks a run of pages from index as no longer idle
+    void Clear(size_t index, size_t num_pages) {
+        const size_t end = index + num_pages;
+        while (index < end) {
+            const size_t bit = index % BitsPerWord;
+            const size_t count = std::min(BitsPerWord - bit, end - index);
+            m_words[index / BitsPerWord] &= ~GetMask(bit, count);
+            index += count;
+        }
+    }
+
+private:
+    static constexpr size_t BitsPerWord = Common::BitSize<u64>();
+
+    static constexpr u64 GetMask(size_t bit, size_t count) {
+        return (count == BitsPerWord ? ~u64(0) : (u64(1) << count) - 1) << bit;
+    }
+
+    std::unique_ptr<u64[]> m_words;
+};
+
+} // namespace Kernel
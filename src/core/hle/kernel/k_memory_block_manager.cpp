@@ -79,96 +79,89 @@ KProcessAddress KMemoryBlockManager::FindFreeArea(KProcessAddress region_start,
     return {};
 }
 
-void KMemoryBlockManager::CoalesceForUpdate(KMemoryBlockManagerUpdateAllocator* allocator,
-                                            KProcessAddress address, size_t num_pages) {
-    // Find the iterator now that we've updated.
-    iterator it = this->FindIterator(address);
-    if (address != m_start_address) {
-        it--;
+KMemoryBlockManager::iterator KMemoryBlockManager::CoalesceWithPrevious(
+    KMemoryBlockManagerUpdateAllocator* allocator, iterator it) {
+    if (it == m_memory_block_tree.begin()) {
+        return it;
     }
 
-    // Coalesce blocks that we can.
-    while (true) {
-        iterator prev = it++;
-        if (it == m_memory_block_tree.end()) {
-            break;
-        }
-
-        if (prev->CanMergeWith(*it)) {
-            KMemoryBlock* block = std::addressof(*it);
-            m_memory_block_tree.erase(it);
-            prev->Add(*block);
-            allocator->Free(block);
-            it = prev;
-        }
-
-        if (address + num_pages * PageSize < it->GetMemoryInfo().GetEndAddress()) {
-            break;
-        }
+    // Merge the block into the previous one if we can.
+    iterator prev = it;
+    prev--;
+    if (!prev->CanMergeWith(*it)) {
+        return it;
     }
+
+    KMemoryBlock* block = std::addressof(*it);
+    m_memory_block_tree.erase(it);
+    prev->Add(*block);
+    allocator->Free(block);
+    return prev;
 }
 
-void KMemoryBlockManager::Update(KMemoryBlockManagerUpdateAllocator* allocator,
-                                 KProcessAddress address, size_t num_pages, KMemoryState state,
-                                 KMemoryPermission perm, KMemoryAttribute attr,
-                                 KMemoryBlockDisableMergeAttribute set_disable_attr,
-                                 KMemoryBlockDisableMergeAttribute clear_disable_attr) {
+template <typename ShouldUpdate, typename UpdateBlock>
+void KMemoryBlockManager::UpdateRange(KMemoryBlockManagerUpdateAllocator* allocator,
+                                      KProcessAddress address, size_t num_pages,
+                                      ShouldUpdate&& should_update, UpdateBlock&& update_block) {
     // Ensure for auditing that we never end up with an invalid tree.
     KScopedMemoryBlockManagerAuditor auditor(this);
     ASSERT(Common::IsAligned(GetInteger(address), PageSize));
-    ASSERT((attr & (KMemoryAttribute::IpcLocked | KMemoryAttribute::DeviceShared)) ==
-           KMemoryAttribute::None);
 
+    const KProcessAddress end_address = address + num_pages * PageSize;
     KProcessAddress cur_address = address;
-    size_t remaining_pages = num_pages;
     iterator it = this->FindIterator(address);
 
-    while (remaining_pages > 0) {
-        const size_t remaining_size = remaining_pages * PageSize;
-        KMemoryInfo cur_info = it->GetMemoryInfo();
-        if (it->HasProperties(state, perm, attr)) {
-            // If we already have the right properties, just advance.
-            if (cur_address + remaining_size < cur_info.GetEndAddress()) {
-                remaining_pages = 0;
-                cur_address += remaining_size;
-            } else {
-                remaining_pages =
-                    (cur_address + remaining_size - cur_info.GetEndAddress()) / PageSize;
-                cur_address = cur_info.GetEndAddress();
-            }
-        } else {
-            // If we need to, create a new block before and insert it.
-            if (cur_info.GetAddress() != cur_address) {
+    // Split, update and coalesce the blocks of the range in a single pass, the new blocks are
+    // linked next to the block they are split from instead of being inserted from the root.
+    while (cur_address < end_address) {
+        if (should_update(*it)) {
+            // If we need to, create a new block before.
+            if (it->GetAddress() != cur_address) {
                 KMemoryBlock* new_block = allocator->Allocate();
 
                 it->Split(new_block, cur_address);
-                it = m_memory_block_tree.insert(*new_block);
-                it++;
-
-                cur_info = it->GetMemoryInfo();
-                cur_address = cur_info.GetAddress();
+                m_memory_block_tree.insert_before(it, *new_block);
             }
 
-            // If we need to, create a new block after and insert it.
-            if (cur_info.GetSize() > remaining_size) {
+            // If we need to, create a new block after.
+            if (it->GetEndAddress() > end_address) {
                 KMemoryBlock* new_block = allocator->Allocate();
 
-                it->Split(new_block, cur_address + remaining_size);
-                it = m_memory_block_tree.insert(*new_block);
-
-                cur_info = it->GetMemoryInfo();
+                it->Split(new_block, end_address);
+                it = m_memory_block_tree.insert_before(it, *new_block);
             }
 
             // Update block state.
-            it->Update(state, perm, attr, it->GetAddress() == address,
-                       static_cast<u8>(set_disable_attr), static_cast<u8>(clear_disable_attr));
-            cur_address += cur_info.GetSize();
-            remaining_pages -= cur_info.GetNumPages();
+            update_block(*it);
         }
+
+        // Coalesce the block with the previous one now that it won't change anymore.
+        cur_address = it->GetEndAddress();
+        it = this->CoalesceWithPrevious(allocator, it);
         it++;
     }
 
-    this->CoalesceForUpdate(allocator, address, num_pages);
+    // The block following the range may now be coalesced with the last one.
+    if (it != m_memory_block_tree.end()) {
+        this->CoalesceWithPrevious(allocator, it);
+    }
+}
+
+void KMemoryBlockManager::Update(KMemoryBlockManagerUpdateAllocator* allocator,
+                                 KProcessAddress address, size_t num_pages, KMemoryState state,
+                                 KMemoryPermission perm, KMemoryAttribute attr,
+                                 KMemoryBlockDisableMergeAttribute set_disable_attr,
+                                 KMemoryBlockDisableMergeAttribute clear_disable_attr) {
+    ASSERT((attr & (KMemoryAttribute::IpcLocked | KMemoryAttribute::DeviceShared)) ==
+           KMemoryAttribute::None);
+
+    this->UpdateRange(
+        allocator, address, num_pages,
+        [&](const KMemoryBlock& block) { return !block.HasProperties(state, perm, attr); },
+        [&](KMemoryBlock& block) {
+            block.Update(state, perm, attr, block.GetAddress() == address,
+                         static_cast<u8>(set_disable_attr), static_cast<u8>(clear_disable_attr));
+        });
 }
 
 void KMemoryBlockManager::UpdateIfMatch(KMemoryBlockManagerUpdateAllocator* allocator,
@@ -178,172 +171,42 @@ void KMemoryBlockManager::UpdateIfMatch(KMemoryBlockManagerUpdateAllocator* allo
                                         KMemoryPermission perm, KMemoryAttribute attr,
                                         KMemoryBlockDisableMergeAttribute set_disable_attr,
                                         KMemoryBlockDisableMergeAttribute clear_disable_attr) {
-    // Ensure for auditing that we never end up with an invalid tree.
-    KScopedMemoryBlockManagerAuditor auditor(this);
-    ASSERT(Common::IsAligned(GetInteger(address), PageSize));
     ASSERT((attr & (KMemoryAttribute::IpcLocked | KMemoryAttribute::DeviceShared)) ==
            KMemoryAttribute::None);
 
-    KProcessAddress cur_address = address;
-    size_t remaining_pages = num_pages;
-    iterator it = this->FindIterator(address);
-
-    while (remaining_pages > 0) {
-        const size_t remaining_size = remaining_pages * PageSize;
-        KMemoryInfo cur_info = it->GetMemoryInfo();
-        if (it->HasProperties(test_state, test_perm, test_attr) &&
-            !it->HasProperties(state, perm, attr)) {
-            // If we need to, create a new block before and insert it.
-            if (cur_info.GetAddress() != cur_address) {
-                KMemoryBlock* new_block = allocator->Allocate();
-
-                it->Split(new_block, cur_address);
-                it = m_memory_block_tree.insert(*new_block);
-                it++;
-
-                cur_info = it->GetMemoryInfo();
-                cur_address = cur_info.GetAddress();
-            }
-
-            // If we need to, create a new block after and insert it.
-            if (cur_info.GetSize() > remaining_size) {
-                KMemoryBlock* new_block = allocator->Allocate();
-
-                it->Split(new_block, cur_address + remaining_size);
-                it = m_memory_block_tree.insert(*new_block);
-
-                cur_info = it->GetMemoryInfo();
-            }
-
-            // Update block state.
-            it->Update(state, perm, attr, false, static_cast<u8>(set_disable_attr),
-                       static_cast<u8>(clear_disable_attr));
-            cur_address += cur_info.GetSize();
-            remaining_pages -= cur_info.GetNumPages();
-        } else {
-            // If we already have the right properties, just advance.
-            if (cur_address + remaining_size < cur_info.GetEndAddress()) {
-                remaining_pages = 0;
-                cur_address += remaining_size;
-            } else {
-                remaining_pages =
-                    (cur_address + remaining_size - cur_info.GetEndAddress()) / PageSize;
-                cur_address = cur_info.GetEndAddress();
-            }
-        }
-        it++;
-    }
-
-    this->CoalesceForUpdate(allocator, address, num_pages);
+    this->UpdateRange(
+        allocator, address, num_pages,
+        [&](const KMemoryBlock& block) {
+            return block.HasProperties(test_state, test_perm, test_attr) &&
+                   !block.HasProperties(state, perm, attr);
+        },
+        [&](KMemoryBlock& block) {
+            block.Update(state, perm, attr, false, static_cast<u8>(set_disable_attr),
+                         static_cast<u8>(clear_disable_attr));
+        });
 }
 
 void KMemoryBlockManager::UpdateLock(KMemoryBlockManagerUpdateAllocator* allocator,
                                      KProcessAddress address, size_t num_pages,
                                      MemoryBlockLockFunction lock_func, KMemoryPermission perm) {
-    // Ensure for auditing that we never end up with an invalid tree.
-    KScopedMemoryBlockManagerAuditor auditor(this);
-    ASSERT(Common::IsAligned(GetInteger(address), PageSize));
-
-    KProcessAddress cur_address = address;
-    size_t remaining_pages = num_pages;
-    iterator it = this->FindIterator(address);
-
     const KProcessAddress end_address = address + (num_pages * PageSize);
 
-    while (remaining_pages > 0) {
-        const size_t remaining_size = remaining_pages * PageSize;
-        KMemoryInfo cur_info = it->GetMemoryInfo();
-
-        // If we need to, create a new block before and insert it.
-        if (cur_info.m_address != cur_address) {
-            KMemoryBlock* new_block = allocator->Allocate();
-
-            it->Split(new_block, cur_address);
-            it = m_memory_block_tree.insert(*new_block);
-            it++;
-
-            cur_info = it->GetMemoryInfo();
-            cur_address = cur_info.GetAddress();
-        }
-
-        if (cur_info.GetSize() > remaining_size) {
-            // If we need to, create a new block after and insert it.
-            KMemoryBlock* new_block = allocator->Allocate();
-
-            it->Split(new_block, cur_address + remaining_size);
-            it = m_memory_block_tree.insert(*new_block);
-
-            cur_info = it->GetMemoryInfo();
-        }
-
-        // Call the locked update function.
-        (std::addressof(*it)->*lock_func)(perm, cur_info.GetAddress() == address,
-                                          cur_info.GetEndAddress() == end_address);
-        cur_address += cur_info.GetSize();
-        remaining_pages -= cur_info.GetNumPages();
-        it++;
-    }
-
-    this->CoalesceForUpdate(allocator, address, num_pages);
+    this->UpdateRange(
+        allocator, address, num_pages, [](const KMemoryBlock&) { return true; },
+        [&](KMemoryBlock& block) {
+            // Call the locked update function.
+            (block.*lock_func)(perm, block.GetAddress() == address,
+                               block.GetEndAddress() == end_address);
+        });
 }
 
 void KMemoryBlockManager::UpdateAttribute(KMemoryBlockManagerUpdateAllocator* allocator,
                                           KProcessAddress address, size_t num_pages,
                                           KMemoryAttribute mask, KMemoryAttribute attr) {
-    // Ensure for auditing that we never end up with an invalid tree.
-    KScopedMemoryBlockManagerAuditor auditor(this);
-    ASSERT(Common::IsAligned(GetInteger(address), PageSize));
-
-    KProcessAddress cur_address = address;
-    size_t remaining_pages = num_pages;
-    iterator it = this->FindIterator(address);
-
-    while (remaining_pages > 0) {
-        const size_t remaining_size = remaining_pages * PageSize;
-        KMemoryInfo cur_info = it->GetMemoryInfo();
-
-        if ((it->GetAttribute() & mask) != attr) {
-            // If we need to, create a new block before and insert it.
-            if (cur_info.GetAddress() != GetInteger(cur_address)) {
-                KMemoryBlock* new_block = allocator->Allocate();
-
-                it->Split(new_block, cur_address);
-                it = m_memory_block_tree.insert(*new_block);
-                it++;
-
-                cur_info = it->GetMemoryInfo();
-                cur_address = cur_info.GetAddress();
-            }
-
-            // If we need to, create a new block after and insert it.
-            if (cur_info.GetSize() > remaining_size) {
-                KMemoryBlock* new_block = allocator->Allocate();
-
-                it->Split(new_block, cur_address + remaining_size);
-                it = m_memory_block_tree.insert(*new_block);
-
-                cur_info = it->GetMemoryInfo();
-            }
-
-            // Update block state.
-            it->UpdateAttribute(mask, attr);
-            cur_address += cur_info.GetSize();
-            remaining_pages -= cur_info.GetNumPages();
-        } else {
-            // If we already have the right attributes, just advance.
-            if (cur_address + remaining_size < cur_info.GetEndAddress()) {
-                remaining_pages = 0;
-                cur_address += remaining_size;
-            } else {
-                remaining_pages =
-                    (cur_address + remaining_size - cur_info.GetEndAddress()) / PageSize;
-                cur_address = cur_info.GetEndAddress();
-            }
-        }
-        it++;
-    }
-
-    this->CoalesceForUpdate(allocator, address, num_pages);
+    this->UpdateRange(
+        allocator, address, num_pages,
+        [&](const KMemoryBlock& block) { return (block.GetAttribute() & mask) != attr; },
+        [&](KMemoryBlock& block) { block.UpdateAttribute(mask, attr); });
 }
 
 // Debug.
@@ -138,8 +138,14 @@ public:
     bool CheckState() const;
 
 private:
-    void CoalesceForUpdate(KMemoryBlockManagerUpdateAllocator* allocator, KProcessAddress address,
-                           size_t num_pages);
+    /// Splits the blocks at the edges of the range that need to be updated, updates them and
+    /// coalesces the range with its neighbours, in a single pass over the tree.
+    template <typename ShouldUpdate, typename UpdateBlock>
+    void UpdateRange(KMemoryBlockManagerUpdateAllocator* allocator, KProcessAddress address,
+                     size_t num_pages, ShouldUpdate&& should_update, UpdateBlock&& update_block);
+
+    /// Merges a block into the previous one if possible, returns the block containing it
+    iterator CoalesceWithPrevious(KMemoryBlockManagerUpdateAllocator* allocator, iterator it);
 
     MemoryBlockTree m_memory_block_tree;
     KProcessAddress m_start_address{};
@@ -2,9 +2,12 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <bit>
 
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/div_ceil.h"
+#include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "core/core.h"
 #include "core/device_memory.h"
@@ -33,6 +36,11 @@ constexpr KMemoryManager::Pool GetPoolFromMemoryRegionType(u32 type) {
     }
 }
 
+// Returns the mask of count pages from bit in a word of a page bitmap
+constexpr u64 GetPageMask(size_t bit, size_t count) {
+    return (count == Common::BitSize<u64>() ? ~u64(0) : (u64(1) << count) - 1) << bit;
+}
+
 } // namespace
 
 KMemoryManager::KMemoryManager(Core::System& system)
@@ -44,6 +52,22 @@ KMemoryManager::KMemoryManager(Core::System& system)
           KLightLock{system.Kernel()},
       } {}
 
+KMemoryManager::~KMemoryManager() {
+    for (size_t pool = 0; pool < static_cast<size_t>(Pool::Count); pool++) {
+        const auto statistics = this->GetAllocationStatistics(static_cast<Pool>(pool));
+        if (statistics.num_allocations == 0) {
+            continue;
+        }
+        LOG_DEBUG(Kernel,
+                  "Pool {}: {} page groups allocated, {} from the page caches, {} refills, "
+                  "{} ns on average, {} ns at most",
+                  pool, statistics.num_allocations, statistics.num_cached_allocations,
+                  statistics.num_refills,
+                  statistics.total_latency_ns / statistics.num_allocations,
+                  statistics.max_latency_ns);
+    }
+}
+
 void KMemoryManager::Initialize(KVirtualAddress management_region, size_t management_region_size) {
 
     // Clear the management region to zero.
@@ -101,8 +125,9 @@ void KMemoryManager::Initialize(KVirtualAddress management_region, size_t manage
         Impl* manager = std::addressof(m_managers[m_num_managers++]);
         ASSERT(m_num_managers <= m_managers.size());
 
-        const size_t cur_size = manager->Initialize(region_address, region_size, management_region,
-                                                    management_region_end, region_pool);
+        const size_t cur_size =
+            manager->Initialize(region_address, region_size, management_region,
+                                management_region_end, region_pool, m_system.DeviceMemory());
         management_region += cur_size;
         ASSERT(management_region <= management_region_end);
 
@@ -181,6 +206,9 @@ Result KMemoryManager::InitializeOptimizedMemory(u64 process_id, Pool pool) {
     m_optimized_process_ids[pool_index] = process_id;
     m_has_optimized_process[pool_index] = true;
 
+    // Allocations of the pool have to be tracked from now on, which the page caches don't do.
+    this->DrainPageCaches(pool);
+
     // Clear the management area for the optimized process.
     for (auto* manager = this->GetFirstManager(pool, Direction::FromFront); manager != nullptr;
          manager = this->GetNextManager(manager, Direction::FromFront)) {
@@ -219,13 +247,16 @@ KPhysicalAddress KMemoryManager::AllocateAndOpenContinuous(size_t num_pages, siz
     // Loop, trying to iterate from each block.
     Impl* chosen_manager = nullptr;
     KPhysicalAddress allocated_block = 0;
-    for (chosen_manager = this->GetFirstManager(pool, dir); chosen_manager != nullptr;
-         chosen_manager = this->GetNextManager(chosen_manager, dir)) {
-        allocated_block = chosen_manager->AllocateAligned(heap_index, num_pages, align_pages);
-        if (allocated_block != 0) {
-            break;
+    do {
+        for (chosen_manager = this->GetFirstManager(pool, dir); chosen_manager != nullptr;
+             chosen_manager = this->GetNextManager(chosen_manager, dir)) {
+            allocated_block = chosen_manager->AllocateAligned(heap_index, num_pages, align_pages);
+            if (allocated_block != 0) {
+                break;
+            }
         }
-    }
+        // Retry with the cached blocks returned to the heaps if we failed.
+    } while (allocated_block == 0 && this->DrainPageCaches(pool));
 
     // If we failed to allocate, quit now.
     if (allocated_block == 0) {
@@ -305,13 +336,28 @@ Result KMemoryManager::AllocateAndOpen(KPageGroup* out, size_t num_pages, u32 op
     // Early return if we're allocating no pages.
     R_SUCCEED_IF(num_pages == 0);
 
-    // Lock the pool that we're allocating from.
+    const auto start_time = std::chrono::steady_clock::now();
     const auto [pool, dir] = DecodeOption(option);
+
+    // Small allocations are served by the page cache of the current core, without the pool lock.
+    // Pages in the cache are referenced by nothing else, so they can be opened without it too.
+    if (this->AllocateFromPageCache(out, num_pages, pool, dir, true)) {
+        for (const auto& block : *out) {
+            this->GetManager(block.GetAddress()).OpenFirst(block.GetAddress(), block.GetNumPages());
+        }
+        this->RecordAllocation(pool, true, std::chrono::steady_clock::now() - start_time);
+        R_SUCCEED();
+    }
+
+    // Lock the pool that we're allocating from.
     KScopedLightLock lk(m_pool_locks[static_cast<size_t>(pool)]);
 
-    // Allocate the page group.
-    R_TRY(this->AllocatePageGroupImpl(out, num_pages, pool, dir,
-                                      m_has_optimized_process[static_cast<size_t>(pool)], true));
+    // Allocate the page group, returning the cached blocks to the heaps if we run out of memory.
+    const bool unoptimized = m_has_optimized_process[static_cast<size_t>(pool)];
+    PoolHeaps heaps{*this, pool, dir};
+    R_TRY(KPageHeapCache::AllocateOrDrain(heaps, m_page_caches[static_cast<size_t>(pool)], [&] {
+        return this->AllocatePageGroupImpl(out, num_pages, pool, dir, unoptimized, true);
+    }));
 
     // Open the first reference to the pages.
     for (const auto& block : *out) {
@@ -332,6 +378,7 @@ Result KMemoryManager::AllocateAndOpen(KPageGroup* out, size_t num_pages, u32 op
         }
     }
 
+    this->RecordAllocation(pool, false, std::chrono::steady_clock::now() - start_time);
     R_SUCCEED();
 }
 
@@ -342,10 +389,13 @@ Result KMemoryManager::AllocateForProcess(KPageGroup* out, size_t num_pages, u32
 
     // Decode the option.
     const auto [pool, dir] = DecodeOption(option);
+    const auto start_time = std::chrono::steady_clock::now();
 
-    // Allocate the memory.
-    bool optimized;
-    {
+    // Allocate the memory, from the page cache of the current core if it is small enough. The
+    // caches are not used while the pool has an optimized process, so there is nothing to track.
+    bool optimized = false;
+    const bool cached = this->AllocateFromPageCache(out, num_pages, pool, dir, false);
+    if (!cached) {
         // Lock the pool that we're allocating from.
         KScopedLightLock lk(m_pool_locks[static_cast<size_t>(pool)]);
 
@@ -353,13 +403,17 @@ Result KMemoryManager::AllocateForProcess(KPageGroup* out, size_t num_pages, u32
         const bool has_optimized = m_has_optimized_process[static_cast<size_t>(pool)];
         const bool is_optimized = m_optimized_process_ids[static_cast<size_t>(pool)] == process_id;
 
-        // Allocate the page group.
-        R_TRY(this->AllocatePageGroupImpl(out, num_pages, pool, dir, has_optimized && !is_optimized,
-                                          false));
+        // Allocate the page group, returning the cached blocks to the heaps if we run out.
+        PoolHeaps heaps{*this, pool, dir};
+        R_TRY(KPageHeapCache::AllocateOrDrain(heaps, m_page_caches[static_cast<size_t>(pool)], [&] {
+            return this->AllocatePageGroupImpl(out, num_pages, pool, dir,
+                                               has_optimized && !is_optimized, false);
+        }));
 
         // Set whether we should optimize.
         optimized = has_optimized && is_optimized;
     }
+    this->RecordAllocation(pool, cached, std::chrono::steady_clock::now() - start_time);
 
     // Perform optimized memory tracking, if we should.
     if (optimized) {
@@ -421,18 +475,96 @@ Result KMemoryManager::AllocateForProcess(KPageGroup* out, size_t num_pages, u32
     } else {
         // Set all the allocated memory.
         for (const auto& block : *out) {
-            m_system.DeviceMemory().buffer.ClearBackingRegion(GetInteger(block.GetAddress()) -
-                                                                  Core::DramMemoryMap::Base,
-                                                              block.GetSize(), fill_pattern);
+            this->Clear(block.GetAddress(), block.GetNumPages(), fill_pattern);
         }
     }
 
     R_SUCCEED();
 }
 
+void KMemoryManager::Close(const KPageGroup& page_group) {
+    KPageHeapCache::ClosePageGroup(
+        page_group,
+        [&](KPhysicalAddress address) -> KLightLock& {
+            return m_pool_locks[static_cast<size_t>(this->GetManager(address).GetPool())];
+        },
+        [&](KPhysicalAddress address, size_t num_pages) {
+            auto& manager = this->GetManager(address);
+            const size_t cur_pages = std::min(num_pages, manager.GetPageOffsetToEnd(address));
+            manager.Close(address, cur_pages, this->GetPageCacheForFree(manager.GetPool()));
+            return cur_pages;
+        });
+}
+
+void KMemoryManager::Clear(KPhysicalAddress address, size_t num_pages, u8 fill_pattern) {
+    while (num_pages > 0) {
+        auto& manager = this->GetManager(address);
+        const size_t cur_pages = std::min(num_pages, manager.GetPageOffsetToEnd(address));
+        manager.Clear(address, cur_pages, fill_pattern);
+
+        num_pages -= cur_pages;
+        address += cur_pages * PageSize;
+    }
+}
+
+size_t KMemoryManager::ReclaimIdlePages() {
+    size_t num_pages = 0;
+    for (size_t i = 0; i < m_num_managers; i++) {
+        KScopedLightLock lk(m_pool_locks[static_cast<size_t>(m_managers[i].GetPool())]);
+        num_pages += m_managers[i].ReclaimIdlePages();
+    }
+    return num_pages;
+}
+
+KMemoryManager::AllocationStatistics KMemoryManager::GetAllocationStatistics(Pool pool) const {
+    const auto& counters = m_allocation_counters[static_cast<size_t>(pool)];
+    u64 num_refills = 0;
+    for (const auto& cache : m_page_caches[static_cast<size_t>(pool)]) {
+        num_refills += cache.GetNumRefills();
+    }
+    return {
+        .num_allocations = counters.num_allocations.load(std::memory_order_relaxed),
+        .num_cached_allocations = counters.num_cached_allocations.load(std::memory_order_relaxed),
+        .num_refills = num_refills,
+        .total_latency_ns = counters.total_latency_ns.load(std::memory_order_relaxed),
+        .max_latency_ns = counters.max_latency_ns.load(std::memory_order_relaxed),
+    };
+}
+
+KPageHeapCache& KMemoryManager::GetPageCache(Pool pool) {
+    const u32 core_id = m_system.Kernel().GetCurrentHostThreadID();
+    return m_page_caches[static_cast<size_t>(pool)][std::min<size_t>(core_id, NumPageCaches - 1)];
+}
+
+bool KMemoryManager::AllocateFromPageCache(KPageGroup* out, size_t num_pages, Pool pool,
+                                           Direction dir, bool random) {
+    PoolHeaps heaps{*this, pool, dir};
+    return this->GetPageCache(pool).Allocate(heaps, out, num_pages, random);
+}
+
+bool KMemoryManager::DrainPageCaches(Pool pool) {
+    PoolHeaps heaps{*this, pool, Direction::FromFront};
+    return KPageHeapCache::DrainAll(heaps, m_page_caches[static_cast<size_t>(pool)]);
+}
+
+void KMemoryManager::RecordAllocation(Pool pool, bool cached, std::chrono::nanoseconds latency) {
+    auto& counters = m_allocation_counters[static_cast<size_t>(pool)];
+    const u64 latency_ns = static_cast<u64>(latency.count());
+    counters.num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (cached) {
+        counters.num_cached_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    counters.total_latency_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+    u64 max_latency_ns = counters.max_latency_ns.load(std::memory_order_relaxed);
+    while (max_latency_ns < latency_ns &&
+           !counters.max_latency_ns.compare_exchange_weak(max_latency_ns, latency_ns,
+                                                          std::memory_order_relaxed)) {
+    }
+}
+
 size_t KMemoryManager::Impl::Initialize(KPhysicalAddress address, size_t size,
                                         KVirtualAddress management, KVirtualAddress management_end,
-                                        Pool p) {
+                                        Pool p, Core::DeviceMemory& device_memory) {
     // Calculate management sizes.
     const size_t ref_count_size = (size / PageSize) * sizeof(u16);
     const size_t optimize_map_size = CalculateOptimizedProcessOverheadSize(size);
@@ -449,6 +581,9 @@ size_t KMemoryManager::Impl::Initialize(KPhysicalAddress address, size_t size,
     m_page_reference_counts.resize(
         Kernel::Board::Nintendo::Nx::KSystemControl::Init::GetIntendedMemorySize() / PageSize);
     ASSERT(Common::IsAligned(GetInteger(m_management_region), PageSize));
+    m_zeroed_pages = std::make_unique<std::atomic<u64>[]>(
+        Common::DivCeil(size / PageSize, Common::BitSize<u64>()));
+    m_device_memory = std::addressof(device_memory);
 
     // Initialize the manager's KPageHeap.
     m_heap.Initialize(address, size, management + manager_size, page_heap_size);
@@ -456,6 +591,100 @@ size_t KMemoryManager::Impl::Initialize(KPhysicalAddress address, size_t size,
     return total_management_size;
 }
 
+void KMemoryManager::Impl::Clear(KPhysicalAddress address, size_t num_pages, u8 fill_pattern) {
+    const size_t offset = this->GetPageOffset(address);
+    const auto clear = [&](size_t index, size_t count) {
+        m_device_memory->buffer.ClearBackingRegion(GetInteger(m_heap.GetAddress()) +
+                                                       index * PageSize - Core::DramMemoryMap::Base,
+                                                   count * PageSize, fill_pattern);
+    };
+
+    if (fill_pattern != 0) {
+        clear(offset, num_pages);
+    } else {
+        // Only clear the pages that weren't released to the host when they were freed.
+        const size_t end = offset + num_pages;
+        size_t index = offset;
+        while (index < end) {
+            const size_t dirty_start = this->FindZeroedRunEnd(index, end, true);
+            const size_t dirty_end = this->FindZeroedRunEnd(dirty_start, end, false);
+            if (dirty_start != dirty_end) {
+                clear(dirty_start, dirty_end - dirty_start);
+            }
+            index = dirty_end;
+        }
+    }
+
+    // The owner may write to the pages from now on.
+    this->SetZeroed(offset, num_pages, false);
+}
+
+size_t KMemoryManager::Impl::ReclaimIdlePages() {
+    if (!m_idle_pages.IsInitialized()) {
+        m_idle_pages.Initialize(m_heap.GetSize() / PageSize);
+    }
+
+    // Find the free pages that were already idle, marking the others for the next time.
+    std::vector<KIdlePageBitmap::Run> runs;
+    m_heap.ForEachFreeBlock([&](KPhysicalAddress block, size_t block_pages) {
+        m_idle_pages.Mark(
+            this->GetPageOffset(block), block_pages,
+            [&](size_t word) { return m_zeroed_pages[word].load(std::memory_order_relaxed); },
+            runs);
+    });
+
+    size_t num_pages = 0;
+    for (const auto& [index, count] : runs) {
+        this->Discard(m_heap.GetAddress() + index * PageSize, count);
+        num_pages += count;
+    }
+    return num_pages;
+}
+
+void KMemoryManager::Impl::Discard(KPhysicalAddress address, size_t num_pages) {
+    if (m_device_memory->buffer.DiscardBackingRegion(
+            GetInteger(address) - Core::DramMemoryMap::Base, num_pages * PageSize)) {
+        this->SetZeroed(this->GetPageOffset(address), num_pages, true);
+    } else {
+        this->SetZeroed(this->GetPageOffset(address), num_pages, false);
+    }
+}
+
+void KMemoryManager::Impl::SetZeroed(size_t index, size_t num_pages, bool zeroed) {
+    // Other pages of a word may be updated concurrently, by allocations from the page caches.
+    constexpr size_t BitsPerWord = Common::BitSize<u64>();
+    const size_t end = index + num_pages;
+    while (index < end) {
+        const size_t bit = index % BitsPerWord;
+        const size_t count = std::min(BitsPerWord - bit, end - index);
+        const u64 mask = GetPageMask(bit, count);
+        auto& word = m_zeroed_pages[index / BitsPerWord];
+        if (zeroed) {
+            word.fetch_or(mask, std::memory_order_relaxed);
+        } else if ((word.load(std::memory_order_relaxed) & mask) != 0) {
+            word.fetch_and(~mask, std::memory_order_relaxed);
+        }
+        index += count;
+    }
+}
+
+size_t KMemoryManager::Impl::FindZeroedRunEnd(size_t index, size_t end, bool zeroed) const {
+    constexpr size_t BitsPerWord = Common::BitSize<u64>();
+    while (index < end) {
+        const size_t bit = index % BitsPerWord;
+        u64 word = m_zeroed_pages[index / BitsPerWord].load(std::memory_order_relaxed);
+        if (!zeroed) {
+            word = ~word;
+        }
+        const size_t run = static_cast<size_t>(std::countr_one(word >> bit));
+        if (run < BitsPerWord - bit) {
+            return std::min(index + run, end);
+        }
+        index += BitsPerWord - bit;
+    }
+    return end;
+}
+
 void KMemoryManager::Impl::InitializeOptimizedMemory(KernelCore& kernel) {
     auto optimize_pa = KPageTable::GetHeapPhysicalAddress(kernel, m_management_region);
     auto* optimize_map = kernel.System().DeviceMemory().GetPointer<u64>(optimize_pa);
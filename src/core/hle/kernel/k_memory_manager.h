@@ -4,18 +4,25 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <tuple>
 
 #include "common/common_funcs.h"
+#include "core/hardware_properties.h"
+#include "core/hle/kernel/k_idle_page_bitmap.h"
 #include "core/hle/kernel/k_light_lock.h"
 #include "core/hle/kernel/k_memory_layout.h"
 #include "core/hle/kernel/k_page_heap.h"
+#include "core/hle/kernel/k_page_heap_cache.h"
 #include "core/hle/kernel/k_typed_address.h"
 #include "core/hle/result.h"
 
 namespace Core {
+class DeviceMemory;
 class System;
-}
+} // namespace Core
 
 namespace Kernel {
 
@@ -48,7 +55,16 @@ public:
 
     static constexpr size_t MaxManagerCount = 10;
 
+    struct AllocationStatistics {
+        u64 num_allocations;        ///< Page groups allocated
+        u64 num_cached_allocations; ///< Allocations served by the page caches of the cores
+        u64 num_refills;            ///< Batches of blocks moved from the heaps to the caches
+        u64 total_latency_ns;       ///< Time spent allocating page groups
+        u64 max_latency_ns;         ///< Longest page group allocation
+    };
+
     explicit KMemoryManager(Core::System& system);
+    ~KMemoryManager();
 
     void Initialize(KVirtualAddress management_region, size_t management_region_size);
 
@@ -60,6 +76,19 @@ public:
     Result AllocateForProcess(KPageGroup* out, size_t num_pages, u32 option, u64 process_id,
                               u8 fill_pattern);
 
+    /// Closes a reference to every page of the group, locking each pool once for all its blocks
+    void Close(const KPageGroup& page_group);
+
+    /// Fills pages that were just allocated. Pages that were released to the host when freed
+    /// already read as zero and are skipped when filling with zero.
+    void Clear(KPhysicalAddress address, size_t num_pages, u8 fill_pattern);
+
+    /// Releases the free pages that stayed free since the previous call to the host.
+    /// Returns the number of pages released.
+    size_t ReclaimIdlePages();
+
+    AllocationStatistics GetAllocationStatistics(Pool pool) const;
+
     Pool GetPool(KPhysicalAddress address) const {
         return this->GetManager(address).GetPool();
     }
@@ -104,7 +133,7 @@ public:
 
             {
                 KScopedLightLock lk(m_pool_locks[static_cast<size_t>(manager.GetPool())]);
-                manager.Close(address, cur_pages);
+                manager.Close(address, cur_pages, this->GetPageCacheForFree(manager.GetPool()));
             }
 
             num_pages -= cur_pages;
@@ -120,6 +149,14 @@ public:
         return total;
     }
 
+    size_t GetCachedSize(Pool pool) const {
+        size_t num_pages = 0;
+        for (const auto& cache : m_page_caches[static_cast<size_t>(pool)]) {
+            num_pages += cache.GetNumCachedPages();
+        }
+        return num_pages * PageSize;
+    }
+
     size_t GetSize(Pool pool) {
         constexpr Direction GetSizeDirection = Direction::FromFront;
         size_t total = 0;
@@ -136,6 +173,9 @@ public:
             KScopedLightLock lk(m_pool_locks[static_cast<size_t>(m_managers[i].GetPool())]);
             total += m_managers[i].GetFreeSize();
         }
+        for (size_t pool = 0; pool < static_cast<size_t>(Pool::Count); pool++) {
+            total += this->GetCachedSize(static_cast<Pool>(pool));
+        }
         return total;
     }
 
@@ -148,7 +188,7 @@ public:
              manager = this->GetNextManager(manager, GetSizeDirection)) {
             total += manager->GetFreeSize();
         }
-        return total;
+        return total + this->GetCachedSize(pool);
     }
 
     void DumpFreeList(Pool pool) {
@@ -199,8 +239,12 @@ private:
     public:
         Impl() = default;
 
+        /// Freed runs of at least this many pages are released to the host
+        static constexpr size_t DiscardThresholdPages = KPageHeap::GetBlockNumPages(2);
+
         size_t Initialize(KPhysicalAddress address, size_t size, KVirtualAddress management,
-                          KVirtualAddress management_end, Pool p);
+                          KVirtualAddress management_end, Pool p,
+                          Core::DeviceMemory& device_memory);
 
         KPhysicalAddress AllocateBlock(s32 index, bool random) {
             return m_heap.AllocateBlock(index, random);
@@ -209,9 +253,30 @@ private:
             return m_heap.AllocateAligned(index, num_pages, align_pages);
         }
         void Free(KPhysicalAddress addr, size_t num_pages) {
+            // Release large runs to the host, so they don't need to be cleared when reallocated.
+            if (num_pages >= DiscardThresholdPages) {
+                this->Discard(addr, num_pages);
+            } else {
+                this->SetZeroed(this->GetPageOffset(addr), num_pages, false);
+            }
+            if (m_idle_pages.IsInitialized()) {
+                m_idle_pages.Clear(this->GetPageOffset(addr), num_pages);
+            }
             m_heap.Free(addr, num_pages);
         }
 
+        void Free(KPhysicalAddress addr, size_t num_pages, KPageHeapCache* cache) {
+            // Keep small runs in the cache of the core, to be reallocated without the heap.
+            if (cache != nullptr) {
+                cache->PushRun(addr, num_pages, [&](KPhysicalAddress block, size_t block_pages) {
+                    this->SetZeroed(this->GetPageOffset(block), block_pages, false);
+                });
+            }
+            if (num_pages > 0) {
+                this->Free(addr, num_pages);
+            }
+        }
+
         void SetInitialUsedHeapSize(size_t reserved_size) {
             m_heap.SetInitialUsedSize(reserved_size);
         }
@@ -225,6 +290,10 @@ private:
         bool ProcessOptimizedAllocation(KernelCore& kernel, KPhysicalAddress block,
                                         size_t num_pages, u8 fill_pattern);
 
+        void Clear(KPhysicalAddress address, size_t num_pages, u8 fill_pattern);
+
+        size_t ReclaimIdlePages();
+
         constexpr Pool GetPool() const {
             return m_pool;
         }
@@ -285,7 +354,7 @@ private:
             }
         }
 
-        void Close(KPhysicalAddress address, size_t num_pages) {
+        void Close(KPhysicalAddress address, size_t num_pages, KPageHeapCache* cache) {
             size_t index = this->GetPageOffset(address);
             const size_t end = index + num_pages;
 
@@ -305,7 +374,8 @@ private:
                     }
                 } else {
                     if (free_count > 0) {
-                        this->Free(m_heap.GetAddress() + free_start * PageSize, free_count);
+                        this->Free(m_heap.GetAddress() + free_start * PageSize, free_count,
+                                   cache);
                         free_count = 0;
                     }
                 }
@@ -314,21 +384,70 @@ private:
             }
 
             if (free_count > 0) {
-                this->Free(m_heap.GetAddress() + free_start * PageSize, free_count);
+                this->Free(m_heap.GetAddress() + free_start * PageSize, free_count, cache);
             }
         }
 
     private:
         using RefCount = u16;
 
+        /// Releases free pages to the host, remembering that they read as zero if it could
+        void Discard(KPhysicalAddress address, size_t num_pages);
+
+        void SetZeroed(size_t index, size_t num_pages, bool zeroed);
+
+        /// Returns the end of the run of pages from index whose zeroed state is the given one
+        size_t FindZeroedRunEnd(size_t index, size_t end, bool zeroed) const;
+
         KPageHeap m_heap;
         std::vector<RefCount> m_page_reference_counts;
+        // Free pages known to read as zero. A page keeps its bit while it is allocated, until
+        // it is cleared or freed again.
+        std::unique_ptr<std::atomic<u64>[]> m_zeroed_pages;
+        // Pages found free by the last reclaim and not freed since, allocated on first use.
+        KIdlePageBitmap m_idle_pages;
+        Core::DeviceMemory* m_device_memory{};
         KVirtualAddress m_management_region{};
         Pool m_pool{};
         Impl* m_next{};
         Impl* m_prev{};
     };
 
+    /// The heaps of a pool as its page caches see them, searched in the order of a direction
+    class PoolHeaps {
+    public:
+        PoolHeaps(KMemoryManager& manager, Pool pool, Direction dir)
+            : m_manager{manager}, m_pool{pool}, m_dir{dir} {}
+
+        KLightLock& GetLock() {
+            return m_manager.m_pool_locks[static_cast<size_t>(m_pool)];
+        }
+
+        bool IsCacheable() const {
+            return !m_manager.m_has_optimized_process[static_cast<size_t>(m_pool)];
+        }
+
+        KPhysicalAddress AllocateBlock(s32 index, bool random) {
+            for (Impl* manager = m_manager.GetFirstManager(m_pool, m_dir); manager != nullptr;
+                 manager = m_manager.GetNextManager(manager, m_dir)) {
+                if (const KPhysicalAddress block = manager->AllocateBlock(index, random);
+                    block != 0) {
+                    return block;
+                }
+            }
+            return 0;
+        }
+
+        void Free(KPhysicalAddress address, size_t num_pages) {
+            m_manager.GetManager(address).Free(address, num_pages);
+        }
+
+    private:
+        KMemoryManager& m_manager;
+        const Pool m_pool;
+        const Direction m_dir;
+    };
+
 private:
     Impl& GetManager(KPhysicalAddress address) {
         return m_managers[m_memory_layout.GetPhysicalLinearRegion(address).GetAttributes()];
@@ -354,6 +473,26 @@ private:
     Result AllocatePageGroupImpl(KPageGroup* out, size_t num_pages, Pool pool, Direction dir,
                                  bool unoptimized, bool random);
 
+    /// Returns the page cache of the current core, host threads share the last one
+    KPageHeapCache& GetPageCache(Pool pool);
+
+    /// Returns the cache freed pages of the pool go to, if any. The pool has to be locked.
+    KPageHeapCache* GetPageCacheForFree(Pool pool) {
+        return m_has_optimized_process[static_cast<size_t>(pool)] ? nullptr
+                                                                  : &this->GetPageCache(pool);
+    }
+
+    /// Allocates a small page group from the page cache of the current core, refilling it from
+    /// the heaps if needed. Returns false, leaving out empty, if the group can't be allocated so.
+    bool AllocateFromPageCache(KPageGroup* out, size_t num_pages, Pool pool, Direction dir,
+                               bool random);
+
+    /// Returns the cached blocks of the pool to the heaps, the pool has to be locked.
+    /// Returns whether any page was freed.
+    bool DrainPageCaches(Pool pool);
+
+    void RecordAllocation(Pool pool, bool cached, std::chrono::nanoseconds latency);
+
 private:
     template <typename T>
     using PoolArray = std::array<T, static_cast<size_t>(Pool::Count)>;
@@ -366,7 +505,19 @@ private:
     std::array<Impl, MaxManagerCount> m_managers;
     size_t m_num_managers{};
     PoolArray<u64> m_optimized_process_ids{};
-    PoolArray<bool> m_has_optimized_process{};
+    PoolArray<std::atomic<bool>> m_has_optimized_process{};
+
+    // Caches of the cores, followed by one shared by host threads.
+    static constexpr size_t NumPageCaches = Core::Hardware::NUM_CPU_CORES + 1;
+    PoolArray<std::array<KPageHeapCache, NumPageCaches>> m_page_caches;
+
+    struct AllocationCounters {
+        std::atomic<u64> num_allocations;
+        std::atomic<u64> num_cached_allocations;
+        std::atomic<u64> total_latency_ns;
+        std::atomic<u64> max_latency_ns;
+    };
+    PoolArray<AllocationCounters> m_allocation_counters{};
 };
 
 } // namespace Kernel
@@ -225,6 +225,22 @@ public:
         m_num_bits--;
     }
 
+    /// Calls func(offset) for each set bit, in increasing order
+    template <typename Func>
+    void ForEachSetBit(Func&& func) const {
+        const s32 depth = this->GetHighestDepthIndex();
+        if (depth < 0) {
+            return;
+        }
+        const u64* bits = m_bit_storages[depth];
+        const size_t num_entries = static_cast<size_t>(m_end_storages[depth] - bits);
+        for (size_t i = 0; i < num_entries; i++) {
+            for (u64 v = bits[i]; v != 0; v &= v - 1) {
+                func(i * Common::BitSize<u64>() + static_cast<size_t>(std::countr_zero(v)));
+            }
+        }
+    }
+
     bool ClearRange(size_t offset, size_t count) {
         s32 depth = this->GetHighestDepthIndex();
         u64* bits = m_bit_storages[depth];
@@ -22,18 +22,8 @@ void KPageGroup::Finalize() {
 }
 
 void KPageGroup::CloseAndReset() {
-    auto& mm = m_kernel.MemoryManager();
-
-    KBlockInfo* cur = m_first_block;
-    while (cur != nullptr) {
-        KBlockInfo* next = cur->GetNext();
-        mm.Close(cur->GetAddress(), cur->GetNumPages());
-        m_manager->Free(cur);
-        cur = next;
-    }
-
-    m_first_block = nullptr;
-    m_last_block = nullptr;
+    this->Close();
+    this->Finalize();
 }
 
 size_t KPageGroup::GetNumPages() const {
@@ -93,11 +83,7 @@ void KPageGroup::OpenFirst() const {
 }
 
 void KPageGroup::Close() const {
-    auto& mm = m_kernel.MemoryManager();
-
-    for (const auto& it : *this) {
-        mm.Close(it.GetAddress(), it.GetNumPages());
-    }
+    m_kernel.MemoryManager().Close(*this);
 }
 
 bool KPageGroup::IsEquivalentTo(const KPageGroup& rhs) const {
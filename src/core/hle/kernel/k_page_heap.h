@@ -69,6 +69,16 @@ public:
 
     void Free(KPhysicalAddress addr, size_t num_pages);
 
+    /// Calls func(address, num_pages) for each free block, the heap must not change meanwhile
+    template <typename Func>
+    void ForEachFreeBlock(Func&& func) const {
+        for (size_t i = 0; i < m_num_blocks; i++) {
+            const size_t block_pages = m_blocks[i].GetNumPages();
+            m_blocks[i].ForEachFreeBlock(
+                [&](KPhysicalAddress block) { func(block, block_pages); });
+        }
+    }
+
     static size_t CalculateManagementOverheadSize(size_t region_size) {
         return CalculateManagementOverheadSize(region_size, MemoryBlockPageShifts.data(),
                                                NumMemoryBlockPageShifts);
@@ -162,6 +172,12 @@ private:
             return {};
         }
 
+        template <typename Func>
+        void ForEachFreeBlock(Func&& func) const {
+            m_bitmap.ForEachSetBit(
+                [&](size_t offset) { func(m_heap_address + (offset << this->GetShift())); });
+        }
+
         KPhysicalAddress PopBlock(bool random) {
             // Find a free block.
             s64 soffset = m_bitmap.FindFreeBlock(random);
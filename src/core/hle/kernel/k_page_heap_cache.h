@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#include "common/alignment.h"
+#include "common/common_funcs.h"
+#include "common/scope_exit.h"
+#include "core/hle/kernel/k_page_heap.h"
+#include "core/hle/kernel/k_scoped_lock.h"
+#include "core/hle/kernel/k_spin_lock.h"
+#include "core/hle/kernel/k_typed_address.h"
+#include "core/hle/kernel/svc_results.h"
+#include "core/hle/result.h"
+
+namespace Kernel {
+
+/**
+ * Free blocks of the smallest sizes of the page heaps of a pool, kept for one core.
+ *
+ * Cached blocks are allocated from their heap but referenced by nothing. Small allocations take
+ * them from the cache of their core without the lock of the pool, which is only needed to move
+ * blocks between a cache and the heaps a batch at a time.
+ *
+ * The heaps are reached through a pool adapter, which KMemoryManager implements over the managers
+ * of a pool. It provides:
+ * - GetLock(), the lock of the pool.
+ * - IsCacheable(), false while allocations of the pool have to be tracked. It only becomes false
+ *   with the pool locked, and the caches of the pool are drained when it does.
+ * - AllocateBlock(index, random) and Free(address, num_pages), to allocate and free blocks of the
+ *   heaps without going through the caches. The pool has to be locked.
+ */
+class KPageHeapCache {
+public:
+    /// Block sizes cached, the smallest ones of KPageHeap
+    static constexpr s32 NumCachedBlockSizes = 2;
+
+    /// Blocks of each size moved from the heaps to a cache at once
+    static constexpr size_t BatchSize = 16;
+
+    /// Blocks of each size held by a cache at most
+    static constexpr size_t Capacity = 2 * BatchSize;
+
+    /// Largest allocation or free, in pages, served by the caches
+    static constexpr size_t MaxCachedPages = 4 * KPageHeap::GetBlockNumPages(1);
+
+    KPageHeapCache() = default;
+
+    UZUY_NON_COPYABLE(KPageHeapCache);
+    UZUY_NON_MOVEABLE(KPageHeapCache);
+
+    /// Takes a cached block of the size index, returns 0 if there is none
+    KPhysicalAddress Pop(s32 index) {
+        KScopedSpinLock lk(m_lock);
+        Blocks& blocks = m_blocks[index];
+        if (blocks.count == 0) {
+            return 0;
+        }
+        m_num_cached_pages.fetch_sub(KPageHeap::GetBlockNumPages(index),
+                                     std::memory_order_relaxed);
+        return blocks.addresses[--blocks.count];
+    }
+
+    /// Caches a free block of the size index, returns false if the cache is full
+    bool Push(s32 index, KPhysicalAddress block) {
+        KScopedSpinLock lk(m_lock);
+        Blocks& blocks = m_blocks[index];
+        if (blocks.count == Capacity) {
+            return false;
+        }
+        blocks.addresses[blocks.count++] = block;
+        m_num_cached_pages.fetch_add(KPageHeap::GetBlockNumPages(index),
+                                     std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Caches the blocks at the start of a freed run while they fit, calling func(block, num_pages)
+    /// for each. Advances address and num_pages past the cached blocks.
+    template <typename Func>
+    void PushRun(KPhysicalAddress& address, size_t& num_pages, Func&& func) {
+        if (num_pages > MaxCachedPages) {
+            return;
+        }
+        for (s32 index = NumCachedBlockSizes - 1; index >= 0; index--) {
+            const size_t block_pages = KPageHeap::GetBlockNumPages(index);
+            while (num_pages >= block_pages &&
+                   Common::IsAligned(GetInteger(address), block_pages * PageSize) &&
+                   this->Push(index, address)) {
+                func(address, block_pages);
+                address += block_pages * PageSize;
+                num_pages -= block_pages;
+            }
+        }
+    }
+
+    /// Removes every cached block, calling func(block, num_pages) for each.
+    /// Returns the number of pages removed.
+    template <typename Func>
+    size_t Drain(Func&& func) {
+        KScopedSpinLock lk(m_lock);
+        size_t num_pages = 0;
+        for (s32 index = 0; index < NumCachedBlockSizes; index++) {
+            Blocks& blocks = m_blocks[index];
+            const size_t block_pages = KPageHeap::GetBlockNumPages(index);
+            for (size_t i = 0; i < blocks.count; i++) {
+                func(blocks.addresses[i], block_pages);
+            }
+            num_pages += blocks.count * block_pages;
+            blocks.count = 0;
+        }
+        m_num_cached_pages.fetch_sub(num_pages, std::memory_order_relaxed);
+        return num_pages;
+    }
+
+    /// Allocates a small page group from this cache, refilling it from the heaps of the pool when
+    /// it runs out. Returns false, leaving out empty, if the group can't be allocated so.
+    template <typename Pool, typename PageGroup>
+    bool Allocate(Pool& pool, PageGroup* out, size_t num_pages, bool random) {
+        if (num_pages == 0 || num_pages > MaxCachedPages || !pool.IsCacheable()) {
+            return false;
+        }
+
+        // Return the blocks taken so far to the heaps if we fail.
+        bool success = false;
+        SCOPE_EXIT {
+            if (!success) {
+                KScopedLock lk(pool.GetLock());
+                for (const auto& block : *out) {
+                    pool.Free(block.GetAddress(), block.GetNumPages());
+                }
+                out->Finalize();
+            }
+        };
+
+        const s32 heap_index =
+            std::min(KPageHeap::GetBlockIndex(num_pages), NumCachedBlockSizes - 1);
+        for (s32 index = heap_index; index >= 0 && num_pages > 0; index--) {
+            const size_t pages_per_alloc = KPageHeap::GetBlockNumPages(index);
+            while (num_pages >= pages_per_alloc) {
+                const KPhysicalAddress block = this->Pop(index);
+                if (block == 0) {
+                    if (!this->Refill(pool, index, random)) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (out->AddBlock(block, pages_per_alloc) != ResultSuccess) {
+                    KScopedLock lk(pool.GetLock());
+                    pool.Free(block, pages_per_alloc);
+                    return false;
+                }
+                num_pages -= pages_per_alloc;
+            }
+        }
+
+        // The pool may have started tracking allocations while blocks were taken, they then have
+        // to be allocated again with the pool locked.
+        success = pool.IsCacheable();
+        return success;
+    }
+
+    /// Moves a batch of blocks of the size index from the heaps of the pool to this cache.
+    /// Returns whether any block was moved.
+    template <typename Pool>
+    bool Refill(Pool& pool, s32 index, bool random) {
+        KScopedLock lk(pool.GetLock());
+        if (!pool.IsCacheable()) {
+            return false;
+        }
+
+        // Move a batch of blocks at once, so that the next allocations don't need the lock.
+        size_t num_blocks = 0;
+        while (num_blocks < BatchSize) {
+            const KPhysicalAddress block = pool.AllocateBlock(index, random);
+            if (block == 0) {
+                break;
+            }
+            if (!this->Push(index, block)) {
+                pool.Free(block, KPageHeap::GetBlockNumPages(index));
+                break;
+            }
+            num_blocks++;
+        }
+
+        m_num_refills.fetch_add(1, std::memory_order_relaxed);
+        return num_blocks > 0;
+    }
+
+    /// Returns the blocks of the caches of a pool to its heaps, the pool has to be locked.
+    /// Returns whether any page was freed.
+    template <typename Pool>
+    static bool DrainAll(Pool& pool, std::span<KPageHeapCache> caches) {
+        size_t num_pages = 0;
+        for (auto& cache : caches) {
+            num_pages += cache.Drain([&](KPhysicalAddress block, size_t block_pages) {
+                pool.Free(block, block_pages);
+            });
+        }
+        return num_pages > 0;
+    }
+
+    /// Calls allocate, and once more after returning the cached blocks of the pool to its heaps if
+    /// it ran out of memory. The pool has to be locked.
+    template <typename Pool, typename Func>
+    static Result AllocateOrDrain(Pool& pool, std::span<KPageHeapCache> caches, Func&& allocate) {
+        Result result = allocate();
+        if (result == ResultOutOfMemory && DrainAll(pool, caches)) {
+            result = allocate();
+        }
+        return result;
+    }
+
+    /// Closes a reference to every page of a group. close(address, num_pages) closes pages of one
+    /// heap from address and returns how many it closed, with the lock get_lock(address) of their
+    /// pool held. The lock is kept across consecutive blocks of a pool, instead of relocking for
+    /// each of them.
+    template <typename PageGroup, typename GetLockFunc, typename CloseFunc>
+    static void ClosePageGroup(const PageGroup& group, GetLockFunc&& get_lock, CloseFunc&& close) {
+        using Lock = std::remove_reference_t<decltype(get_lock(KPhysicalAddress{}))>;
+        Lock* locked_pool = nullptr;
+        SCOPE_EXIT {
+            if (locked_pool != nullptr) {
+                locked_pool->Unlock();
+            }
+        };
+
+        for (const auto& block : group) {
+            KPhysicalAddress address = block.GetAddress();
+            size_t num_pages = block.GetNumPages();
+            while (num_pages > 0) {
+                Lock* const pool_lock = std::addressof(get_lock(address));
+                if (pool_lock != locked_pool) {
+                    if (locked_pool != nullptr) {
+                        locked_pool->Unlock();
+                    }
+                    pool_lock->Lock();
+                    locked_pool = pool_lock;
+                }
+                const size_t cur_pages = close(address, num_pages);
+                num_pages -= cur_pages;
+                address += cur_pages * PageSize;
+            }
+        }
+    }
+
+    size_t GetNumCachedPages() const {
+        return m_num_cached_pages.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the batches of blocks moved from the heaps to this cache
+    u64 GetNumRefills() const {
+        return m_num_refills.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Blocks {
+        std::array<KPhysicalAddress, Capacity> addresses{};
+        size_t count{};
+    };
+
+    KSpinLock m_lock;
+    std::array<Blocks, NumCachedBlockSizes> m_blocks{};
+    std::atomic<size_t> m_num_cached_pages{};
+    std::atomic<u64> m_num_refills{};
+};
+
+} // namespace Kernel
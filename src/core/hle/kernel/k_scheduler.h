@@ -63,6 +63,10 @@ public:
         return m_current_thread.load() == m_idle_thread;
     }
 
+    bool NeedsScheduling() const {
+        return m_state.needs_scheduling.load();
+    }
+
     KThread* GetPreviousThread() const {
         return m_state.prev_thread;
     }
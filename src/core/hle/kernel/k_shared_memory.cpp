@@ -60,7 +60,7 @@ Result KSharedMemory::Initialize(Core::DeviceMemory& device_memory, KProcess* ow
 
     // Clear all pages in the memory.
     for (const auto& block : *m_page_group) {
-        std::memset(m_device_memory->GetPointer<void>(block.GetAddress()), 0, block.GetSize());
+        m_kernel.MemoryManager().Clear(block.GetAddress(), block.GetNumPages(), 0);
     }
 
     R_SUCCEED();
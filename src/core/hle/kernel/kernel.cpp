@@ -14,6 +14,7 @@
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/settings.h"
 #include "common/thread.h"
 #include "common/thread_worker.h"
 #include "core/arm/arm_interface.h"
@@ -40,7 +41,9 @@
 #include "core/hle/kernel/k_thread.h"
 #include "core/hle/kernel/k_worker_task_manager.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/memory_reclaimer.h"
 #include "core/hle/kernel/physical_core.h"
+#include "core/hle/kernel/svc_statistics.h"
 #include "core/hle/result.h"
 #include "core/hle/service/server_manager.h"
 #include "core/hle/service/sm/sm.h"
@@ -95,6 +98,10 @@ struct KernelCore::Impl {
 
         InitializeHackSharedMemory(kernel);
         RegisterHostThread(nullptr);
+
+        if (Settings::values.reclaim_idle_memory.GetValue()) {
+            memory_reclaimer = std::make_unique<MemoryReclaimer>(kernel);
+        }
     }
 
     void TerminateAllProcesses() {
@@ -113,8 +120,12 @@ struct KernelCore::Impl {
             is_shutting_down.store(false, std::memory_order_relaxed);
         };
 
+        memory_reclaimer.reset();
         CloseServices();
 
+        svc_statistics.Log();
+        svc_statistics.Reset();
+
         if (application_process) {
             application_process->Close();
             application_process = nullptr;
@@ -807,6 +818,7 @@ struct KernelCore::Impl {
 
     // Kernel memory management
     std::unique_ptr<KMemoryManager> memory_manager;
+    std::unique_ptr<MemoryReclaimer> memory_reclaimer;
 
     // Resource managers
     std::unique_ptr<KDynamicPageManager> resource_manager_page_manager;
@@ -841,6 +853,7 @@ struct KernelCore::Impl {
     u32 single_core_thread_id{};
 
     std::array<u64, Core::Hardware::NUM_CPU_CORES> svc_ticks{};
+    SvcStatistics svc_statistics;
 
     KWorkerTaskManager worker_task_manager;
 
@@ -1286,6 +1299,10 @@ void KernelCore::ExitSVCProfile() {
     MicroProfileLeave(MICROPROFILE_TOKEN(Kernel_SVC), impl->svc_ticks[CurrentPhysicalCoreIndex()]);
 }
 
+void KernelCore::RecordSVC(u32 svc_id, bool inline_call, std::chrono::nanoseconds host_time) {
+    impl->svc_statistics.Record(CurrentPhysicalCoreIndex(), svc_id, inline_call, host_time);
+}
+
 Init::KSlabResourceCounts& KernelCore::SlabResourceCounts() {
     return impl->slab_resource_counts;
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <functional>
 #include <list>
 #include <memory>
@@ -275,6 +276,9 @@ public:
 
     void ExitSVCProfile();
 
+    /// Accounts a supervisor call made on the current core in the SVC statistics
+    void RecordSVC(u32 svc_id, bool inline_call, std::chrono::nanoseconds host_time);
+
     /// Workaround for single-core mode when preempting threads while idle.
     bool IsPhantomModeForSingleCore() const;
     void SetIsPhantomModeForSingleCore(bool value);
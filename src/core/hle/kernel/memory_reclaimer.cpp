@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/memory_detect.h"
+#include "core/core.h"
+#include "core/device_memory.h"
+#include "core/hle/kernel/k_memory_manager.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/memory_reclaimer.h"
+
+namespace Kernel {
+
+using namespace Common::Literals;
+
+MemoryReclaimer::MemoryReclaimer(KernelCore& kernel) : m_kernel{kernel} {
+    m_thread = m_kernel.RunOnHostCoreProcess("MemoryReclaimer", [this] { this->Run(); });
+}
+
+MemoryReclaimer::~MemoryReclaimer() {
+    m_stop_event.Set();
+    m_thread.join();
+
+    const auto usage = Common::GetProcessMemoryUsage();
+    LOG_INFO(Kernel, "Released {} MiB of idle guest memory in {} scans, {} MiB resident at exit",
+             m_reclaimed_bytes.load() / 1_MiB, m_num_scans.load(), usage.ResidentMemory / 1_MiB);
+}
+
+void MemoryReclaimer::Run() {
+    auto& device_memory = m_kernel.System().DeviceMemory();
+    while (!m_stop_event.WaitFor(ScanInterval)) {
+        const size_t num_pages = m_kernel.MemoryManager().ReclaimIdlePages();
+        m_num_scans.fetch_add(1, std::memory_order_relaxed);
+        m_reclaimed_bytes.fetch_add(num_pages * PageSize, std::memory_order_relaxed);
+
+        const auto usage = Common::GetProcessMemoryUsage();
+        LOG_DEBUG(Kernel,
+                  "Released {} idle pages, guest memory {} MiB, process {} MiB resident "
+                  "({} MiB shared, {} MiB private)",
+                  num_pages, device_memory.buffer.GetCommittedSize().value_or(0) / 1_MiB,
+                  usage.ResidentMemory / 1_MiB, usage.SharedMemory / 1_MiB,
+                  usage.PrivateMemory / 1_MiB);
+    }
+}
+
+} // namespace Kernel
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "common/common_types.h"
+#include "common/thread.h"
+
+namespace Kernel {
+
+class KernelCore;
+
+/**
+ * Reduces the host memory held by the emulated physical memory, so that several instances fit on
+ * one host. Pages that stay free for a whole scan interval are released to the host.
+ */
+class MemoryReclaimer {
+public:
+    /// Time between two scans of the free pages, pages free for as long are released
+    static constexpr std::chrono::seconds ScanInterval{10};
+
+    struct Statistics {
+        u64 num_scans;
+        u64 reclaimed_bytes;
+    };
+
+    explicit MemoryReclaimer(KernelCore& kernel);
+    ~MemoryReclaimer();
+
+    [[nodiscard]] Statistics GetStatistics() const {
+        return {
+            .num_scans = m_num_scans.load(std::memory_order_relaxed),
+            .reclaimed_bytes = m_reclaimed_bytes.load(std::memory_order_relaxed),
+        };
+    }
+
+private:
+    void Run();
+
+    KernelCore& m_kernel;
+    std::atomic<u64> m_num_scans{};
+    std::atomic<u64> m_reclaimed_bytes{};
+    Common::Event m_stop_event;
+    std::jthread m_thread;
+};
+
+} // namespace Kernel
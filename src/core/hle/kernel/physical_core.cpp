@@ -4,8 +4,10 @@
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/debugger/debugger.h"
 #include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/k_scheduler.h"
 #include "core/hle/kernel/k_thread.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/physical_core.h"
@@ -16,8 +18,19 @@ namespace Kernel {
 PhysicalCore::PhysicalCore(KernelCore& kernel, std::size_t core_index)
     : m_kernel{kernel}, m_core_index{core_index} {
     m_is_single_core = !kernel.IsMulticore();
+    m_park_spinning_threads = Settings::values.cpu_park_spinning_threads.GetValue();
+    m_record_svc_statistics = Settings::values.record_svc_statistics.GetValue();
+}
+
+PhysicalCore::~PhysicalCore() {
+    const auto statistics = m_idle_loop_detector.GetStatistics();
+    if (statistics.num_parks != 0) {
+        LOG_DEBUG(Kernel, "Core {} parked {} times for {} ms while guest threads were spinning",
+                  m_core_index, statistics.num_parks,
+                  std::chrono::duration_cast<std::chrono::milliseconds>(statistics.parked_time)
+                      .count());
+    }
 }
-PhysicalCore::~PhysicalCore() = default;
 
 void PhysicalCore::RunThread(Kernel::KThread* thread) {
     auto* process = thread->GetOwnerProcess();
@@ -103,6 +116,7 @@ void PhysicalCore::RunThread(Kernel::KThread* thread) {
         const bool breakpoint = True(hr & Core::HaltReason::InstructionBreakpoint);
         const bool data_abort = True(hr & Core::HaltReason::DataAbort);
         const bool interrupt = True(hr & Core::HaltReason::BreakLoop);
+        const bool reschedule = True(hr & Core::HaltReason::Reschedule);
 
         // Since scheduling may occur here, we cannot use any cached
         // state after returning from calls we make.
@@ -138,6 +152,13 @@ void PhysicalCore::RunThread(Kernel::KThread* thread) {
             return;
         }
 
+        // Switch threads if a call performed inside the JIT made one runnable on this core.
+        if (reschedule) {
+            KScheduler::DisableScheduling(m_kernel);
+            KScheduler::EnableScheduling(m_kernel, 0);
+            return;
+        }
+
         // Handle external interrupt sources.
         if (interrupt || m_is_single_core) {
             return;
@@ -208,6 +229,40 @@ void PhysicalCore::Idle() {
     m_on_interrupt.wait(lk, [this] { return m_is_interrupted; });
 }
 
+bool PhysicalCore::IsTimingSupervisorCalls() const {
+    return m_record_svc_statistics || (!m_is_single_core && m_park_spinning_threads);
+}
+
+void PhysicalCore::OnSupervisorCall(u32 svc_id, bool inline_call, bool is_polling,
+                                    IdleLoopDetector::Clock::time_point start_time,
+                                    IdleLoopDetector::Clock::time_point end_time) {
+    if (m_record_svc_statistics) {
+        m_kernel.RecordSVC(svc_id, inline_call, end_time - start_time);
+    }
+
+    // Single core emulation runs the cores in turn on virtual time, parking would stall them all.
+    if (m_is_single_core || !m_park_spinning_threads) {
+        return;
+    }
+    auto park_time = m_idle_loop_detector.OnSupervisorCall(GetCurrentThreadPointer(m_kernel),
+                                                           is_polling, start_time, end_time);
+    if (park_time == std::chrono::nanoseconds::zero()) {
+        return;
+    }
+
+    // Stop at the next timing event, it may signal what the thread is polling for.
+    if (const auto next_event = m_kernel.System().CoreTiming().GetTimeUntilNextEvent()) {
+        park_time = std::min(park_time, *next_event);
+    }
+
+    const auto park_start = IdleLoopDetector::Clock::now();
+    {
+        std::unique_lock lk{m_guard};
+        m_on_interrupt.wait_for(lk, park_time, [this] { return m_is_interrupted; });
+    }
+    m_idle_loop_detector.OnParked(park_start, IdleLoopDetector::Clock::now());
+}
+
 bool PhysicalCore::IsInterrupted() const {
     return m_is_interrupted;
 }
@@ -9,6 +9,7 @@
 #include <mutex>
 
 #include "core/arm/arm_interface.h"
+#include "core/hle/kernel/idle_loop_detector.h"
 
 namespace Kernel {
 class KernelCore;
@@ -49,6 +50,16 @@ public:
     // Wait for an interrupt.
     void Idle();
 
+    // Check if supervisor calls made on this core have to be timed, reading the host clock
+    // around every call is only worth it when the statistics or the idle loop detector need it.
+    bool IsTimingSupervisorCalls() const;
+
+    // Account a timed supervisor call made on this core, and park the core for a while if the
+    // calling thread is spinning.
+    void OnSupervisorCall(u32 svc_id, bool inline_call, bool is_polling,
+                          IdleLoopDetector::Clock::time_point start_time,
+                          IdleLoopDetector::Clock::time_point end_time);
+
     // Interrupt this core.
     void Interrupt();
 
@@ -72,6 +83,9 @@ private:
     KThread* m_current_thread{};
     bool m_is_interrupted{};
     bool m_is_single_core{};
+    bool m_park_spinning_threads{};
+    bool m_record_svc_statistics{};
+    IdleLoopDetector m_idle_loop_detector;
 };
 
 } // namespace Kernel
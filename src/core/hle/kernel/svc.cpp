@@ -3,12 +3,17 @@
 
 // This file is automatically generated using svc_generator.py.
 
+#include <chrono>
+#include <span>
 #include <type_traits>
 
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/k_scheduler.h"
+#include "core/hle/kernel/physical_core.h"
 #include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_call.h"
 
 namespace Kernel::Svc {
 
@@ -4422,22 +4427,89 @@ static void Call64(Core::System& system, u32 imm, std::span<uint64_t, 8> args) {
 }
 // clang-format on
 
-void Call(Core::System& system, u32 imm) {
-    auto& kernel = system.Kernel();
-    auto& process = GetCurrentProcess(kernel);
+namespace {
 
-    std::array<uint64_t, 8> args;
-    kernel.CurrentPhysicalCore().SaveSvcArguments(process, args);
-    kernel.EnterSVCProfile();
+/// Call context of the current thread of the emulated system
+class SystemCallContext {
+public:
+    explicit SystemCallContext(Core::System& system_)
+        : system{system_}, kernel{system_.Kernel()}, process{GetCurrentProcess(kernel)} {}
 
-    if (process.Is64Bit()) {
-        Call64(system, imm, args);
-    } else {
-        Call32(system, imm, args);
+    bool IsMulticore() const {
+        return kernel.IsMulticore();
+    }
+
+    bool Is64Bit() const {
+        return process.Is64Bit();
+    }
+
+    void SaveSvcArguments(std::span<uint64_t, 8> args) {
+        kernel.CurrentPhysicalCore().SaveSvcArguments(process, args);
+    }
+
+    void LoadSvcArguments(std::span<const uint64_t, 8> args) {
+        kernel.CurrentPhysicalCore().LoadSvcArguments(process, args);
+    }
+
+    void EnterSVCProfile() {
+        kernel.EnterSVCProfile();
+    }
+
+    void ExitSVCProfile() {
+        kernel.ExitSVCProfile();
+    }
+
+    bool IsTimingSupervisorCalls() const {
+        return kernel.CurrentPhysicalCore().IsTimingSupervisorCalls();
+    }
+
+    void OnSupervisorCall(u32 imm, bool is_inline, bool is_polling,
+                          std::chrono::steady_clock::time_point start_time,
+                          std::chrono::steady_clock::time_point end_time) {
+        kernel.CurrentPhysicalCore().OnSupervisorCall(imm, is_inline, is_polling, start_time,
+                                                      end_time);
+    }
+
+    void DisableDispatch() {
+        GetCurrentThread(kernel).DisableDispatch();
+    }
+
+    void EnableDispatch() {
+        GetCurrentThread(kernel).EnableDispatch();
+    }
+
+    bool NeedsScheduling() {
+        return kernel.CurrentScheduler()->NeedsScheduling();
     }
 
-    kernel.ExitSVCProfile();
-    kernel.CurrentPhysicalCore().LoadSvcArguments(process, args);
+    void Dispatch(u32 imm, std::span<uint64_t, 8> args) {
+        if (process.Is64Bit()) {
+            Call64(system, imm, args);
+        } else {
+            Call32(system, imm, args);
+        }
+    }
+
+private:
+    Core::System& system;
+    KernelCore& kernel;
+    KProcess& process;
+};
+
+} // Anonymous namespace
+
+void Call(Core::System& system, u32 imm) {
+    SystemCallContext ctx{system};
+    PerformCall(ctx, imm);
+}
+
+bool CallInline(Core::System& system, u32 imm, bool* out_needs_scheduling) {
+    // Most calls can never be made inline, skip looking up the current process for them.
+    if (!IsInlineCall(imm)) {
+        return false;
+    }
+    SystemCallContext ctx{system};
+    return PerformCallInline(ctx, imm, out_needs_scheduling);
 }
 
 } // namespace Kernel::Svc
@@ -535,4 +535,8 @@ void SvcWrap_CallSecureMonitor64(Core::System& system, std::span<uint64_t, 8> ar
 // Perform a supervisor call by index.
 void Call(Core::System& system, u32 imm);
 
+// Perform a supervisor call by index from within guest code, if it cannot block.
+// Returns false if the call has to be performed with Call instead.
+bool CallInline(Core::System& system, u32 imm, bool* out_needs_scheduling);
+
 } // namespace Kernel::Svc
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <span>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/idle_loop_detector.h"
+#include "core/hle/kernel/svc.h"
+
+namespace Kernel::Svc {
+
+/// Returns whether a supervisor call may be made without leaving the JIT, if its arguments allow
+constexpr bool IsInlineCall(u32 imm) {
+    switch (static_cast<SvcId>(imm)) {
+    case SvcId::GetSystemTick:
+    case SvcId::ArbitrateUnlock:
+    case SvcId::SignalProcessWideKey:
+    case SvcId::WaitSynchronization:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Returns whether a supervisor call with the given arguments never blocks the calling thread
+constexpr bool CanCallInline(u32 imm, std::span<const uint64_t, 8> args, bool is_64bit) {
+    if (!IsInlineCall(imm)) {
+        return false;
+    }
+    // Waits only qualify when they poll, with a zero timeout.
+    if (static_cast<SvcId>(imm) == SvcId::WaitSynchronization) {
+        return is_64bit ? args[3] == 0
+                        : static_cast<u32>(args[0]) == 0 && static_cast<u32>(args[3]) == 0;
+    }
+    return true;
+}
+
+namespace Detail {
+
+template <typename Context>
+void Perform(Context& ctx, u32 imm, std::array<uint64_t, 8>& args, bool* out_needs_scheduling) {
+    const bool is_inline = out_needs_scheduling != nullptr;
+    ctx.EnterSVCProfile();
+    const bool is_timed = ctx.IsTimingSupervisorCalls();
+    const auto start_time = is_timed ? std::chrono::steady_clock::now()
+                                     : std::chrono::steady_clock::time_point{};
+
+    // Threads made runnable by the call cannot be switched to while the JIT is running the
+    // current one, so keep dispatch disabled and let the caller reschedule after leaving it.
+    if (is_inline) {
+        ctx.DisableDispatch();
+    }
+    ctx.Dispatch(imm, args);
+    if (is_inline) {
+        ctx.EnableDispatch();
+        *out_needs_scheduling = ctx.NeedsScheduling();
+    }
+
+    ctx.ExitSVCProfile();
+    ctx.LoadSvcArguments(args);
+    if (is_timed) {
+        ctx.OnSupervisorCall(imm, is_inline,
+                             IdleLoopDetector::IsPollingCall(imm, args, ctx.Is64Bit()), start_time,
+                             std::chrono::steady_clock::now());
+    }
+}
+
+} // namespace Detail
+
+/**
+ * Performs a supervisor call of the current thread of a call context. The context gives access to
+ * the registers of the thread, the handlers of the calls and the state of its core. Call and
+ * CallInline both go through here, so both read and write the registers the same way.
+ */
+template <typename Context>
+void PerformCall(Context& ctx, u32 imm) {
+    std::array<uint64_t, 8> args;
+    ctx.SaveSvcArguments(args);
+    Detail::Perform(ctx, imm, args, nullptr);
+}
+
+/// Performs a supervisor call from within guest code like PerformCall, if it cannot block.
+/// Returns false without touching the thread if it has to be performed with PerformCall instead.
+template <typename Context>
+bool PerformCallInline(Context& ctx, u32 imm, bool* out_needs_scheduling) {
+    if (!IsInlineCall(imm) || !ctx.IsMulticore()) {
+        return false;
+    }
+    std::array<uint64_t, 8> args;
+    ctx.SaveSvcArguments(args);
+    if (!CanCallInline(imm, args, ctx.Is64Bit())) {
+        return false;
+    }
+    Detail::Perform(ctx, imm, args, out_needs_scheduling);
+    return true;
+}
+
+} // namespace Kernel::Svc
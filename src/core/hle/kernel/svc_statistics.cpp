@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+#include "common/logging/log.h"
+#include "core/hle/kernel/svc_statistics.h"
+
+namespace Kernel {
+
+namespace {
+
+/// Number of calls logged by Log
+constexpr size_t NumLoggedSvcs = 16;
+
+std::chrono::nanoseconds Percentile(const std::array<u64, SvcStatistics::NumBuckets>& histogram,
+                                    u64 num_calls, u64 percent) {
+    const u64 rank = (num_calls * percent + 99) / 100;
+    u64 count = 0;
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        count += histogram[bucket];
+        if (count >= rank) {
+            return std::chrono::nanoseconds{u64{1} << bucket};
+        }
+    }
+    return std::chrono::nanoseconds{u64{1} << (SvcStatistics::NumBuckets - 1)};
+}
+
+} // Anonymous namespace
+
+void SvcStatistics::Record(size_t core, u32 svc_id, bool inline_call,
+                           std::chrono::nanoseconds host_time) {
+    Entry& entry = m_entries[core][svc_id % NumSvcs];
+    const u64 ns = static_cast<u64>(std::max<s64>(host_time.count(), 0));
+    ++entry.num_calls;
+    entry.num_inline_calls += inline_call ? 1 : 0;
+    entry.total_ns += ns;
+    ++entry.histogram[std::min<size_t>(std::bit_width(ns), NumBuckets - 1)];
+}
+
+SvcStatistics::Summary SvcStatistics::GetSummary(u32 svc_id) const {
+    Summary summary{};
+    std::array<u64, NumBuckets> histogram{};
+    u64 total_ns = 0;
+    for (const auto& core_entries : m_entries) {
+        const Entry& entry = core_entries[svc_id % NumSvcs];
+        summary.num_calls += entry.num_calls;
+        summary.num_inline_calls += entry.num_inline_calls;
+        total_ns += entry.total_ns;
+        for (size_t bucket = 0; bucket < NumBuckets; ++bucket) {
+            histogram[bucket] += entry.histogram[bucket];
+        }
+    }
+    if (summary.num_calls != 0) {
+        summary.total_time = std::chrono::nanoseconds{total_ns};
+        summary.p50 = Percentile(histogram, summary.num_calls, 50);
+        summary.p99 = Percentile(histogram, summary.num_calls, 99);
+    }
+    return summary;
+}
+
+void SvcStatistics::Log() const {
+    std::array<Summary, NumSvcs> summaries;
+    std::array<u32, NumSvcs> svc_ids;
+    for (u32 svc_id = 0; svc_id < NumSvcs; ++svc_id) {
+        summaries[svc_id] = GetSummary(svc_id);
+    }
+    std::iota(svc_ids.begin(), svc_ids.end(), 0U);
+    std::ranges::sort(svc_ids, [&](u32 lhs, u32 rhs) {
+        return summaries[lhs].total_time > summaries[rhs].total_time;
+    });
+
+    for (size_t i = 0; i < NumLoggedSvcs; ++i) {
+        const u32 svc_id = svc_ids[i];
+        const Summary& summary = summaries[svc_id];
+        if (summary.num_calls == 0) {
+            break;
+        }
+        LOG_INFO(Kernel_SVC,
+                 "SVC {:#04x}: {} calls ({} inline), {} us total, {} ns mean, p50 < {} ns, "
+                 "p99 < {} ns",
+                 svc_id, summary.num_calls, summary.num_inline_calls,
+                 summary.total_time.count() / 1000, summary.total_time.count() / summary.num_calls,
+                 summary.p50.count(), summary.p99.count());
+    }
+}
+
+void SvcStatistics::Reset() {
+    m_entries = {};
+}
+
+} // namespace Kernel
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include "common/common_types.h"
+#include "core/hardware_properties.h"
+
+namespace Kernel {
+
+/**
+ * Counters and host time histograms of the supervisor calls made on each core.
+ * Every core only records into its own entries, so recording takes no locks. The entries are
+ * read once the cores have stopped.
+ */
+class SvcStatistics {
+public:
+    /// Supervisor call ids are 7 bits wide
+    static constexpr size_t NumSvcs = 0x80;
+
+    /// Histogram bucket i counts the calls that took less than 2^i ns, and at least 2^(i-1) ns
+    static constexpr size_t NumBuckets = 32;
+
+    struct Summary {
+        u64 num_calls;
+        u64 num_inline_calls; ///< Calls made without leaving the JIT
+        std::chrono::nanoseconds total_time;
+        std::chrono::nanoseconds p50; ///< Upper bound of the median host time
+        std::chrono::nanoseconds p99; ///< Upper bound of the 99th percentile host time
+    };
+
+    /// Accounts a call made on a core
+    void Record(size_t core, u32 svc_id, bool inline_call, std::chrono::nanoseconds host_time);
+
+    /// Returns the statistics of a call summed over all cores
+    [[nodiscard]] Summary GetSummary(u32 svc_id) const;
+
+    /// Logs the calls that took the most host time
+    void Log() const;
+
+    void Reset();
+
+private:
+    struct Entry {
+        u64 num_calls;
+        u64 num_inline_calls;
+        u64 total_ns;
+        std::array<u32, NumBuckets> histogram;
+    };
+
+    std::array<std::array<Entry, NumSvcs>, Core::Hardware::NUM_CPU_CORES> m_entries{};
+};
+
+} // namespace Kernel
@@ -5,6 +5,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/kernel.h"
@@ -83,6 +84,18 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(HLERequestContext& ctx,
     }
 }
 
+const char* ServiceFrameworkBase::TraceRequestName(const FunctionInfoBase& info) {
+    if (!Common::Trace::IsRecording()) {
+        return nullptr;
+    }
+    std::scoped_lock lk{trace_name_lock};
+    if (!info.trace_name) {
+        info.trace_name =
+            Common::Trace::InternName(fmt::format("{}: {}", service_name, info.name));
+    }
+    return info.trace_name;
+}
+
 void ServiceFrameworkBase::InvokeRequest(HLERequestContext& ctx) {
     auto itr = handlers.find(ctx.GetCommand());
     const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
@@ -91,6 +104,7 @@ void ServiceFrameworkBase::InvokeRequest(HLERequestContext& ctx) {
     }
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName(), ctx.CommandBuffer()));
+    const Common::Trace::ScopedSpan span{TraceRequestName(*info)};
     handler_invoker(this, info->handler_callback, ctx);
 }
 
@@ -105,6 +119,7 @@ void ServiceFrameworkBase::InvokeRequestTipc(HLERequestContext& ctx) {
     }
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName(), ctx.CommandBuffer()));
+    const Common::Trace::ScopedSpan span{TraceRequestName(*info)};
     handler_invoker(this, info->handler_callback, ctx);
 }
 
@@ -92,6 +92,8 @@ private:
         u32 expected_header;
         HandlerFnP<ServiceFrameworkBase> handler_callback;
         const char* name;
+        /// Name of the request in trace captures, interned on first use while capturing
+        mutable const char* trace_name = nullptr;
     };
 
     using InvokerFn = void(ServiceFrameworkBase* object, HandlerFnP<ServiceFrameworkBase> member,
@@ -105,6 +107,9 @@ private:
     void RegisterHandlersBaseTipc(const FunctionInfoBase* functions, std::size_t n);
     void ReportUnimplementedFunction(HLERequestContext& ctx, const FunctionInfoBase* info);
 
+    /// Returns the name of a request in trace captures, or null when no capture is running
+    const char* TraceRequestName(const FunctionInfoBase& info);
+
     /// Maximum number of concurrent sessions that this service can handle.
     u32 max_sessions;
 
@@ -119,6 +124,9 @@ private:
 
     /// Used to gain exclusive access to the service members, e.g. from CoreTiming thread.
     std::mutex lock_service;
+
+    /// Guards the trace names of the handlers, which are not always invoked under lock_service
+    std::mutex trace_name_lock;
 };
 
 /**
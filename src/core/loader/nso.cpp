@@ -193,6 +193,9 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
     // Apply cheats if they exist and the program has a valid title ID
     if (pm) {
         system.SetApplicationProcessBuildID(nso_header.build_id);
+        if (name == "main") {
+            system.SetApplicationMainModule(nso_header.build_id, load_base, image_size);
+        }
         const auto cheats = pm->CreateCheatList(nso_header.build_id);
         if (!cheats.empty()) {
             system.RegisterCheatList(cheats, nso_header.build_id, load_base, image_size);
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/zstd_compression.h"
+#include "core/memory_snapshot.h"
+
+namespace Core {
+
+namespace {
+
+u64 Hash(std::span<const u8> memory) {
+    return Common::HashFast64(memory.data(), memory.size());
+}
+
+bool IsZero(std::span<const u8> memory) {
+    return std::all_of(memory.begin(), memory.end(), [](u8 value) { return value == 0; });
+}
+
+} // Anonymous namespace
+
+MemorySnapshot::MemorySnapshot(const MemorySnapshot* base) : m_base{base} {}
+
+MemorySnapshot::~MemorySnapshot() = default;
+
+MemorySnapshot::MemorySnapshot(MemorySnapshot&&) noexcept = default;
+
+MemorySnapshot& MemorySnapshot::operator=(MemorySnapshot&&) noexcept = default;
+
+void MemorySnapshot::Capture(u64 address, std::span<const u8> memory) {
+    ASSERT(memory.size() <= MaxChunkSize);
+    ASSERT(m_chunks.empty() || m_chunks.back().address + m_chunks.back().size <= address);
+
+    Chunk& chunk = m_chunks.emplace_back(address, memory.size(), Hash(memory));
+    ++m_statistics.num_chunks;
+    m_statistics.captured_size += memory.size();
+
+    const Chunk* const base_chunk = m_base ? m_base->FindChunk(address) : nullptr;
+    if (base_chunk && base_chunk->size == chunk.size && base_chunk->hash == chunk.hash) {
+        chunk.data = base_chunk->data;
+        ++m_statistics.num_shared_chunks;
+        if (!chunk.data) {
+            ++m_statistics.num_zero_chunks;
+        }
+        return;
+    }
+    if (IsZero(memory)) {
+        ++m_statistics.num_zero_chunks;
+        return;
+    }
+    auto data = std::make_shared<const std::vector<u8>>(
+        Common::Compression::CompressDataZSTDDefault(memory.data(), memory.size()));
+    m_statistics.compressed_size += data->size();
+    chunk.data = std::move(data);
+}
+
+bool MemorySnapshot::Restore(u64 address, std::span<u8> memory) const {
+    const Chunk* const chunk = FindChunk(address);
+    ASSERT(chunk && chunk->size == memory.size());
+    if (Hash(memory) == chunk->hash) {
+        return false;
+    }
+    if (!chunk->data) {
+        std::memset(memory.data(), 0, memory.size());
+        return true;
+    }
+    const std::vector<u8> data = Common::Compression::DecompressDataZSTD(*chunk->data);
+    ASSERT(data.size() == memory.size());
+    std::memcpy(memory.data(), data.data(), data.size());
+    return true;
+}
+
+const MemorySnapshot::Chunk* MemorySnapshot::FindChunk(u64 address) const {
+    const auto it = std::ranges::lower_bound(m_chunks, address, {}, &Chunk::address);
+    if (it == m_chunks.end() || it->address != address) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+} // namespace Core
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Compressed copy of guest memory, captured in chunks of up to MaxChunkSize bytes.
+ *
+ * A snapshot can be taken incrementally against a base: chunks whose contents did not change
+ * since the base share its compressed data, so only dirty chunks are compressed and stored again.
+ */
+class MemorySnapshot {
+public:
+    static constexpr std::size_t MaxChunkSize = 0x10000;
+
+    struct Statistics {
+        u64 num_chunks;        ///< Chunks captured
+        u64 num_zero_chunks;   ///< Chunks holding only zeroes, stored without data
+        u64 num_shared_chunks; ///< Chunks unchanged since the base, sharing its data
+        u64 captured_size;     ///< Bytes of memory captured
+        u64 compressed_size;   ///< Bytes of compressed data, excluding data shared with the base
+    };
+
+    /// Creates an empty snapshot, chunks matching the ones captured by base share their data.
+    /// The base only has to outlive the calls to Capture.
+    explicit MemorySnapshot(const MemorySnapshot* base = nullptr);
+    ~MemorySnapshot();
+
+    MemorySnapshot(MemorySnapshot&&) noexcept;
+    MemorySnapshot& operator=(MemorySnapshot&&) noexcept;
+
+    /// Captures a chunk of memory starting at address.
+    /// Chunks have to be captured in increasing address order and must not overlap.
+    void Capture(u64 address, std::span<const u8> memory);
+
+    /// Restores the chunk captured at address into memory, which holds its current contents.
+    /// Returns true if memory was modified, false if it already matched the snapshot.
+    bool Restore(u64 address, std::span<u8> memory) const;
+
+    [[nodiscard]] Statistics GetStatistics() const {
+        return m_statistics;
+    }
+
+private:
+    struct Chunk {
+        u64 address;
+        u64 size;
+        u64 hash;
+        std::shared_ptr<const std::vector<u8>> data; ///< Null if the chunk only holds zeroes
+    };
+
+    const Chunk* FindChunk(u64 address) const;
+
+    const MemorySnapshot* m_base{};
+    std::vector<Chunk> m_chunks;
+    Statistics m_statistics{};
+};
+
+} // namespace Core
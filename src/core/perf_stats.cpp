@@ -25,18 +25,24 @@ using std::chrono::microseconds;
 // booting that we shouldn't account for
 constexpr std::size_t IgnoreFrames = 5;
 
+// An hour of frames at 60 FPS
+constexpr std::size_t ReservedFrames = 216000;
+
 namespace Core {
 
-PerfStats::PerfStats(u64 title_id_) : title_id(title_id_) {}
+PerfStats::PerfStats(u64 title_id_) : title_id(title_id_) {
+    perf_history.reserve(ReservedFrames);
+}
 
 PerfStats::~PerfStats() {
-    if (!Settings::values.record_frame_times || title_id == 0) {
+    if (!Settings::values.record_frame_times || title_id == 0 ||
+        perf_history.size() <= IgnoreFrames) {
         return;
     }
 
     const std::time_t t = std::time(nullptr);
     std::ostringstream stream;
-    std::copy(perf_history.begin() + IgnoreFrames, perf_history.begin() + current_index,
+    std::copy(perf_history.begin() + IgnoreFrames, perf_history.end(),
               std::ostream_iterator<double>(stream, "\n"));
 
     const auto path = Common::FS::GetUzuyPath(Common::FS::UzuyPath::LogDir);
@@ -62,10 +68,7 @@ void PerfStats::EndSystemFrame() {
 
     auto frame_end = Clock::now();
     const auto frame_time = frame_end - frame_begin;
-    if (current_index < perf_history.size()) {
-        perf_history[current_index++] =
-            std::chrono::duration<double, std::milli>(frame_time).count();
-    }
+    perf_history.push_back(std::chrono::duration<double, std::milli>(frame_time).count());
     accumulated_frametime += frame_time;
     system_frames += 1;
 
@@ -75,18 +78,19 @@ void PerfStats::EndSystemFrame() {
 
 void PerfStats::EndGameFrame() {
     game_frames.fetch_add(1, std::memory_order_relaxed);
+    total_game_frames.fetch_add(1, std::memory_order_relaxed);
 }
 
 double PerfStats::GetMeanFrametime() const {
     std::scoped_lock lock{object_mutex};
 
-    if (current_index <= IgnoreFrames) {
+    if (perf_history.size() <= IgnoreFrames) {
         return 0;
     }
 
-    const double sum = std::accumulate(perf_history.begin() + IgnoreFrames,
-                                       perf_history.begin() + current_index, 0.0);
-    return sum / static_cast<double>(current_index - IgnoreFrames);
+    const double sum =
+        std::accumulate(perf_history.begin() + IgnoreFrames, perf_history.end(), 0.0);
+    return sum / static_cast<double>(perf_history.size() - IgnoreFrames);
 }
 
 PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us) {
@@ -118,6 +122,24 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
     return results;
 }
 
+std::size_t PerfStats::GetSystemFrameCount() const {
+    std::scoped_lock lock{object_mutex};
+    return perf_history.size();
+}
+
+std::vector<double> PerfStats::GetFrametimes(std::size_t first_frame) const {
+    std::scoped_lock lock{object_mutex};
+
+    if (first_frame >= perf_history.size()) {
+        return {};
+    }
+    return std::vector<double>(perf_history.begin() + first_frame, perf_history.end());
+}
+
+u64 PerfStats::GetTotalGameFrames() const {
+    return total_game_frames.load(std::memory_order_relaxed);
+}
+
 double PerfStats::GetLastFrameTimeScale() const {
     std::scoped_lock lock{object_mutex};
 
@@ -3,11 +3,11 @@
 
 #pragma once
 
-#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Core {
@@ -21,6 +21,8 @@ struct PerfStatsResults {
     double frametime;
     /// Ratio of walltime / emulated time elapsed
     double emulation_speed;
+    /// Host memory committed to the emulated physical memory, in bytes, 0 if unknown
+    u64 guest_memory_committed;
 };
 
 /**
@@ -51,16 +53,23 @@ public:
      */
     double GetLastFrameTimeScale() const;
 
+    /// Returns the number of system frames stored in the performance history
+    std::size_t GetSystemFrameCount() const;
+
+    /// Returns the frametimes in milliseconds of the stored system frames starting at first_frame
+    std::vector<double> GetFrametimes(std::size_t first_frame) const;
+
+    /// Returns the number of game frames since the game started, unaffected by resets
+    u64 GetTotalGameFrames() const;
+
 private:
     mutable std::mutex object_mutex;
 
     /// Title ID for the game that is running. 0 if there is no game running yet
     u64 title_id{0};
-    /// Current index for writing to the perf_history array
-    std::size_t current_index{0};
-    /// Stores an hour of historical frametime data useful for processing and tracking performance
-    /// regressions with code changes.
-    std::array<double, 216000> perf_history{};
+    /// Stores the historical frametime data of every system frame, useful for processing and
+    /// tracking performance regressions with code changes. An hour is reserved up front.
+    std::vector<double> perf_history;
 
     /// Point when the cumulative counters were reset
     Clock::time_point reset_point = Clock::now();
@@ -73,6 +82,8 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     std::atomic<u32> game_frames = 0;
+    /// Number of game frames since the game started
+    std::atomic<u64> total_game_frames = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hardware_properties.h"
+#include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/k_thread.h"
+#include "core/memory.h"
+#include "core/snapshot.h"
+
+namespace Core {
+
+namespace {
+
+using Kernel::Svc::MemoryState;
+
+/// Returns the regions of user memory of the process that can be read by the guest
+std::vector<Snapshot::Region> GetRegions(const Kernel::KProcess& process) {
+    std::vector<Snapshot::Region> regions;
+    const auto& page_table = process.GetPageTable();
+    const u64 start = GetInteger(page_table.GetAddressSpaceStart());
+    const u64 end = start + page_table.GetAddressSpaceSize();
+    for (u64 address = start; address < end;) {
+        Kernel::KMemoryInfo info;
+        Kernel::Svc::PageInfo page_info;
+        if (page_table.QueryInfo(&info, &page_info, address) != ResultSuccess) {
+            break;
+        }
+        const MemoryState state = info.GetSvcState();
+        const bool is_readable = True(info.GetPermission() & Kernel::KMemoryPermission::UserRead);
+        if (is_readable && state != MemoryState::Io && state != MemoryState::Static) {
+            regions.emplace_back(info.GetAddress(), info.GetSize(), state);
+        }
+        if (info.GetEndAddress() <= address) {
+            break;
+        }
+        address = info.GetEndAddress();
+    }
+    return regions;
+}
+
+std::vector<Kernel::KThread*> GetThreads(Kernel::KProcess& process) {
+    std::vector<Kernel::KThread*> threads;
+    for (auto& thread : process.GetThreadList()) {
+        threads.push_back(&thread);
+    }
+    std::ranges::sort(threads, {}, &Kernel::KThread::GetThreadId);
+    return threads;
+}
+
+/// Calls func with every chunk of the regions
+template <typename Func>
+void ForEachChunk(const std::vector<Snapshot::Region>& regions, Func&& func) {
+    for (const Snapshot::Region& region : regions) {
+        for (u64 offset = 0; offset < region.size; offset += MemorySnapshot::MaxChunkSize) {
+            func(region.address + offset,
+                 std::min<u64>(region.size - offset, MemorySnapshot::MaxChunkSize));
+        }
+    }
+}
+
+} // Anonymous namespace
+
+Snapshot::Snapshot(const Snapshot* base) : m_memory{base ? &base->m_memory : nullptr} {}
+
+std::unique_ptr<Snapshot> Snapshot::Create(System& system, const Snapshot* base) {
+    ASSERT(system.IsPaused());
+    Kernel::KProcess* const process = system.ApplicationProcess();
+    if (process == nullptr) {
+        LOG_ERROR(Core, "No application process to snapshot");
+        return nullptr;
+    }
+    const auto start_time = std::chrono::steady_clock::now();
+
+    std::unique_ptr<Snapshot> snapshot{new Snapshot(base)};
+    snapshot->m_program_id = process->GetProgramId();
+    snapshot->m_regions = GetRegions(*process);
+    for (Kernel::KThread* const thread : GetThreads(*process)) {
+        snapshot->m_threads.emplace_back(thread->GetThreadId(), thread->GetState(),
+                                         thread->GetContext());
+    }
+
+    Memory::Memory& memory = process->GetMemory();
+    std::array<u8, MemorySnapshot::MaxChunkSize> buffer;
+    ForEachChunk(snapshot->m_regions, [&](u64 address, u64 size) {
+        memory.ReadBlockUnsafe(address, buffer.data(), size);
+        snapshot->m_memory.Capture(address, std::span(buffer.data(), size));
+    });
+
+    const auto statistics = snapshot->m_memory.GetStatistics();
+    LOG_INFO(Core,
+             "Snapshot of {:016X} taken in {} ms: {} bytes in {} chunks, {} zero, {} shared, "
+             "{} bytes compressed",
+             snapshot->m_program_id,
+             std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - start_time)
+                 .count(),
+             statistics.captured_size, statistics.num_chunks, statistics.num_zero_chunks,
+             statistics.num_shared_chunks, statistics.compressed_size);
+    return snapshot;
+}
+
+bool Snapshot::Restore(System& system) const {
+    ASSERT(system.IsPaused());
+    Kernel::KProcess* const process = system.ApplicationProcess();
+    if (process == nullptr || process->GetProgramId() != m_program_id) {
+        LOG_ERROR(Core, "Snapshot was taken from another application");
+        return false;
+    }
+    if (GetRegions(*process) != m_regions) {
+        LOG_ERROR(Core, "Memory map of the application changed since the snapshot");
+        return false;
+    }
+    const auto threads = GetThreads(*process);
+    const bool threads_match = std::ranges::equal(
+        threads, m_threads, [](const Kernel::KThread* thread, const Thread& saved) {
+            return thread->GetThreadId() == saved.thread_id && thread->GetState() == saved.state;
+        });
+    if (!threads_match) {
+        LOG_ERROR(Core, "Threads of the application changed since the snapshot");
+        return false;
+    }
+
+    // Only write back the chunks that differ, writes flush the caches of the GPU
+    Memory::Memory& memory = process->GetMemory();
+    std::array<u8, MemorySnapshot::MaxChunkSize> buffer;
+    ForEachChunk(m_regions, [&](u64 address, u64 size) {
+        const std::span chunk(buffer.data(), size);
+        memory.ReadBlockUnsafe(address, chunk.data(), size);
+        if (m_memory.Restore(address, chunk)) {
+            memory.WriteBlock(address, chunk.data(), size);
+        }
+    });
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->GetContext() = m_threads[i].context;
+    }
+    for (std::size_t core = 0; core < Hardware::NUM_CPU_CORES; ++core) {
+        if (auto* const arm_interface = process->GetArmInterface(core)) {
+            arm_interface->ClearInstructionCache();
+        }
+    }
+    return true;
+}
+
+} // namespace Core
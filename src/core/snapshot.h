@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/svc_types.h"
+#include "core/memory_snapshot.h"
+
+namespace Kernel {
+enum class ThreadState : u16;
+}
+
+namespace Core {
+
+class System;
+
+/**
+ * Snapshot of the application process, to resume it from the point it was taken within the same
+ * emulation session.
+ *
+ * The user memory of the process and the contexts of its threads are saved. Kernel objects and HLE
+ * services are not: the snapshot records the memory map of the process and the state of its threads
+ * instead, and can only be restored while those still match.
+ */
+class Snapshot {
+public:
+    struct Region {
+        u64 address;
+        u64 size;
+        Kernel::Svc::MemoryState state;
+
+        bool operator==(const Region&) const = default;
+    };
+
+    struct Thread {
+        u64 thread_id;
+        Kernel::ThreadState state;
+        Kernel::Svc::ThreadContext context;
+    };
+
+    /// Captures the application process, emulation has to be paused.
+    /// Memory unchanged since base shares its data, base only has to outlive the call.
+    [[nodiscard]] static std::unique_ptr<Snapshot> Create(System& system,
+                                                          const Snapshot* base = nullptr);
+
+    /// Restores the application process, emulation has to be paused.
+    /// Returns false and leaves the process untouched if it no longer matches the snapshot.
+    bool Restore(System& system) const;
+
+    [[nodiscard]] const MemorySnapshot& GetMemory() const {
+        return m_memory;
+    }
+
+private:
+    explicit Snapshot(const Snapshot* base);
+
+    u64 m_program_id{};
+    std::vector<Region> m_regions;
+    std::vector<Thread> m_threads;
+    MemorySnapshot m_memory;
+};
+
+} // namespace Core
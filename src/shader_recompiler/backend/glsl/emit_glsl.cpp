@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <iterator>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -191,6 +192,17 @@ bool IsPreciseType(GlslVarType type) {
     }
 }
 
+size_t EstimateCodeSize(const IR::Program& program) {
+    // Most instructions emit a single short statement, reserve enough to avoid regrowing the
+    // code buffer while emitting
+    static constexpr size_t BYTES_PER_INST = 48;
+    size_t num_insts{};
+    for (const IR::Block* const block : program.blocks) {
+        num_insts += block->Instructions().size();
+    }
+    return num_insts * BYTES_PER_INST;
+}
+
 void DefineVariables(const EmitContext& ctx, std::string& header) {
     for (u32 i = 0; i < static_cast<u32>(GlslVarType::Void); ++i) {
         const auto type{static_cast<GlslVarType>(i)};
@@ -200,16 +212,16 @@ void DefineVariables(const EmitContext& ctx, std::string& header) {
         const auto precise{!has_precise_bug && IsPreciseType(type) ? "precise " : ""};
         // Temps/return types that are never used are stored at index 0
         if (tracker.uses_temp) {
-            header += fmt::format("{}{} t{}={}(0);", precise, type_name,
-                                  ctx.var_alloc.Representation(0, type), type_name);
+            fmt::format_to(std::back_inserter(header), "{}{} t{}={}(0);", precise, type_name,
+                           ctx.var_alloc.Representation(0, type), type_name);
         }
         for (u32 index = 0; index < tracker.num_used; ++index) {
-            header += fmt::format("{}{} {}={}(0);", precise, type_name,
-                                  ctx.var_alloc.Representation(index, type), type_name);
+            fmt::format_to(std::back_inserter(header), "{}{} {}={}(0);", precise, type_name,
+                           ctx.var_alloc.Representation(index, type), type_name);
         }
     }
     for (u32 i = 0; i < ctx.num_safety_loop_vars; ++i) {
-        header += fmt::format("int loop{}=0x2000;", i);
+        fmt::format_to(std::back_inserter(header), "int loop{}=0x2000;", i);
     }
 }
 } // Anonymous namespace
@@ -217,6 +229,7 @@ void DefineVariables(const EmitContext& ctx, std::string& header) {
 std::string EmitGLSL(const Profile& profile, const RuntimeInfo& runtime_info, IR::Program& program,
                      Bindings& bindings) {
     EmitContext ctx{program, bindings, profile, runtime_info};
+    ctx.code.reserve(EstimateCodeSize(program));
     Precolor(program);
     EmitCode(ctx, program);
     const std::string version{fmt::format("#version 460{}\n", GlslVersionSpecifier(ctx))};
@@ -244,9 +257,11 @@ std::string EmitGLSL(const Profile& profile, const RuntimeInfo& runtime_info, IR
         ctx.header += "bool shfl_in_bounds;";
         ctx.header += "uint shfl_result;";
     }
-    ctx.code.insert(0, ctx.header);
-    ctx.code += '}';
-    return ctx.code;
+    // Append the code to the header instead of prepending, avoids moving the whole body
+    ctx.header.reserve(ctx.header.size() + ctx.code.size() + 1);
+    ctx.header += ctx.code;
+    ctx.header += '}';
+    return std::move(ctx.header);
 }
 
 } // namespace Shader::Backend::GLSL
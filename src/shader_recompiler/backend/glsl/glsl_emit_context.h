@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -50,9 +51,11 @@ public:
         const auto var_def{var_alloc.AddDefine(inst, type)};
         if (var_def.empty()) {
             // skip assignment.
-            code += fmt::format(fmt::runtime(format_str + 3), std::forward<Args>(args)...);
+            fmt::format_to(std::back_inserter(code), fmt::runtime(format_str + 3),
+                           std::forward<Args>(args)...);
         } else {
-            code += fmt::format(fmt::runtime(format_str), var_def, std::forward<Args>(args)...);
+            fmt::format_to(std::back_inserter(code), fmt::runtime(format_str), var_def,
+                           std::forward<Args>(args)...);
         }
         // TODO: Remove this
         code += '\n';
@@ -130,7 +133,8 @@ public:
 
     template <typename... Args>
     void Add(const char* format_str, Args&&... args) {
-        code += fmt::format(fmt::runtime(format_str), std::forward<Args>(args)...);
+        fmt::format_to(std::back_inserter(code), fmt::runtime(format_str),
+                       std::forward<Args>(args)...);
         // TODO: Remove this
         code += '\n';
     }
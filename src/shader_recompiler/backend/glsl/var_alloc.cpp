@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2021 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <iterator>
 #include <string>
 #include <string_view>
 
@@ -49,94 +50,132 @@ std::string TypePrefix(GlslVarType type) {
     }
 }
 
-std::string FormatFloat(std::string_view value, IR::Type type) {
+void FormatFloat(fmt::memory_buffer& out, std::string_view value, IR::Type type) {
+    const auto it{std::back_inserter(out)};
     // TODO: Confirm FP64 nan/inf
     if (type == IR::Type::F32) {
         if (value == "nan") {
-            return "utof(0x7fc00000)";
+            fmt::format_to(it, "utof(0x7fc00000)");
+            return;
         }
         if (value == "inf") {
-            return "utof(0x7f800000)";
+            fmt::format_to(it, "utof(0x7f800000)");
+            return;
         }
         if (value == "-inf") {
-            return "utof(0xff800000)";
+            fmt::format_to(it, "utof(0xff800000)");
+            return;
         }
     }
     if (value.find_first_of('e') != std::string_view::npos) {
         // scientific notation
         const auto cast{type == IR::Type::F32 ? "float" : "double"};
-        return fmt::format("{}({})", cast, value);
+        fmt::format_to(it, "{}({})", cast, value);
+        return;
     }
     const bool needs_dot{value.find_first_of('.') == std::string_view::npos};
     const bool needs_suffix{!value.ends_with('f')};
     const auto suffix{type == IR::Type::F32 ? "f" : "lf"};
-    return fmt::format("{}{}{}", value, needs_dot ? "." : "", needs_suffix ? suffix : "");
+    fmt::format_to(it, "{}{}{}", value, needs_dot ? "." : "", needs_suffix ? suffix : "");
 }
 
-std::string MakeImm(const IR::Value& value) {
+template <typename T>
+void FormatFloat(fmt::memory_buffer& out, T value, IR::Type type) {
+    fmt::memory_buffer digits;
+    fmt::format_to(std::back_inserter(digits), "{}", value);
+    FormatFloat(out, std::string_view{digits.data(), digits.size()}, type);
+}
+
+void MakeImm(fmt::memory_buffer& out, const IR::Value& value) {
+    const auto it{std::back_inserter(out)};
     switch (value.Type()) {
     case IR::Type::U1:
-        return fmt::format("{}", value.U1() ? "true" : "false");
+        fmt::format_to(it, "{}", value.U1() ? "true" : "false");
+        break;
     case IR::Type::U32:
-        return fmt::format("{}u", value.U32());
+        fmt::format_to(it, "{}u", value.U32());
+        break;
     case IR::Type::F32:
-        return FormatFloat(fmt::format("{}", value.F32()), IR::Type::F32);
+        FormatFloat(out, value.F32(), IR::Type::F32);
+        break;
     case IR::Type::U64:
-        return fmt::format("{}ul", value.U64());
+        fmt::format_to(it, "{}ul", value.U64());
+        break;
     case IR::Type::F64:
-        return FormatFloat(fmt::format("{}", value.F64()), IR::Type::F64);
+        FormatFloat(out, value.F64(), IR::Type::F64);
+        break;
     case IR::Type::Void:
-        return "";
+        break;
     default:
         throw NotImplementedException("Immediate type {}", value.Type());
     }
 }
 } // Anonymous namespace
 
-std::string VarAlloc::Representation(u32 index, GlslVarType type) const {
-    const auto prefix{TypePrefix(type)};
-    return fmt::format("{}{}", prefix, index);
+const std::string& VarAlloc::Representation(u32 index, GlslVarType type) const {
+    auto& names{type == GlslVarType::Void ? void_names : GetUseTracker(type).names};
+    if (index >= names.size()) {
+        const auto prefix{TypePrefix(type)};
+        for (size_t i = names.size(); i <= index; ++i) {
+            names.push_back(fmt::format("{}{}", prefix, i));
+        }
+    }
+    return names[index];
 }
 
-std::string VarAlloc::Representation(Id id) const {
+const std::string& VarAlloc::Representation(Id id) const {
     return Representation(id.index, id.type);
 }
 
-std::string VarAlloc::Define(IR::Inst& inst, GlslVarType type) {
+std::string_view VarAlloc::Immediate(const IR::Value& value) {
+    fmt::memory_buffer buffer;
+    MakeImm(buffer, value);
+    const std::string_view imm{buffer.data(), buffer.size()};
+    if (const auto it{immediates.find(imm)}; it != immediates.end()) {
+        return *it;
+    }
+    return *immediates.emplace(imm).first;
+}
+
+std::string_view VarAlloc::Define(IR::Inst& inst, GlslVarType type) {
     if (inst.HasUses()) {
         inst.SetDefinition<Id>(Alloc(type));
         return Representation(inst.Definition<Id>());
     } else {
         Id id{};
         id.type.Assign(type);
-        GetUseTracker(type).uses_temp = true;
+        auto& use_tracker{GetUseTracker(type)};
+        use_tracker.uses_temp = true;
         inst.SetDefinition<Id>(id);
-        return 't' + Representation(inst.Definition<Id>());
+        if (use_tracker.temp_name.empty()) {
+            use_tracker.temp_name = 't' + Representation(id);
+        }
+        return use_tracker.temp_name;
     }
 }
 
-std::string VarAlloc::Define(IR::Inst& inst, IR::Type type) {
+std::string_view VarAlloc::Define(IR::Inst& inst, IR::Type type) {
     return Define(inst, RegType(type));
 }
 
-std::string VarAlloc::PhiDefine(IR::Inst& inst, IR::Type type) {
+std::string_view VarAlloc::PhiDefine(IR::Inst& inst, IR::Type type) {
     return AddDefine(inst, RegType(type));
 }
 
-std::string VarAlloc::AddDefine(IR::Inst& inst, GlslVarType type) {
+std::string_view VarAlloc::AddDefine(IR::Inst& inst, GlslVarType type) {
     if (inst.HasUses()) {
         inst.SetDefinition<Id>(Alloc(type));
         return Representation(inst.Definition<Id>());
     } else {
-        return "";
+        return {};
     }
 }
 
-std::string VarAlloc::Consume(const IR::Value& value) {
-    return value.IsImmediate() ? MakeImm(value) : ConsumeInst(*value.InstRecursive());
+std::string_view VarAlloc::Consume(const IR::Value& value) {
+    return value.IsImmediate() ? Immediate(value) : ConsumeInst(*value.InstRecursive());
 }
 
-std::string VarAlloc::ConsumeInst(IR::Inst& inst) {
+std::string_view VarAlloc::ConsumeInst(IR::Inst& inst) {
     inst.DestructiveRemoveUsage();
     if (!inst.HasUses()) {
         Free(inst.Definition<Id>());
@@ -4,7 +4,11 @@
 #pragma once
 
 #include <bitset>
+#include <deque>
+#include <functional>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "common/bit_field.h"
@@ -58,32 +62,39 @@ public:
         bool uses_temp{};
         size_t num_used{};
         std::vector<bool> var_use;
+        /// Interned variable names, indexed by variable index. A deque keeps the views handed
+        /// out valid while more names are added.
+        mutable std::deque<std::string> names;
+        /// Interned name of the temporary used for unused results
+        mutable std::string temp_name;
     };
 
-    /// Used for explicit usages of variables, may revert to temporaries
-    std::string Define(IR::Inst& inst, GlslVarType type);
-    std::string Define(IR::Inst& inst, IR::Type type);
+    /// Used for explicit usages of variables, may revert to temporaries.
+    /// Returned names are owned by the allocator and remain valid for its lifetime.
+    std::string_view Define(IR::Inst& inst, GlslVarType type);
+    std::string_view Define(IR::Inst& inst, IR::Type type);
 
     /// Used to assign variables used by the IR. May return a blank string if
     /// the instruction's result is unused in the IR.
-    std::string AddDefine(IR::Inst& inst, GlslVarType type);
-    std::string PhiDefine(IR::Inst& inst, IR::Type type);
+    std::string_view AddDefine(IR::Inst& inst, GlslVarType type);
+    std::string_view PhiDefine(IR::Inst& inst, IR::Type type);
 
-    std::string Consume(const IR::Value& value);
-    std::string ConsumeInst(IR::Inst& inst);
+    std::string_view Consume(const IR::Value& value);
+    std::string_view ConsumeInst(IR::Inst& inst);
 
     std::string GetGlslType(GlslVarType type) const;
     std::string GetGlslType(IR::Type type) const;
 
     const UseTracker& GetUseTracker(GlslVarType type) const;
-    std::string Representation(u32 index, GlslVarType type) const;
+    const std::string& Representation(u32 index, GlslVarType type) const;
 
 private:
     GlslVarType RegType(IR::Type type) const;
     Id Alloc(GlslVarType type);
     void Free(Id id);
     UseTracker& GetUseTracker(GlslVarType type);
-    std::string Representation(Id id) const;
+    const std::string& Representation(Id id) const;
+    std::string_view Immediate(const IR::Value& value);
 
     UseTracker var_bool{};
     UseTracker var_f16x2{};
@@ -99,6 +110,8 @@ private:
     UseTracker var_f64{};
     UseTracker var_precf32{};
     UseTracker var_precf64{};
+    mutable std::deque<std::string> void_names;
+    std::set<std::string, std::less<>> immediates;
 };
 
 } // namespace Shader::Backend::GLSL
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <map>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/btree_map.h"
+#include "common/common_types.h"
+
+namespace {
+
+template <typename Map, typename Reference>
+void RequireSameIterator(const Map& map, typename Map::const_iterator it,
+                         const Reference& reference, typename Reference::const_iterator ref_it) {
+    REQUIRE((it == map.end()) == (ref_it == reference.end()));
+    if (it != map.end()) {
+        REQUIRE(it->first == ref_it->first);
+        REQUIRE(it->second == ref_it->second);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BTreeMap[Basic]", "[common]") {
+    Common::BTreeMap<u64, u32> map;
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+    REQUIRE(map.lower_bound(0) == map.end());
+
+    REQUIRE(map.try_emplace(20, 2U).second);
+    REQUIRE(map.try_emplace(10, 1U).second);
+    REQUIRE(!map.try_emplace(10, 5U).second);
+    REQUIRE(!map.insert_or_assign(20, 3U).second);
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.find(20)->second == 3);
+    REQUIRE(map.lower_bound(11)->first == 20);
+    REQUIRE(map.upper_bound(10)->first == 20);
+    REQUIRE(map.upper_bound(20) == map.end());
+    REQUIRE(std::prev(map.end())->first == 20);
+
+    REQUIRE(map.erase(10) == 1);
+    REQUIRE(map.erase(10) == 0);
+    REQUIRE(map.size() == 1);
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+}
+
+TEST_CASE("BTreeMap[MatchesMap]", "[common]") {
+    // Enough elements for several levels, with ranges erased to exercise merges
+    std::mt19937_64 rng{0x42};
+    Common::BTreeMap<u64, u32> map;
+    std::map<u64, u32> reference;
+    for (u32 i = 0; i < 100000; ++i) {
+        const u64 key = rng() % 20000;
+        switch (rng() % 6) {
+        case 0:
+        case 1:
+        case 2:
+            REQUIRE(map.try_emplace(key, i).second == reference.try_emplace(key, i).second);
+            break;
+        case 3:
+            REQUIRE(map.erase(key) == reference.erase(key));
+            break;
+        case 4: {
+            const u64 last_key = key + rng() % 64;
+            const auto it = map.erase(map.lower_bound(key), map.upper_bound(last_key));
+            const auto ref_it =
+                reference.erase(reference.lower_bound(key), reference.upper_bound(last_key));
+            RequireSameIterator(map, it, reference, ref_it);
+            break;
+        }
+        case 5:
+            RequireSameIterator(map, map.lower_bound(key), reference, reference.lower_bound(key));
+            RequireSameIterator(map, map.upper_bound(key), reference, reference.upper_bound(key));
+            break;
+        }
+        REQUIRE(map.size() == reference.size());
+    }
+    auto it = map.begin();
+    for (const auto& [key, value] : reference) {
+        REQUIRE(it->first == key);
+        REQUIRE(it->second == value);
+        ++it;
+    }
+    REQUIRE(it == map.end());
+    for (auto ref_it = reference.rbegin(); ref_it != reference.rend(); ++ref_it) {
+        --it;
+        REQUIRE(it->first == ref_it->first);
+    }
+    REQUIRE(it == map.begin());
+}
+
+TEST_CASE("BTreeMap[Move]", "[common]") {
+    Common::BTreeMap<u64, u64> map;
+    for (u64 i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i * 2);
+    }
+    Common::BTreeMap<u64, u64> moved = std::move(map);
+    REQUIRE(moved.size() == 10000);
+    REQUIRE(moved.find(1234)->second == 2468);
+    REQUIRE(map.empty());
+    moved.erase(moved.begin(), moved.end());
+    REQUIRE(moved.empty());
+}
@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include "common/common_types.h"
@@ -310,4 +311,40 @@ TEST_CASE("Fibers::Rewind", "[common]") {
     REQUIRE(test_control.rewinded);
 }
 
+TEST_CASE("Fibers::Benchmark", "[.benchmark]") {
+    constexpr u32 num_switches = 100000;
+    constexpr u32 num_fibers = 10000;
+
+    std::shared_ptr<Fiber> thread_fiber = Fiber::ThreadToFiber();
+    std::shared_ptr<Fiber> work_fiber;
+    u32 counter = 0;
+    work_fiber = std::make_shared<Fiber>([&] {
+        while (true) {
+            ++counter;
+            Fiber::YieldTo(work_fiber, *thread_fiber);
+        }
+    });
+
+    BENCHMARK("Switch to a fiber and back") {
+        for (u32 i = 0; i < num_switches; ++i) {
+            Fiber::YieldTo(thread_fiber, *work_fiber);
+        }
+        return counter;
+    };
+
+    BENCHMARK("Create, run and destroy a fiber") {
+        for (u32 i = 0; i < num_fibers; ++i) {
+            std::shared_ptr<Fiber> fiber;
+            fiber = std::make_shared<Fiber>([&] {
+                ++counter;
+                Fiber::YieldTo(fiber, *thread_fiber);
+            });
+            Fiber::YieldTo(thread_fiber, *fiber);
+        }
+        return counter;
+    };
+
+    thread_fiber->Exit();
+}
+
 } // namespace Common
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/flat_hash_map.h"
+
+TEST_CASE("FlatHashMap[Basic]", "[common]") {
+    Common::FlatHashMap<u64, std::string> map;
+    REQUIRE(map.empty());
+    REQUIRE(map.find(1) == map.end());
+    REQUIRE(map.begin() == map.end());
+
+    map[1] = "one";
+    REQUIRE(map.try_emplace(2, "two").second);
+    REQUIRE(!map.try_emplace(2, "other").second);
+    REQUIRE(map.emplace(3, "three").second);
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.at(2) == "two");
+    REQUIRE(map.contains(3));
+    REQUIRE_THROWS_AS(map.at(4), std::out_of_range);
+
+    REQUIRE(map.erase(2) == 1);
+    REQUIRE(map.erase(2) == 0);
+    REQUIRE(map.size() == 2);
+    REQUIRE(!map.contains(2));
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+}
+
+TEST_CASE("FlatHashMap[MatchesUnorderedMap]", "[common]") {
+    // Page numbers and wide random keys, with erases to exercise tombstones
+    std::mt19937_64 rng{1234};
+    Common::FlatHashMap<u64, u64> map;
+    std::unordered_map<u64, u64> reference;
+    for (u32 i = 0; i < 200000; ++i) {
+        const u64 key = (rng() % 2 == 0) ? rng() % 4096 : rng();
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            map[key] = i;
+            reference[key] = i;
+            break;
+        case 2:
+            REQUIRE(map.erase(key) == reference.erase(key));
+            break;
+        case 3: {
+            const auto it = map.find(key);
+            const auto ref_it = reference.find(key);
+            REQUIRE((it == map.end()) == (ref_it == reference.end()));
+            if (it != map.end()) {
+                REQUIRE(it->second == ref_it->second);
+            }
+            break;
+        }
+        }
+        REQUIRE(map.size() == reference.size());
+    }
+    size_t count = 0;
+    for (const auto& [key, value] : map) {
+        REQUIRE(reference.at(key) == value);
+        ++count;
+    }
+    REQUIRE(count == reference.size());
+}
+
+TEST_CASE("FlatHashMap[EraseWhileIterating]", "[common]") {
+    Common::FlatHashMap<u32, u32> map;
+    for (u32 i = 0; i < 1000; ++i) {
+        map[i] = i;
+    }
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->second % 3 == 0) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    REQUIRE(map.size() == 666);
+    for (u32 i = 0; i < 1000; ++i) {
+        REQUIRE(map.contains(i) == (i % 3 != 0));
+    }
+}
+
+TEST_CASE("FlatHashMap[MoveOnlyAndCopy]", "[common]") {
+    Common::FlatHashMap<u32, std::unique_ptr<u32>> owners;
+    for (u32 i = 0; i < 100; ++i) {
+        owners.emplace(i, std::make_unique<u32>(i));
+    }
+    const auto moved = std::move(owners);
+    REQUIRE(moved.size() == 100);
+    REQUIRE(*moved.at(42) == 42);
+
+    Common::FlatHashMap<u32, std::shared_ptr<u32>> shared;
+    for (u32 i = 0; i < 100; ++i) {
+        shared.emplace(i, std::make_shared<u32>(i));
+    }
+    const auto copy = shared;
+    REQUIRE(copy.size() == 100);
+    REQUIRE(copy.at(7) == shared.at(7));
+    REQUIRE(copy.at(7).use_count() == 2);
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <unordered_set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+
+namespace {
+std::vector<u8> MakeData(size_t size) {
+    std::vector<u8> data(size);
+    u32 state = 0x12345678;
+    for (u8& byte : data) {
+        state = state * 1664525 + 1013904223;
+        byte = static_cast<u8>(state >> 24);
+    }
+    return data;
+}
+} // Anonymous namespace
+
+TEST_CASE("HashFast64[MatchesScalar]", "[common]") {
+    const std::vector<u8> data = MakeData(5000);
+    // Unaligned and odd sizes cover the partial blocks and the overlapping final stripe
+    for (size_t size = 0; size < 4096; size += size < 600 ? 1 : 61) {
+        REQUIRE(Common::HashFast64(data.data() + 3, size, size) ==
+                Common::Detail::HashFast64Scalar(data.data() + 3, size, size));
+    }
+}
+
+TEST_CASE("HashFast64[Deterministic]", "[common]") {
+    const std::vector<u8> data = MakeData(2048);
+    const std::vector<u8> copy = data;
+    for (const size_t size : {0, 1, 3, 8, 16, 17, 32, 100, 256, 257, 1024, 2048}) {
+        REQUIRE(Common::HashFast64(data.data(), size) == Common::HashFast64(copy.data(), size));
+        REQUIRE(Common::HashFast64(data.data(), size, 1) != Common::HashFast64(data.data(), size));
+    }
+}
+
+TEST_CASE("HashFast64[EveryByteMatters]", "[common]") {
+    for (const size_t size : {1, 4, 7, 12, 16, 31, 64, 129, 256, 300, 1536, 1600, 3100}) {
+        std::vector<u8> data = MakeData(size);
+        std::unordered_set<u64> hashes{Common::HashFast64(data.data(), size)};
+        for (size_t i = 0; i < size; ++i) {
+            data[i] ^= 1;
+            REQUIRE(hashes.insert(Common::HashFast64(data.data(), size)).second);
+            data[i] ^= 1;
+        }
+    }
+}
+
+TEST_CASE("HashFast64[Sizes]", "[common]") {
+    // Zero filled inputs of different sizes must not collide
+    const std::vector<u8> zeros(4096);
+    std::unordered_set<u64> hashes;
+    for (size_t size = 0; size <= zeros.size(); ++size) {
+        REQUIRE(hashes.insert(Common::HashFast64(zeros.data(), size)).second);
+    }
+}
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2021 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cstring>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include "common/host_memory.h"
@@ -184,3 +186,43 @@ TEST_CASE("HostMemory: Partial sparse middle unmap and check bindings", "[common
     REQUIRE(ptr[0x0000] == 19);
     REQUIRE(ptr[0x3fff] == 12);
 }
+
+TEST_CASE("HostMemory: Clear backing region", "[common]") {
+    HostMemory mem(BACKING_SIZE, VIRTUAL_SIZE);
+    u8* const backing = mem.BackingBasePointer();
+    std::memset(backing, 0x55, 1_MiB);
+
+    // Small and large clears, with and without a pattern
+    mem.ClearBackingRegion(0, 0x1000, 0);
+    mem.ClearBackingRegion(0x1000, 0x1000, 0xAA);
+    mem.ClearBackingRegion(0x10000, 512_KiB, 0);
+    REQUIRE(backing[0] == 0);
+    REQUIRE(backing[0xfff] == 0);
+    REQUIRE(backing[0x1000] == 0xAA);
+    REQUIRE(backing[0x2000] == 0x55);
+    REQUIRE(backing[0x10000] == 0);
+    REQUIRE(backing[0x10000 + 512_KiB - 1] == 0);
+    REQUIRE(backing[0x10000 + 512_KiB] == 0x55);
+}
+
+TEST_CASE("HostMemory: Discard backing region", "[common]") {
+    HostMemory mem(BACKING_SIZE, VIRTUAL_SIZE);
+    mem.Map(0x5000, 0x100000, 1_MiB, PERMS, HEAP);
+
+    volatile u8* const data = mem.VirtualBasePointer() + 0x5000;
+    std::memset(mem.BackingBasePointer() + 0x100000, 0x55, 1_MiB);
+    const auto committed = mem.GetCommittedSize();
+    if (committed) {
+        REQUIRE(*committed >= 1_MiB);
+    }
+
+    // Discarded pages are no longer committed, and read as zero through every mapping
+    if (!mem.DiscardBackingRegion(0x100000, 1_MiB)) {
+        return;
+    }
+    if (committed) {
+        REQUIRE(*mem.GetCommittedSize() + 1_MiB <= *committed);
+    }
+    REQUIRE(data[0] == 0);
+    REQUIRE(data[1_MiB - 1] == 0);
+}
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/large_page_table.h"
+
+namespace {
+
+/// 64 KiB large pages of 4 KiB pages, as used by the device memory manager
+using PageTable = Common::LargePageTable<u64, 0x1000, 4>;
+
+constexpr size_t NUM_PAGES = 1ULL << 22;
+constexpr size_t LARGE = PageTable::PAGES_PER_LARGE_PAGE;
+
+} // Anonymous namespace
+
+TEST_CASE("LargePageTable[SetAndGet]", "[common]") {
+    PageTable table(NUM_PAGES);
+    REQUIRE(table.Get(0) == 0);
+
+    table.Set(5, 0x1234000);
+    REQUIRE(table.Get(5) == 0x1234000);
+    REQUIRE(!table.IsLarge(5));
+
+    table.SetLarge(LARGE * 2, 0x80000000);
+    for (size_t i = 0; i < LARGE; ++i) {
+        REQUIRE(table.Get(LARGE * 2 + i) == 0x80000000 + i * 0x1000);
+        REQUIRE(table.IsLarge(LARGE * 2 + i));
+    }
+    REQUIRE(table.Get(LARGE * 3) == 0);
+
+    table.ClearLarge(LARGE * 2);
+    REQUIRE(table.Get(LARGE * 2) == 0);
+    REQUIRE(!table.IsLarge(LARGE * 2));
+}
+
+TEST_CASE("LargePageTable[SplitOnWrite]", "[common]") {
+    PageTable table(NUM_PAGES);
+    table.SetLarge(LARGE, 0x40000000);
+    table.Set(LARGE + 3, 0);
+    REQUIRE(!table.IsLarge(LARGE));
+    for (size_t i = 0; i < LARGE; ++i) {
+        REQUIRE(table.Get(LARGE + i) == (i == 3 ? 0 : 0x40000000 + i * 0x1000));
+    }
+
+    // Mapping a large page over per page entries replaces them
+    table.SetLarge(LARGE, 0x50000000);
+    REQUIRE(table.Get(LARGE + 3) == 0x50003000);
+    table.ClearLarge(LARGE);
+    for (size_t i = 0; i < LARGE; ++i) {
+        REQUIRE(table.Get(LARGE + i) == 0);
+    }
+}
+
+TEST_CASE("LargePageTable[Benchmark]", "[.benchmark]") {
+    // Map, translate and unmap 4 GiB of contiguous memory
+    constexpr size_t num_pages = 0x100000;
+    PageTable table(NUM_PAGES);
+
+    BENCHMARK("Map and unmap per page") {
+        for (size_t page = 0; page < num_pages; ++page) {
+            table.Set(page, 0x100000000 + page * 0x1000);
+        }
+        for (size_t page = 0; page < num_pages; ++page) {
+            table.Set(page, 0);
+        }
+        return table.Get(0);
+    };
+
+    BENCHMARK("Map and unmap large pages") {
+        for (size_t page = 0; page < num_pages; page += LARGE) {
+            table.SetLarge(page, 0x100000000 + page * 0x1000);
+        }
+        for (size_t page = 0; page < num_pages; page += LARGE) {
+            table.ClearLarge(page);
+        }
+        return table.Get(0);
+    };
+
+    for (size_t page = 0; page < num_pages; ++page) {
+        table.Set(page, 0x100000000 + page * 0x1000);
+    }
+    BENCHMARK("Translate per page") {
+        // Visit the pages in a scattered order, like device accesses
+        u64 sum = 0;
+        for (size_t i = 0; i < num_pages; ++i) {
+            sum += table.Get((i * 0x9E3779B1) & (num_pages - 1));
+        }
+        return sum;
+    };
+
+    for (size_t page = 0; page < num_pages; page += LARGE) {
+        table.SetLarge(page, 0x100000000 + page * 0x1000);
+    }
+    BENCHMARK("Translate large pages") {
+        // Visit the pages in a scattered order, like device accesses
+        u64 sum = 0;
+        for (size_t i = 0; i < num_pages; ++i) {
+            sum += table.Get((i * 0x9E3779B1) & (num_pages - 1));
+        }
+        return sum;
+    };
+}
@@ -1,11 +1,17 @@
 // SPDX-FileCopyrightText: Copyright 2022 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <random>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include "common/range_map.h"
+#include "common/range_sets.inc"
 
 enum class MappedEnum : u32 {
     Invalid = 0,
@@ -68,3 +74,265 @@ TEST_CASE("Range Map: Setup", "[video_core]") {
     REQUIRE(my_map.GetValueAt(5999) == MappedEnum::Valid_3);
     REQUIRE(my_map.GetValueAt(6000) == MappedEnum::Invalid);
 }
+
+namespace {
+
+using Ranges = std::vector<std::pair<u64, u64>>;
+using Segments = std::vector<std::tuple<u64, u64, s32>>;
+
+Ranges Collect(const Common::RangeSet<u64>& set) {
+    Ranges result;
+    set.ForEach([&](u64 start, u64 end) { result.emplace_back(start, end); });
+    return result;
+}
+
+Segments Collect(const Common::OverlapRangeSet<u64>& set) {
+    Segments result;
+    set.ForEach([&](u64 start, u64 end, s32 count) { result.emplace_back(start, end, count); });
+    return result;
+}
+
+/// Builds the ranges covered by a byte map, used as a reference for the range sets
+Ranges FromBytes(const std::vector<bool>& bytes) {
+    Ranges result;
+    for (u64 address = 0; address < bytes.size(); ++address) {
+        if (!bytes[address]) {
+            continue;
+        }
+        if (!result.empty() && result.back().second == address) {
+            ++result.back().second;
+        } else {
+            result.emplace_back(address, address + 1);
+        }
+    }
+    return result;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Range Set: Join and split", "[common]") {
+    Common::RangeSet<u64> set;
+    set.Add(0x1000, 0x1000);
+    set.Add(0x3000, 0x1000);
+    REQUIRE(Collect(set) == Ranges{{0x1000, 0x2000}, {0x3000, 0x4000}});
+    set.Add(0x2000, 0x1000);
+    REQUIRE(Collect(set) == Ranges{{0x1000, 0x4000}});
+    set.Subtract(0x1800, 0x100);
+    REQUIRE(Collect(set) == Ranges{{0x1000, 0x1800}, {0x1900, 0x4000}});
+
+    Ranges in_range;
+    set.ForEachInRange(0x1700, 0x300,
+                       [&](u64 start, u64 end) { in_range.emplace_back(start, end); });
+    REQUIRE(in_range == Ranges{{0x1700, 0x1800}, {0x1900, 0x1A00}});
+
+    set.Subtract(0, 0x10000);
+    REQUIRE(set.Empty());
+}
+
+TEST_CASE("Range Set: Random operations", "[common]") {
+    constexpr u64 space = 0x4000;
+    std::mt19937_64 rng{0x1234};
+    Common::RangeSet<u64> set;
+    std::vector<bool> bytes(space);
+    for (int i = 0; i < 4000; ++i) {
+        const u64 base = rng() % space;
+        const u64 size = std::min<u64>(rng() % 0x200 + 1, space - base);
+        const bool add = rng() % 2 == 0;
+        if (add) {
+            set.Add(base, size);
+        } else {
+            set.Subtract(base, size);
+        }
+        for (u64 address = base; address < base + size; ++address) {
+            bytes[address] = add;
+        }
+        REQUIRE(Collect(set) == FromBytes(bytes));
+    }
+}
+
+TEST_CASE("Range Set: Bulk operations", "[common]") {
+    constexpr u64 space = 0x10000;
+    std::mt19937_64 rng{0x5678};
+    for (const int other_ranges : {4, 400}) {
+        Common::RangeSet<u64> set;
+        Common::RangeSet<u64> other;
+        std::vector<bool> bytes(space);
+        std::vector<bool> other_bytes(space);
+        const auto fill = [&](Common::RangeSet<u64>& target, std::vector<bool>& target_bytes,
+                              int count) {
+            for (int i = 0; i < count; ++i) {
+                const u64 base = rng() % (space - 0x100);
+                const u64 size = rng() % 0x100 + 1;
+                target.Add(base, size);
+                for (u64 address = base; address < base + size; ++address) {
+                    target_bytes[address] = true;
+                }
+            }
+        };
+        fill(set, bytes, 400);
+        fill(other, other_bytes, other_ranges);
+
+        Common::RangeSet<u64> joined;
+        joined.Add(set);
+        joined.Add(other);
+        std::vector<bool> joined_bytes(space);
+        for (u64 address = 0; address < space; ++address) {
+            joined_bytes[address] = bytes[address] || other_bytes[address];
+        }
+        REQUIRE(Collect(joined) == FromBytes(joined_bytes));
+
+        set.Subtract(other);
+        for (u64 address = 0; address < space; ++address) {
+            bytes[address] = bytes[address] && !other_bytes[address];
+        }
+        REQUIRE(Collect(set) == FromBytes(bytes));
+    }
+}
+
+TEST_CASE("Overlap Range Set: Counting", "[common]") {
+    Common::OverlapRangeSet<u64> set;
+    set.Add(0x1000, 0x2000);
+    set.Add(0x2000, 0x2000);
+    REQUIRE(Collect(set) ==
+            Segments{{0x1000, 0x2000, 1}, {0x2000, 0x3000, 2}, {0x3000, 0x4000, 1}});
+
+    Ranges deleted;
+    set.Subtract(0x1800, 0x1000, [&](u64 start, u64 end) { deleted.emplace_back(start, end); });
+    REQUIRE(deleted == Ranges{{0x1800, 0x2000}});
+    REQUIRE(Collect(set) == Segments{{0x1000, 0x1800, 1},
+                                     {0x2000, 0x2800, 1},
+                                     {0x2800, 0x3000, 2},
+                                     {0x3000, 0x4000, 1}});
+
+    Segments in_range;
+    set.ForEachInRange(0x2400, 0x800, [&](u64 start, u64 end, s32 count) {
+        in_range.emplace_back(start, end, count);
+    });
+    REQUIRE(in_range == Segments{{0x2400, 0x2800, 1}, {0x2800, 0x2C00, 2}});
+
+    set.DeleteAll(0, 0x10000);
+    REQUIRE(set.Empty());
+}
+
+TEST_CASE("Range Set: Benchmark", "[.benchmark]") {
+    constexpr u64 page_size = 0x1000;
+    std::mt19937_64 rng{0x9ABC};
+
+    // Guest writes marking mostly adjacent pages as GPU modified, as done by the buffer cache
+    std::vector<std::pair<u64, u64>> writes(0x10000);
+    u64 address = 0;
+    for (auto& [base, size] : writes) {
+        address += (rng() % 4 == 0 ? rng() % 16 : 0) * page_size;
+        base = address;
+        size = (rng() % 4 + 1) * page_size;
+        address += size;
+    }
+    std::vector<std::pair<u64, u64>> scattered(0x10000);
+    for (auto& [base, size] : scattered) {
+        base = rng() % (address / 64) * 64;
+        size = (rng() % 1024 + 1) * 64;
+    }
+
+    BENCHMARK("Add sequential") {
+        Common::RangeSet<u64> set;
+        for (const auto& [base, size] : writes) {
+            set.Add(base, size);
+        }
+        return set.Empty();
+    };
+
+    BENCHMARK("Add and subtract scattered") {
+        Common::RangeSet<u64> set;
+        for (size_t i = 0; i < scattered.size(); ++i) {
+            const auto& [base, size] = scattered[i];
+            if (i % 3 == 2) {
+                set.Subtract(base, size);
+            } else {
+                set.Add(base, size);
+            }
+        }
+        return set.Empty();
+    };
+
+    Common::RangeSet<u64> modified;
+    for (size_t i = 0; i < writes.size(); i += 2) {
+        modified.Add(writes[i].first, writes[i].second);
+    }
+    BENCHMARK("Query in range") {
+        u64 found = 0;
+        for (const auto& [base, size] : scattered) {
+            modified.ForEachInRange(base, size, [&](u64 start, u64 end) { found += end - start; });
+        }
+        return found;
+    };
+
+    Common::RangeSet<u64> committed;
+    for (size_t i = 0; i < writes.size(); i += 3) {
+        committed.Add(writes[i].first, writes[i].second);
+    }
+    BENCHMARK("Subtract set") {
+        Common::RangeSet<u64> set;
+        set.Add(modified);
+        set.Subtract(committed);
+        return set.Empty();
+    };
+
+    BENCHMARK("Overlap add and subtract") {
+        // Downloads are registered in order and retired with a delay, as done for async downloads
+        Common::OverlapRangeSet<u64> set;
+        u64 deleted = 0;
+        for (size_t i = 0; i < scattered.size(); ++i) {
+            set.Add(scattered[i].first, scattered[i].second);
+            if (i >= 64) {
+                const auto& [base, size] = scattered[i - 64];
+                set.Subtract(base, size, [&](u64 start, u64 end) { deleted += end - start; });
+            }
+        }
+        return deleted;
+    };
+}
+
+TEST_CASE("Range Map: Benchmark", "[.benchmark]") {
+    constexpr u64 page_size = 0x10000;
+    std::mt19937_64 rng{0xDEF0};
+
+    // GPU mappings of different kinds created back to back and partially unmapped
+    std::vector<std::tuple<u64, u64, MappedEnum>> mappings(0x4000);
+    u64 address = 0;
+    for (auto& [base, end, kind] : mappings) {
+        base = address;
+        end = base + (rng() % 32 + 1) * page_size;
+        kind = static_cast<MappedEnum>(rng() % 3 + 1);
+        address = end;
+    }
+    std::vector<u64> lookups(0x10000);
+    for (u64& lookup : lookups) {
+        lookup = rng() % address;
+    }
+
+    BENCHMARK("Map and unmap") {
+        Common::RangeMap<u64, MappedEnum> map(MappedEnum::Invalid);
+        for (size_t i = 0; i < mappings.size(); ++i) {
+            const auto& [base, end, kind] = mappings[i];
+            map.Map(base, end, kind);
+            if (i % 4 == 3) {
+                const auto& [old_base, old_end, old_kind] = mappings[i / 2];
+                map.Unmap(old_base, old_end);
+            }
+        }
+        return map.GetValueAt(0);
+    };
+
+    Common::RangeMap<u64, MappedEnum> map(MappedEnum::Invalid);
+    for (const auto& [base, end, kind] : mappings) {
+        map.Map(base, end, kind);
+    }
+    BENCHMARK("Lookup") {
+        size_t total = 0;
+        for (const u64 lookup : lookups) {
+            total += map.GetContinuousSizeFrom(lookup);
+            total += static_cast<size_t>(map.GetValueAt(lookup));
+        }
+        return total;
+    };
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/slot_vector.h"
+
+TEST_CASE("SlotVector[InsertErase]", "[common]") {
+    Common::SlotVector<std::unique_ptr<u32>> slots;
+    const Common::SlotId first = slots.insert(std::make_unique<u32>(0));
+    REQUIRE(first == Common::SlotId{0});
+
+    std::vector<Common::SlotId> ids{first};
+    for (u32 i = 1; i < 1000; ++i) {
+        ids.push_back(slots.insert(std::make_unique<u32>(i)));
+    }
+    REQUIRE(slots.size() == 1000);
+    for (u32 i = 0; i < 1000; ++i) {
+        REQUIRE(*slots[ids[i]] == i);
+    }
+
+    // Reused slots get a new generation
+    const Common::SlotId erased = ids[500];
+    slots.erase(erased);
+    const Common::SlotId reused = slots.insert(std::make_unique<u32>(5000));
+    REQUIRE(reused.Index() == erased.Index());
+    REQUIRE(reused.Generation() != erased.Generation());
+    REQUIRE(reused != erased);
+    REQUIRE(*slots[reused] == 5000);
+    REQUIRE(slots.size() == 1000);
+}
+
+TEST_CASE("SlotVector[Iteration]", "[common]") {
+    Common::SlotVector<u32> slots;
+    std::vector<Common::SlotId> ids;
+    for (u32 i = 0; i < 300; ++i) {
+        ids.push_back(slots.insert(i));
+    }
+    for (u32 i = 0; i < 300; i += 3) {
+        slots.erase(ids[i]);
+    }
+    std::set<u32> values;
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        const auto [id, value] = *it;
+        REQUIRE(slots[id] == *value);
+        values.insert(*value);
+    }
+    REQUIRE(values.size() == 200);
+    REQUIRE(!values.contains(0));
+    REQUIRE(values.contains(1));
+}
+
+TEST_CASE("SlotVector[StableAddresses]", "[common]") {
+    Common::SlotVector<u64> slots;
+    const Common::SlotId id = slots.insert(u64{42});
+    const u64* const address = &slots[id];
+
+    // Objects never move, so another thread can keep reading while slots are inserted
+    // Catch2 assertions are not thread safe, so the reader only records failures.
+    std::atomic_bool done{};
+    std::atomic<u64> num_failures{};
+    std::thread reader{[&] {
+        while (!done) {
+            if (slots[id] != 42) {
+                ++num_failures;
+            }
+        }
+    }};
+    for (u32 i = 0; i < 100000; ++i) {
+        (void)slots.insert(u64{i});
+    }
+    done = true;
+    reader.join();
+    REQUIRE(num_failures == 0);
+    REQUIRE(&slots[id] == address);
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+
+TEST_CASE("ThreadWorker[RunsAllWork]", "[common]") {
+    Common::ThreadWorker workers{4, "TestWorker"};
+    std::atomic<u32> count{};
+    for (u32 i = 0; i < 10000; ++i) {
+        workers.QueueWork([&count] { ++count; });
+    }
+    workers.WaitForRequests();
+    REQUIRE(count == 10000);
+
+    // Reuse after waiting
+    for (u32 i = 0; i < 100; ++i) {
+        workers.QueueWork([&count] { ++count; },
+                          i % 2 ? Common::WorkPriority::High : Common::WorkPriority::Background);
+    }
+    workers.WaitForRequests();
+    REQUIRE(count == 10100);
+}
+
+TEST_CASE("ThreadWorker[NestedWork]", "[common]") {
+    Common::ThreadWorker workers{3, "TestWorker"};
+    std::atomic<u32> count{};
+    for (u32 i = 0; i < 64; ++i) {
+        workers.QueueWork([&workers, &count] {
+            for (u32 j = 0; j < 16; ++j) {
+                workers.QueueWork([&count] { ++count; });
+            }
+        });
+    }
+    workers.WaitForRequests();
+    REQUIRE(count == 64 * 16);
+}
+
+TEST_CASE("ThreadWorker[SingleWorkerOrder]", "[common]") {
+    Common::ThreadWorker worker{1, "TestWorker"};
+    std::vector<u32> order;
+    for (u32 i = 0; i < 1000; ++i) {
+        worker.QueueWork([&order, i] { order.push_back(i); });
+    }
+    worker.WaitForRequests();
+    REQUIRE(order.size() == 1000);
+    for (u32 i = 0; i < 1000; ++i) {
+        REQUIRE(order[i] == i);
+    }
+}
+
+TEST_CASE("ThreadWorker[Priority]", "[common]") {
+    Common::ThreadWorker worker{1, "TestWorker"};
+    std::atomic_bool started{};
+    std::atomic_bool release{};
+    std::vector<u32> order;
+
+    // Hold the only worker so everything below is queued before it runs
+    worker.QueueWork([&] {
+        started = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    for (u32 i = 0; i < 4; ++i) {
+        worker.QueueWork([&order, i] { order.push_back(i); }, Common::WorkPriority::Background);
+    }
+    for (u32 i = 4; i < 8; ++i) {
+        worker.QueueWork([&order, i] { order.push_back(i); });
+    }
+    release = true;
+    worker.WaitForRequests();
+    REQUIRE(order == std::vector<u32>{4, 5, 6, 7, 0, 1, 2, 3});
+}
+
+TEST_CASE("ThreadWorker[State]", "[common]") {
+    struct State {
+        u32 count{};
+    };
+    std::mutex mutex;
+    std::vector<State*> states;
+    Common::StatefulThreadWorker<State> workers{2, "TestWorker", [] { return State{}; }};
+    std::atomic<u32> total{};
+    for (u32 i = 0; i < 1000; ++i) {
+        workers.QueueWork([&](State* state) {
+            ++state->count;
+            ++total;
+            std::scoped_lock lock{mutex};
+            if (std::find(states.begin(), states.end(), state) == states.end()) {
+                states.push_back(state);
+            }
+        });
+    }
+    workers.WaitForRequests();
+    REQUIRE(total == 1000);
+    u32 sum = 0;
+    for (const State* state : states) {
+        sum += state->count;
+    }
+    REQUIRE(states.size() <= 2);
+    REQUIRE(sum == 1000);
+}
@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/trace.h"
+
+namespace {
+
+/// Spans kept per thread and spans at the write position dropped from a full ring, see trace.cpp
+constexpr u64 SPANS_PER_THREAD = 1 << 16;
+constexpr u64 UNSTABLE_SPANS = 64;
+
+struct TraceSpan {
+    std::string name;
+    u64 ts;
+};
+
+/// Spans of a capture by the name of the thread that recorded them
+using Capture = std::map<std::string, std::vector<TraceSpan>>;
+
+std::string Field(const std::string& line, std::string_view key) {
+    const std::string prefix = fmt::format("\"{}\":", key);
+    size_t begin = line.find(prefix);
+    REQUIRE(begin != std::string::npos);
+    begin += prefix.size();
+    if (line[begin] == '"') {
+        return line.substr(begin + 1, line.find('"', begin + 1) - begin - 1);
+    }
+    return line.substr(begin, line.find_first_of(",.}", begin) - begin);
+}
+
+Capture StopAndRead() {
+    const auto path = std::filesystem::temp_directory_path() / "uzuy_trace_test.json";
+    REQUIRE(Common::Trace::StopAndWrite(path));
+    REQUIRE(!Common::Trace::IsRecording());
+
+    std::ifstream file{path};
+    std::map<std::string, std::string> thread_names;
+    std::vector<std::string> span_lines;
+    for (std::string line; std::getline(file, line);) {
+        if (line.find(R"("ph":"M")") != std::string::npos) {
+            // The thread name is the name in the arguments of the metadata event
+            thread_names[Field(line, "tid")] = Field(line.substr(line.find("\"args\"")), "name");
+        } else if (line.find(R"("ph":"X")") != std::string::npos) {
+            span_lines.push_back(line);
+        }
+    }
+    file.close();
+    std::filesystem::remove(path);
+
+    Capture capture;
+    for (const std::string& line : span_lines) {
+        const auto it = thread_names.find(Field(line, "tid"));
+        REQUIRE(it != thread_names.end());
+        capture[it->second].push_back({Field(line, "name"), std::stoull(Field(line, "ts"))});
+    }
+    return capture;
+}
+
+/// Records spans one microsecond apart, starting at first_us
+void RecordSpans(const char* name, u64 first_us, u64 count) {
+    for (u64 i = 0; i < count; ++i) {
+        const u64 begin = (first_us + i) * 1000;
+        Common::Trace::RecordSpan(name, begin, begin + 500);
+    }
+}
+
+/// Thread that records spans when asked to and exits when told to
+class Worker {
+public:
+    explicit Worker(std::string name) {
+        thread = std::thread([this, name = std::move(name)] {
+            Common::Trace::SetThreadName(name);
+            u32 handled = 0;
+            while (true) {
+                const u32 request = requests.load();
+                if (request == handled) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (request == EXIT) {
+                    return;
+                }
+                RecordSpans(span_name, first_us, count);
+                handled = request;
+                done.store(handled);
+            }
+        });
+    }
+
+    ~Worker() {
+        Exit();
+    }
+
+    void Record(const char* name, u64 first, u64 num_spans) {
+        span_name = name;
+        first_us = first;
+        count = num_spans;
+        const u32 request = requests.load() + 1;
+        requests.store(request);
+        while (done.load() != request) {
+            std::this_thread::yield();
+        }
+    }
+
+    void Exit() {
+        if (thread.joinable()) {
+            requests.store(EXIT);
+            thread.join();
+        }
+    }
+
+private:
+    static constexpr u32 EXIT = ~0U;
+
+    std::thread thread;
+    std::atomic<u32> requests{0};
+    std::atomic<u32> done{0};
+    const char* span_name{};
+    u64 first_us{};
+    u64 count{};
+};
+
+void RequireSpans(const Capture& capture, const std::string& thread, const char* name,
+                  u64 first_us, u64 count) {
+    const auto it = capture.find(thread);
+    REQUIRE(it != capture.end());
+    const auto& spans = it->second;
+    REQUIRE(spans.size() == count);
+    for (u64 i = 0; i < count; ++i) {
+        REQUIRE(spans[i].name == name);
+        REQUIRE(spans[i].ts == first_us + i);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Trace[MultipleThreads]", "[common]") {
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (u32 i = 0; i < 4; ++i) {
+        workers.push_back(std::make_unique<Worker>(fmt::format("Multi {}", i)));
+    }
+
+    // Spans recorded before the capture are left out of it
+    workers[0]->Record("before", 1, 10);
+
+    Common::Trace::Start();
+    REQUIRE(Common::Trace::IsRecording());
+    std::vector<std::thread> threads;
+    for (u32 i = 0; i < workers.size(); ++i) {
+        threads.emplace_back([&, i] { workers[i]->Record("span", 100 * (i + 1), 50 + i); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const Capture capture = StopAndRead();
+
+    for (u32 i = 0; i < workers.size(); ++i) {
+        RequireSpans(capture, fmt::format("Multi {}", i), "span", 100 * (i + 1), 50 + i);
+    }
+}
+
+TEST_CASE("Trace[Wraparound]", "[common]") {
+    Worker worker{"Wraparound"};
+    Common::Trace::Start();
+
+    // A ring that did not fill up keeps all of its spans
+    worker.Record("partial", 1, SPANS_PER_THREAD - 1);
+    RequireSpans(StopAndRead(), "Wraparound", "partial", 1, SPANS_PER_THREAD - 1);
+
+    // A full ring keeps the newest spans, except those that may be overwritten while writing
+    Common::Trace::Start();
+    constexpr u64 num_spans = SPANS_PER_THREAD * 2 + 1234;
+    worker.Record("wrapped", 1, num_spans);
+    const u64 first_kept = num_spans - SPANS_PER_THREAD + UNSTABLE_SPANS + 1;
+    RequireSpans(StopAndRead(), "Wraparound", "wrapped", first_kept,
+                 SPANS_PER_THREAD - UNSTABLE_SPANS);
+}
+
+TEST_CASE("Trace[ThreadExitDuringCapture]", "[common]") {
+    Worker staying{"Staying"};
+    Common::Trace::Start();
+    {
+        Worker exiting{"Exiting during capture"};
+        exiting.Record("exiting", 1, 100);
+    }
+    staying.Record("staying", 1, 10);
+
+    // The spans of the exited thread are written by the capture they were recorded in
+    const Capture capture = StopAndRead();
+    RequireSpans(capture, "Exiting during capture", "exiting", 1, 100);
+    RequireSpans(capture, "Staying", "staying", 1, 10);
+
+    // And are not written again
+    Common::Trace::Start();
+    staying.Record("staying", 1, 10);
+    const Capture next_capture = StopAndRead();
+    REQUIRE(!next_capture.contains("Exiting during capture"));
+    RequireSpans(next_capture, "Staying", "staying", 1, 10);
+}
+
+TEST_CASE("Trace[ThreadExitBetweenCaptures]", "[common]") {
+    Worker staying{"Between staying"};
+    {
+        Worker exiting{"Exiting between captures"};
+        Common::Trace::Start();
+        exiting.Record("exiting", 1, 20);
+        RequireSpans(StopAndRead(), "Exiting between captures", "exiting", 1, 20);
+
+        // Spans recorded between captures belong to none of them
+        exiting.Record("between", 1, 20);
+    }
+    Worker started{"Started between captures"};
+    started.Record("between", 1, 20);
+
+    Common::Trace::Start();
+    staying.Record("staying", 1, 5);
+    started.Record("started", 100, 5);
+    const Capture capture = StopAndRead();
+    REQUIRE(!capture.contains("Exiting between captures"));
+    RequireSpans(capture, "Between staying", "staying", 1, 5);
+    RequireSpans(capture, "Started between captures", "started", 100, 5);
+}
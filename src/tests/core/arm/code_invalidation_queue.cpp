@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/arm/code_invalidation_queue.h"
+
+namespace {
+
+std::vector<std::pair<u64, u64>> Flush(Core::CodeInvalidationQueue& queue) {
+    std::vector<std::pair<u64, u64>> ranges;
+    queue.Flush([&](u64 addr, u64 size) { ranges.emplace_back(addr, size); });
+    return ranges;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CodeInvalidationQueue[Coalesce]", "[core]") {
+    Core::CodeInvalidationQueue queue;
+
+    // Nothing was translated yet
+    REQUIRE(!queue.Push(0x10000, 0x1000));
+    REQUIRE(Flush(queue).empty());
+
+    queue.RecordTranslation(0x10010);
+    queue.RecordTranslation(0x10014);
+    queue.RecordTranslation(0x11000);
+    REQUIRE(queue.Push(0x10800, 0x100));
+    REQUIRE(queue.Push(0x10880, 0x100));
+    REQUIRE(queue.Push(0x10980, 0x100));
+    REQUIRE(queue.Push(0x11ff0, 0x20));
+    REQUIRE(!queue.Push(0x20000, 0x4000));
+
+    const std::vector<std::pair<u64, u64>> expected{{0x10800, 0x280}, {0x11ff0, 0x20}};
+    REQUIRE(Flush(queue) == expected);
+    REQUIRE(Flush(queue).empty());
+
+    // Invalidated ranges are no longer tracked, the rest of their pages still is
+    REQUIRE(!queue.Push(0x10800, 0x280));
+    REQUIRE(queue.Push(0x10000, 0x10));
+
+    const auto statistics = queue.GetStatistics();
+    REQUIRE(statistics.num_requests == 8);
+    REQUIRE(statistics.num_skipped == 3);
+    REQUIRE(statistics.num_ranges == 2);
+    REQUIRE(statistics.invalidated_bytes == 0x2a0);
+}
+
+TEST_CASE("CodeInvalidationQueue[Retranslation]", "[core]") {
+    Core::CodeInvalidationQueue queue;
+
+    queue.RecordTranslation(0x10000);
+    REQUIRE(queue.Push(0x10000, 0x1000));
+    REQUIRE(Flush(queue).size() == 1);
+
+    // Code of the same page translated again is tracked again
+    queue.RecordTranslation(0x10000);
+    REQUIRE(queue.Push(0x10000, 0x4));
+}
+
+TEST_CASE("CodeInvalidationQueue[Clear]", "[core]") {
+    Core::CodeInvalidationQueue queue;
+
+    queue.RecordTranslation(0x10000);
+    queue.RecordTranslation(0x30000);
+    REQUIRE(queue.Push(0x10000, 0x1000));
+    queue.Clear();
+
+    // Clearing the whole cache supersedes the pending ranges
+    REQUIRE(Flush(queue).empty());
+    REQUIRE(!queue.Push(0x30000, 0x1000));
+}
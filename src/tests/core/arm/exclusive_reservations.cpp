@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/arm/exclusive_reservations.h"
+
+namespace {
+
+constexpr std::size_t NUM_CORES = 4;
+
+/// Guest memory of the tests, a word per granule
+struct alignas(64) Word {
+    std::atomic<u32> value{};
+};
+using Memory = std::array<Word, NUM_CORES + 1>;
+
+u32 Read(Memory& memory, VAddr addr) {
+    return memory[addr / 64].value.load();
+}
+
+bool CompareAndSwap(Memory& memory, VAddr addr, u32 value, u32 expected) {
+    return memory[addr / 64].value.compare_exchange_strong(expected, value);
+}
+
+/// Increments a word the way guest code does with an LDXR/STXR loop
+void Increment(Core::ExclusiveReservations& reservations, Memory& memory, std::size_t core,
+               VAddr addr) {
+    while (true) {
+        const u32 value =
+            reservations.ReadAndMark<u32>(core, addr, [&] { return Read(memory, addr); });
+        if (reservations.DoExclusiveOperation<u32>(core, addr, [&](u32 expected) {
+                return CompareAndSwap(memory, addr, value + 1, expected);
+            })) {
+            return;
+        }
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ExclusiveReservations[Basic]", "[core]") {
+    Core::ExclusiveReservations reservations(NUM_CORES);
+    Memory memory{};
+    const auto read = [&](std::size_t core, VAddr addr) {
+        return reservations.ReadAndMark<u32>(core, addr, [&] { return Read(memory, addr); });
+    };
+    const auto write = [&](std::size_t core, VAddr addr, u32 value) {
+        return reservations.DoExclusiveOperation<u32>(core, addr, [&](u32 expected) {
+            return CompareAndSwap(memory, addr, value, expected);
+        });
+    };
+
+    // Writes without a reservation fail, a reservation is used by a single write
+    REQUIRE(!write(0, 0, 1));
+    read(0, 0);
+    REQUIRE(write(0, 0, 1));
+    REQUIRE(!write(0, 0, 2));
+    REQUIRE(Read(memory, 0) == 1);
+
+    // A write clears the reservations other cores hold on the same granule
+    read(0, 0);
+    read(1, 4);
+    read(2, 64);
+    REQUIRE(write(1, 4, 5));
+    REQUIRE(!write(0, 0, 3));
+    REQUIRE(write(2, 64, 7));
+
+    // Writes outside of the reserved granule fail
+    read(0, 0);
+    REQUIRE(!write(0, 64, 9));
+
+    read(3, 128);
+    reservations.ClearProcessor(3);
+    REQUIRE(!write(3, 128, 1));
+
+    const auto statistics = reservations.GetStatistics();
+    REQUIRE(statistics.num_writes == 8);
+    REQUIRE(statistics.num_failed == 5);
+    REQUIRE(statistics.num_invalidated == 1);
+}
+
+TEST_CASE("ExclusiveReservations[Stress]", "[core]") {
+    // Every core increments a shared word and a word of its own
+    constexpr u32 num_iterations = 100000;
+    Core::ExclusiveReservations reservations(NUM_CORES);
+    Memory memory{};
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            threads.emplace_back([&, core] {
+                for (u32 i = 0; i < num_iterations; ++i) {
+                    Increment(reservations, memory, core, 0);
+                    Increment(reservations, memory, core, (core + 1) * 64);
+                }
+            });
+        }
+    }
+    REQUIRE(Read(memory, 0) == num_iterations * NUM_CORES);
+    for (std::size_t core = 0; core < NUM_CORES; ++core) {
+        REQUIRE(Read(memory, (core + 1) * 64) == num_iterations);
+    }
+    const auto statistics = reservations.GetStatistics();
+    REQUIRE(statistics.num_writes - statistics.num_failed == 2 * num_iterations * NUM_CORES);
+}
+
+TEST_CASE("ExclusiveReservations[Benchmark]", "[.benchmark]") {
+    constexpr u32 num_iterations = 1000000;
+    Core::ExclusiveReservations reservations(NUM_CORES);
+    Memory memory{};
+
+    BENCHMARK("Increment separate words on 4 threads") {
+        std::vector<std::jthread> threads;
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            threads.emplace_back([&, core] {
+                for (u32 i = 0; i < num_iterations; ++i) {
+                    Increment(reservations, memory, core, (core + 1) * 64);
+                }
+            });
+        }
+    };
+
+    BENCHMARK("Increment a shared word on 4 threads") {
+        std::vector<std::jthread> threads;
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            threads.emplace_back([&, core] {
+                for (u32 i = 0; i < num_iterations; ++i) {
+                    Increment(reservations, memory, core, 0);
+                }
+            });
+        }
+    };
+}
@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/device_memory.h"
+#include "core/device_memory_manager.inc"
+
+namespace {
+
+using namespace Common::Literals;
+
+constexpr VAddr PAGE_SIZE = 4_KiB;
+constexpr VAddr LARGE_PAGE_SIZE = 64_KiB;
+
+class FakeDeviceInterface {
+public:
+    void InvalidateRegion(DAddr, size_t) {}
+    void FlushRegion(DAddr, size_t) {}
+};
+
+/// Process memory whose pages are mapped one by one to host pointers
+class FakeProcessMemory {
+public:
+    void Map(VAddr address, u8* pointer, size_t size) {
+        for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            pages[address + offset] = pointer + offset;
+        }
+    }
+
+    u8* GetPointerSilent(Common::ProcessAddress address) {
+        const VAddr vaddr = GetInteger(address);
+        const auto it = pages.find(vaddr & ~(PAGE_SIZE - 1));
+        return it == pages.end() ? nullptr : it->second + (vaddr & (PAGE_SIZE - 1));
+    }
+
+private:
+    std::unordered_map<VAddr, u8*> pages;
+};
+
+struct FakeDeviceMethods {};
+
+struct FakeDeviceTraits {
+    static constexpr size_t device_virtual_bits = 30;
+    using DeviceInterface = FakeDeviceInterface;
+    using DeviceMethods = FakeDeviceMethods;
+    using ProcessMemory = FakeProcessMemory;
+};
+
+using Manager = Core::DeviceMemoryManager<FakeDeviceTraits>;
+
+class Fixture {
+public:
+    Fixture() : manager{device_memory} {
+        manager.BindInterface(&device_interface);
+        asid = manager.RegisterProcess(&process_memory);
+    }
+
+    /// Host memory at the given offset of the emulated DRAM
+    u8* Host(size_t offset) {
+        return device_memory.buffer.BackingBasePointer() + offset;
+    }
+
+    /// Checks that every page of a device range translates to the expected host page
+    void RequireTranslation(DAddr address, const std::vector<u8*>& pages) {
+        for (size_t i = 0; i < pages.size(); ++i) {
+            REQUIRE(manager.GetPointer<u8>(address + i * PAGE_SIZE) == pages[i]);
+        }
+    }
+
+    Core::DeviceMemory device_memory;
+    FakeDeviceInterface device_interface;
+    FakeProcessMemory process_memory;
+    Manager manager;
+    Core::Asid asid{};
+};
+
+std::vector<u8*> Contiguous(u8* pointer, size_t size) {
+    std::vector<u8*> pages;
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+        pages.push_back(pointer + offset);
+    }
+    return pages;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DeviceMemoryManager[Allocate]", "[core]") {
+    Fixture f;
+
+    // Small allocations are not padded to large pages
+    const DAddr small_a = f.manager.Allocate(PAGE_SIZE);
+    const DAddr small_b = f.manager.Allocate(3 * PAGE_SIZE);
+    REQUIRE(small_a != 0);
+    REQUIRE(small_b == small_a + PAGE_SIZE);
+
+    // Large allocations start on a large page and do not overlap what follows them
+    const DAddr large_a = f.manager.Allocate(LARGE_PAGE_SIZE + PAGE_SIZE);
+    const DAddr large_b = f.manager.Allocate(2 * LARGE_PAGE_SIZE);
+    REQUIRE(large_a % LARGE_PAGE_SIZE == 0);
+    REQUIRE(large_b % LARGE_PAGE_SIZE == 0);
+    REQUIRE(large_a >= small_b + 3 * PAGE_SIZE);
+    REQUIRE(large_b >= large_a + 2 * LARGE_PAGE_SIZE);
+
+    const DAddr small_c = f.manager.Allocate(PAGE_SIZE);
+    REQUIRE(small_c >= large_b + 2 * LARGE_PAGE_SIZE);
+
+    // Frees take the sizes that were allocated
+    f.manager.Free(large_a, LARGE_PAGE_SIZE + PAGE_SIZE);
+    f.manager.Free(large_b, 2 * LARGE_PAGE_SIZE);
+    f.manager.Free(small_a, PAGE_SIZE);
+    f.manager.Free(small_b, 3 * PAGE_SIZE);
+    f.manager.Free(small_c, PAGE_SIZE);
+}
+
+TEST_CASE("DeviceMemoryManager[MapLargePages]", "[core]") {
+    Fixture f;
+    constexpr VAddr vaddr = 0x80000000;
+    constexpr size_t size = 4 * LARGE_PAGE_SIZE + 3 * PAGE_SIZE;
+    u8* const host = f.Host(1_MiB);
+    f.process_memory.Map(vaddr, host, size);
+
+    const DAddr address = f.manager.Allocate(size);
+    f.manager.Map(address, vaddr, size, f.asid);
+    f.RequireTranslation(address, Contiguous(host, size));
+    REQUIRE(f.manager.GetPhysicalRawAddressFromDAddr(address + 2 * LARGE_PAGE_SIZE + 0x123) ==
+            1_MiB + 2 * LARGE_PAGE_SIZE + 0x123);
+
+    f.manager.Unmap(address, size);
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+        REQUIRE(f.manager.GetPointer<u8>(address + offset) == nullptr);
+    }
+    f.manager.Free(address, size);
+}
+
+TEST_CASE("DeviceMemoryManager[SplitLargePage]", "[core]") {
+    Fixture f;
+    constexpr VAddr vaddr = 0x80000000;
+    constexpr VAddr other_vaddr = 0x90000000;
+    constexpr size_t size = 3 * LARGE_PAGE_SIZE;
+    u8* const host = f.Host(2_MiB);
+    u8* const other_host = f.Host(8_MiB);
+    f.process_memory.Map(vaddr, host, size);
+    f.process_memory.Map(other_vaddr, other_host, 2 * PAGE_SIZE);
+
+    const DAddr address = f.manager.Allocate(size);
+    f.manager.Map(address, vaddr, size, f.asid);
+    std::vector<u8*> expected = Contiguous(host, size);
+
+    // Unmapping two pages in the middle of a large page keeps the rest of it
+    const size_t hole = LARGE_PAGE_SIZE + 5 * PAGE_SIZE;
+    f.manager.Unmap(address + hole, 2 * PAGE_SIZE);
+    expected[hole / PAGE_SIZE] = nullptr;
+    expected[hole / PAGE_SIZE + 1] = nullptr;
+    f.RequireTranslation(address, expected);
+
+    // Mapping other memory in the hole leaves the neighbouring pages untouched
+    f.manager.Map(address + hole, other_vaddr, 2 * PAGE_SIZE, f.asid);
+    expected[hole / PAGE_SIZE] = other_host;
+    expected[hole / PAGE_SIZE + 1] = other_host + PAGE_SIZE;
+    f.RequireTranslation(address, expected);
+
+    // Unmapping the split large page and the large pages around it clears all of them
+    f.manager.Unmap(address, size);
+    f.RequireTranslation(address, std::vector<u8*>(size / PAGE_SIZE, nullptr));
+    f.manager.Free(address, size);
+}
+
+TEST_CASE("DeviceMemoryManager[WalkBlock]", "[core]") {
+    Fixture f;
+    constexpr VAddr vaddr = 0x80000000;
+    constexpr size_t size = 3 * LARGE_PAGE_SIZE;
+
+    // A large page, a block of scattered small pages and another large page
+    std::vector<u8*> expected = Contiguous(f.Host(4_MiB), LARGE_PAGE_SIZE);
+    for (size_t i = 0; i < LARGE_PAGE_SIZE / PAGE_SIZE; ++i) {
+        expected.push_back(f.Host(16_MiB + (LARGE_PAGE_SIZE / PAGE_SIZE - i) * 2 * PAGE_SIZE));
+    }
+    const std::vector<u8*> last = Contiguous(f.Host(6_MiB), LARGE_PAGE_SIZE);
+    expected.insert(expected.end(), last.begin(), last.end());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        f.process_memory.Map(vaddr + i * PAGE_SIZE, expected[i], PAGE_SIZE);
+    }
+
+    for (const bool track : {false, true}) {
+        const DAddr address = f.manager.Allocate(size);
+        f.manager.Map(address, vaddr, size, f.asid, track);
+        f.RequireTranslation(address, expected);
+
+        constexpr std::array<std::pair<size_t, size_t>, 5> ranges{{
+            {0, size},
+            {LARGE_PAGE_SIZE - 0x10, 0x20},
+            {LARGE_PAGE_SIZE / 2 + 3, LARGE_PAGE_SIZE + 0x1001},
+            {2 * LARGE_PAGE_SIZE - PAGE_SIZE - 7, PAGE_SIZE + 14},
+            {PAGE_SIZE + 1, size - 2 * PAGE_SIZE},
+        }};
+        u8 seed = track ? 0x80 : 0;
+        for (const auto [offset, length] : ranges) {
+            std::vector<u8> data(length);
+            for (size_t i = 0; i < length; ++i) {
+                data[i] = static_cast<u8>(i * 7 + seed);
+            }
+            ++seed;
+            f.manager.WriteBlock(address + offset, data.data(), length);
+            for (size_t i = 0; i < length; ++i) {
+                const size_t byte = offset + i;
+                REQUIRE(expected[byte / PAGE_SIZE][byte % PAGE_SIZE] == data[i]);
+            }
+
+            std::vector<u8> read(length);
+            f.manager.ReadBlock(address + offset, read.data(), length);
+            REQUIRE(read == data);
+        }
+
+        f.manager.Unmap(address, size);
+        f.manager.Free(address, size);
+    }
+}
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/idle_loop_detector.h"
+#include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_results.h"
+
+namespace {
+
+using Kernel::IdleLoopDetector;
+using Clock = IdleLoopDetector::Clock;
+using namespace std::chrono_literals;
+
+const auto* const Thread = reinterpret_cast<const Kernel::KThread*>(0x1000);
+const auto* const OtherThread = reinterpret_cast<const Kernel::KThread*>(0x2000);
+
+/// Makes calls one microsecond apart, returns the park time requested by the last one
+std::chrono::nanoseconds Spin(IdleLoopDetector& detector, Clock::time_point& now, u32 num_calls,
+                              const Kernel::KThread* thread = Thread) {
+    std::chrono::nanoseconds park_time{};
+    for (u32 i = 0; i < num_calls; ++i) {
+        park_time = detector.OnSupervisorCall(thread, true, now, now + 100ns);
+        now += 1us;
+    }
+    return park_time;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("IdleLoopDetector[Threshold]", "[kernel]") {
+    IdleLoopDetector detector;
+    Clock::time_point now{};
+
+    REQUIRE(Spin(detector, now, IdleLoopDetector::SpinThreshold - 1) == 0ns);
+    REQUIRE(Spin(detector, now, 1) == IdleLoopDetector::MinParkTime);
+
+    // Parks double while the thread keeps spinning
+    REQUIRE(Spin(detector, now, 1) == IdleLoopDetector::MinParkTime * 2);
+    REQUIRE(Spin(detector, now, 16) == IdleLoopDetector::MaxParkTime);
+}
+
+TEST_CASE("IdleLoopDetector[Reset]", "[kernel]") {
+    IdleLoopDetector detector;
+    Clock::time_point now{};
+
+    SECTION("Call making progress") {
+        Spin(detector, now, IdleLoopDetector::SpinThreshold - 1);
+        REQUIRE(detector.OnSupervisorCall(Thread, false, now, now + 100ns) == 0ns);
+        now += 1us;
+        REQUIRE(Spin(detector, now, IdleLoopDetector::SpinThreshold - 1) == 0ns);
+        REQUIRE(Spin(detector, now, 1) == IdleLoopDetector::MinParkTime);
+    }
+    SECTION("Other thread") {
+        Spin(detector, now, IdleLoopDetector::SpinThreshold - 1);
+        REQUIRE(Spin(detector, now, 1, OtherThread) == 0ns);
+        REQUIRE(Spin(detector, now, IdleLoopDetector::SpinThreshold - 2, OtherThread) == 0ns);
+        REQUIRE(Spin(detector, now, 1, OtherThread) == IdleLoopDetector::MinParkTime);
+    }
+    SECTION("Guest code running between calls") {
+        Spin(detector, now, IdleLoopDetector::SpinThreshold - 1);
+        now += IdleLoopDetector::MaxLoopTime * 2;
+        REQUIRE(Spin(detector, now, IdleLoopDetector::SpinThreshold - 1) == 0ns);
+        REQUIRE(Spin(detector, now, 1) == IdleLoopDetector::MinParkTime);
+    }
+    SECTION("Backoff") {
+        Spin(detector, now, IdleLoopDetector::SpinThreshold + 4);
+        detector.OnSupervisorCall(Thread, false, now, now + 100ns);
+        now += 1us;
+        REQUIRE(Spin(detector, now, IdleLoopDetector::SpinThreshold) ==
+                IdleLoopDetector::MinParkTime);
+    }
+}
+
+TEST_CASE("IdleLoopDetector[Parks]", "[kernel]") {
+    IdleLoopDetector detector;
+    Clock::time_point now{};
+
+    const auto park_time = Spin(detector, now, IdleLoopDetector::SpinThreshold);
+    detector.OnParked(now, now + park_time);
+    now += park_time;
+
+    // The loop goes on from the end of the park
+    REQUIRE(Spin(detector, now, 1) == IdleLoopDetector::MinParkTime * 2);
+
+    const auto statistics = detector.GetStatistics();
+    REQUIRE(statistics.num_parks == 1);
+    REQUIRE(statistics.parked_time == park_time);
+}
+
+TEST_CASE("IdleLoopDetector[PollingCalls]", "[kernel]") {
+    using Kernel::Svc::SvcId;
+    const auto is_polling = [](SvcId id, std::array<u64, 8> args, bool is_64bit = true) {
+        return IdleLoopDetector::IsPollingCall(static_cast<u32>(id), args, is_64bit);
+    };
+
+    REQUIRE(!is_polling(SvcId::GetSystemTick, {}));
+    REQUIRE(is_polling(SvcId::WaitSynchronization, {Kernel::ResultTimedOut.raw}));
+    REQUIRE(!is_polling(SvcId::WaitSynchronization, {0}));
+    REQUIRE(!is_polling(SvcId::WaitSynchronization, {Kernel::ResultCancelled.raw}));
+    REQUIRE(is_polling(SvcId::SleepThread, {0}));
+    REQUIRE(is_polling(SvcId::SleepThread, {static_cast<u64>(-1)}));
+    REQUIRE(!is_polling(SvcId::SleepThread, {1000000}));
+    REQUIRE(is_polling(SvcId::SleepThread, {0xffffffff, 0xffffffff}, false));
+    REQUIRE(!is_polling(SvcId::SleepThread, {0, 1}, false));
+    REQUIRE(!is_polling(SvcId::SendSyncRequest, {}));
+}
+
+TEST_CASE("IdleLoopDetector[Benchmark]", "[.benchmark]") {
+    // A guest thread waiting for the next frame by yielding in a loop
+    constexpr auto frame_time = std::chrono::microseconds{16667};
+    constexpr u32 num_frames = 30;
+
+    const auto cpu_time_per_frame = [&](bool park) {
+        IdleLoopDetector detector;
+        const std::clock_t start = std::clock();
+        for (u32 frame = 0; frame < num_frames; ++frame) {
+            const auto frame_end = Clock::now() + frame_time;
+            for (auto now = Clock::now(); now < frame_end; now = Clock::now()) {
+                const auto park_time = detector.OnSupervisorCall(Thread, true, now, now);
+                if (park && park_time != 0ns) {
+                    const Clock::duration remaining = frame_end - now;
+                    std::this_thread::sleep_for(std::min<Clock::duration>(park_time, remaining));
+                    detector.OnParked(now, Clock::now());
+                }
+            }
+        }
+        const double cpu_ms = 1000.0 * static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        return cpu_ms / num_frames;
+    };
+
+    const double spinning = cpu_time_per_frame(false);
+    const double parked = cpu_time_per_frame(true);
+    WARN("Host CPU time per 16.7 ms frame: " << spinning << " ms spinning, " << parked
+                                             << " ms parked");
+    REQUIRE(parked < spinning);
+}
@@ -0,0 +1,227 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/hle/kernel/k_dynamic_page_manager.h"
+#include "core/hle/kernel/k_dynamic_resource_manager.h"
+#include "core/hle/kernel/k_memory_block_manager.h"
+
+namespace {
+
+using namespace Common::Literals;
+using Kernel::KMemoryAttribute;
+using Kernel::KMemoryBlockDisableMergeAttribute;
+using Kernel::KMemoryPermission;
+using Kernel::KMemoryState;
+using Kernel::PageSize;
+
+constexpr u64 AddressSpaceStart = 0x8000000;
+constexpr u64 AddressSpaceEnd = AddressSpaceStart + 64_GiB;
+constexpr u64 HeapAddress = AddressSpaceStart + 16_GiB;
+
+class BlockManager {
+public:
+    BlockManager() {
+        REQUIRE(m_page_manager.Initialize(Kernel::KVirtualAddress{0x10000000}, 4_MiB, PageSize) ==
+                ResultSuccess);
+        m_slab_heap.Initialize(&m_page_manager, 0x1000);
+        m_slab_manager.Initialize(&m_page_manager, &m_slab_heap);
+        REQUIRE(m_manager.Initialize(AddressSpaceStart, AddressSpaceEnd, &m_slab_manager) ==
+                ResultSuccess);
+    }
+
+    ~BlockManager() {
+        m_manager.Finalize(&m_slab_manager, [](Common::ProcessAddress, u64) {});
+    }
+
+    void Update(u64 address, size_t num_pages, KMemoryState state, KMemoryPermission perm,
+                KMemoryBlockDisableMergeAttribute set_disable_attr =
+                    KMemoryBlockDisableMergeAttribute::None) {
+        Result result;
+        Kernel::KMemoryBlockManagerUpdateAllocator allocator(&result, &m_slab_manager);
+        REQUIRE(result == ResultSuccess);
+        m_manager.Update(&allocator, address, num_pages, state, perm, KMemoryAttribute::None,
+                         set_disable_attr, KMemoryBlockDisableMergeAttribute::None);
+    }
+
+    void UpdateAttribute(u64 address, size_t num_pages, KMemoryAttribute attr) {
+        Result result;
+        Kernel::KMemoryBlockManagerUpdateAllocator allocator(&result, &m_slab_manager);
+        REQUIRE(result == ResultSuccess);
+        m_manager.UpdateAttribute(&allocator, address, num_pages, attr, attr);
+    }
+
+    /// Returns the blocks as (address, size) pairs
+    std::vector<std::pair<u64, u64>> GetBlocks() const {
+        std::vector<std::pair<u64, u64>> blocks;
+        for (auto it = m_manager.FindIterator(AddressSpaceStart); it != m_manager.cend(); ++it) {
+            blocks.emplace_back(GetInteger(it->GetAddress()), it->GetSize());
+        }
+        return blocks;
+    }
+
+    const Kernel::KMemoryBlock* FindBlock(u64 address) const {
+        return m_manager.FindBlock(address);
+    }
+
+    bool CheckState() const {
+        return m_manager.CheckState();
+    }
+
+    size_t GetUsedBlocks() const {
+        return m_slab_heap.GetUsed();
+    }
+
+private:
+    Kernel::KDynamicPageManager m_page_manager;
+    Kernel::KMemoryBlockSlabHeap m_slab_heap;
+    Kernel::KMemoryBlockSlabManager m_slab_manager;
+    Kernel::KMemoryBlockManager m_manager;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("KMemoryBlockManager[SplitAndCoalesce]", "[kernel]") {
+    BlockManager manager;
+
+    manager.Update(HeapAddress, 16, KMemoryState::Normal, KMemoryPermission::UserReadWrite);
+    REQUIRE(manager.GetBlocks().size() == 3);
+
+    // Protecting the middle of a block splits it in three
+    manager.Update(HeapAddress + 4 * PageSize, 4, KMemoryState::Normal,
+                   KMemoryPermission::UserRead);
+    REQUIRE(manager.GetBlocks().size() == 5);
+    REQUIRE(manager.FindBlock(HeapAddress + 5 * PageSize)->GetPermission() ==
+            KMemoryPermission::UserRead);
+    REQUIRE(manager.FindBlock(HeapAddress + 8 * PageSize)->GetPermission() ==
+            KMemoryPermission::UserReadWrite);
+    REQUIRE(manager.CheckState());
+
+    // Protecting it back merges the three blocks again
+    manager.Update(HeapAddress + 4 * PageSize, 4, KMemoryState::Normal,
+                   KMemoryPermission::UserReadWrite);
+    const std::vector<std::pair<u64, u64>> expected{
+        {AddressSpaceStart, HeapAddress - AddressSpaceStart},
+        {HeapAddress, 16 * PageSize},
+        {HeapAddress + 16 * PageSize, AddressSpaceEnd - HeapAddress - 16 * PageSize},
+    };
+    REQUIRE(manager.GetBlocks() == expected);
+    REQUIRE(manager.GetUsedBlocks() == 3);
+    REQUIRE(manager.CheckState());
+}
+
+TEST_CASE("KMemoryBlockManager[RangeOverManyBlocks]", "[kernel]") {
+    BlockManager manager;
+
+    manager.Update(HeapAddress, 64, KMemoryState::Normal, KMemoryPermission::UserReadWrite);
+    for (size_t page = 1; page < 64; page += 2) {
+        manager.Update(HeapAddress + page * PageSize, 1, KMemoryState::Normal,
+                       KMemoryPermission::UserRead);
+    }
+    REQUIRE(manager.GetBlocks().size() == 66);
+    REQUIRE(manager.CheckState());
+
+    // A single update over the whole range coalesces it into one block
+    manager.Update(HeapAddress + PageSize, 62, KMemoryState::Normal, KMemoryPermission::UserRead);
+    REQUIRE(manager.GetBlocks().size() == 4);
+    REQUIRE(manager.CheckState());
+
+    manager.UpdateAttribute(HeapAddress, 64, KMemoryAttribute::Uncached);
+    REQUIRE(manager.GetBlocks().size() == 4);
+    manager.Update(HeapAddress, 64, KMemoryState::Free, KMemoryPermission::None);
+    manager.UpdateAttribute(HeapAddress, 64, KMemoryAttribute::None);
+    REQUIRE(manager.GetBlocks().size() == 1);
+    REQUIRE(manager.GetUsedBlocks() == 1);
+    REQUIRE(manager.CheckState());
+}
+
+TEST_CASE("KMemoryBlockManager[DisableMerge]", "[kernel]") {
+    BlockManager manager;
+
+    // Blocks mapped separately with the left merge disabled stay separate
+    manager.Update(HeapAddress, 4, KMemoryState::Normal, KMemoryPermission::UserReadWrite,
+                   KMemoryBlockDisableMergeAttribute::Normal);
+    manager.Update(HeapAddress + 4 * PageSize, 4, KMemoryState::Normal,
+                   KMemoryPermission::UserReadWrite, KMemoryBlockDisableMergeAttribute::Normal);
+    REQUIRE(manager.GetBlocks().size() == 4);
+
+    manager.Update(HeapAddress, 8, KMemoryState::Normal, KMemoryPermission::UserRead);
+    REQUIRE(manager.GetBlocks().size() == 4);
+    REQUIRE(manager.CheckState());
+}
+
+TEST_CASE("KMemoryBlockManager[Random]", "[kernel]") {
+    constexpr size_t NumPages = 256;
+    constexpr std::array permissions{KMemoryPermission::UserRead, KMemoryPermission::UserReadWrite,
+                                     KMemoryPermission::UserReadExecute};
+    BlockManager manager;
+    manager.Update(HeapAddress, NumPages, KMemoryState::Normal, KMemoryPermission::UserReadWrite);
+    std::vector<KMemoryPermission> expected(NumPages, KMemoryPermission::UserReadWrite);
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<size_t> page_dist{0, NumPages - 1};
+    std::uniform_int_distribution<size_t> perm_dist{0, permissions.size() - 1};
+    for (int i = 0; i < 2000; ++i) {
+        const size_t first = page_dist(rng);
+        const size_t num_pages = std::min(NumPages - first, page_dist(rng) % 32 + 1);
+        const KMemoryPermission perm = permissions[perm_dist(rng)];
+        manager.Update(HeapAddress + first * PageSize, num_pages, KMemoryState::Normal, perm);
+        std::fill_n(expected.begin() + first, num_pages, perm);
+
+        REQUIRE(manager.CheckState());
+        for (size_t page = 0; page < NumPages; ++page) {
+            REQUIRE(manager.FindBlock(HeapAddress + page * PageSize)->GetPermission() ==
+                    expected[page]);
+        }
+    }
+}
+
+TEST_CASE("KMemoryBlockManager[Benchmark]", "[.benchmark]") {
+    constexpr size_t NumPages = 0x4000;
+
+    // A JIT service protecting small ranges of its code memory back and forth
+    BENCHMARK("Protect small ranges of a large mapping") {
+        BlockManager manager;
+        manager.Update(HeapAddress, NumPages, KMemoryState::Normal,
+                       KMemoryPermission::UserReadWrite);
+        std::mt19937 rng{1234};
+        std::uniform_int_distribution<size_t> page_dist{0, NumPages - 8};
+        std::uniform_int_distribution<size_t> size_dist{1, 8};
+        for (int i = 0; i < 20000; ++i) {
+            const u64 address = HeapAddress + page_dist(rng) * PageSize;
+            const size_t num_pages = size_dist(rng);
+            manager.Update(address, num_pages, KMemoryState::Normal, KMemoryPermission::UserRead);
+            manager.Update(address, num_pages, KMemoryState::Normal,
+                           KMemoryPermission::UserReadWrite);
+        }
+    };
+
+    // A loader mapping modules and protecting their segments, then unmapping them
+    BENCHMARK("Map, protect and unmap modules") {
+        BlockManager manager;
+        for (int iteration = 0; iteration < 20; ++iteration) {
+            for (u64 module = 0; module < 256; ++module) {
+                const u64 address = HeapAddress + module * 64 * PageSize;
+                manager.Update(address, 64, KMemoryState::CodeData,
+                               KMemoryPermission::UserReadWrite);
+                manager.Update(address, 32, KMemoryState::Code,
+                               KMemoryPermission::UserReadExecute);
+                manager.Update(address + 32 * PageSize, 16, KMemoryState::Code,
+                               KMemoryPermission::UserRead);
+            }
+            for (u64 module = 0; module < 256; ++module) {
+                const u64 address = HeapAddress + module * 64 * PageSize;
+                manager.Update(address, 64, KMemoryState::Free, KMemoryPermission::None);
+            }
+        }
+    };
+}
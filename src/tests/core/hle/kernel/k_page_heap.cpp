@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/hle/kernel/k_idle_page_bitmap.h"
+#include "core/hle/kernel/k_page_heap.h"
+
+namespace {
+
+using namespace Common::Literals;
+using Kernel::KIdlePageBitmap;
+using Kernel::KPageHeap;
+using Kernel::KPhysicalAddress;
+using Kernel::PageSize;
+
+constexpr u64 HeapAddress = 0x80000000;
+constexpr size_t HeapSize = 64_MiB;
+
+/// Returns which pages of the heap are reported free, counting pages reported twice
+std::vector<u8> GetFreePages(const KPageHeap& heap) {
+    std::vector<u8> pages(HeapSize / PageSize);
+    heap.ForEachFreeBlock([&](KPhysicalAddress block, size_t num_pages) {
+        const size_t first = (block - HeapAddress) / PageSize;
+        for (size_t i = 0; i < num_pages; i++) {
+            pages[first + i]++;
+        }
+    });
+    return pages;
+}
+
+/// Returns which pages of the heap are in runs, counting pages in several of them
+std::vector<u8> GetRunPages(const std::vector<KIdlePageBitmap::Run>& runs) {
+    std::vector<u8> pages(HeapSize / PageSize);
+    for (const auto& [first, num_pages] : runs) {
+        for (size_t i = 0; i < num_pages; i++) {
+            pages[first + i]++;
+        }
+    }
+    return pages;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("KPageHeap[ForEachFreeBlock]", "[kernel]") {
+    // The heap keeps its bitmaps in host memory, past any address of the guest.
+    KPageHeap heap;
+    heap.Initialize(HeapAddress, HeapSize, Kernel::KVirtualAddress{0xFFFFFF8000000000ULL},
+                    KPageHeap::CalculateManagementOverheadSize(HeapSize));
+    REQUIRE(GetFreePages(heap) == std::vector<u8>(HeapSize / PageSize));
+
+    heap.Free(HeapAddress, HeapSize / PageSize);
+    REQUIRE(GetFreePages(heap) == std::vector<u8>(HeapSize / PageSize, 1));
+
+    // Allocate blocks of random sizes, the free blocks are exactly the rest of the heap
+    std::mt19937 rng{1234};
+    std::vector<u8> expected(HeapSize / PageSize, 1);
+    for (int i = 0; i < 200; i++) {
+        const s32 index = i % 20 == 0 ? 2 : static_cast<s32>(rng() % 2);
+        const KPhysicalAddress block = heap.AllocateBlock(index, (rng() & 1) != 0);
+        REQUIRE(block != 0);
+        const size_t first = (block - HeapAddress) / PageSize;
+        for (size_t page = 0; page < KPageHeap::GetBlockNumPages(index); page++) {
+            expected[first + page] = 0;
+        }
+    }
+    REQUIRE(GetFreePages(heap) == expected);
+    REQUIRE(heap.GetFreeSize() ==
+            static_cast<size_t>(std::count(expected.begin(), expected.end(), 1)) * PageSize);
+}
+
+TEST_CASE("KIdlePageBitmap[Mark]", "[kernel]") {
+    KIdlePageBitmap idle;
+    idle.Initialize(6 * 64);
+    std::vector<u64> zeroed(6);
+    const auto get_zeroed = [&](size_t word) { return zeroed[word]; };
+
+    // Pages seen free for the first time are not idle yet
+    std::vector<KIdlePageBitmap::Run> runs;
+    idle.Mark(3, 197, get_zeroed, runs);
+    idle.Mark(256, 128, get_zeroed, runs);
+    REQUIRE(runs.empty());
+
+    // Runs skip the pages freed since and those known to be zeroed, and are merged across words
+    idle.Clear(10, 10);
+    zeroed[1] = ~u64(0) << 36;
+    zeroed[2] = 0x3;
+    idle.Mark(0, 6 * 64, get_zeroed, runs);
+    REQUIRE(runs == std::vector<KIdlePageBitmap::Run>{{3, 7}, {20, 80}, {130, 70}, {256, 128}});
+
+    // Every page is idle from now on, except the zeroed ones
+    runs.clear();
+    idle.Mark(0, 6 * 64, get_zeroed, runs);
+    REQUIRE(runs == std::vector<KIdlePageBitmap::Run>{{0, 100}, {130, 254}});
+}
+
+TEST_CASE("KIdlePageBitmap[ForEachFreeBlock]", "[kernel]") {
+    KPageHeap heap;
+    heap.Initialize(HeapAddress, HeapSize, Kernel::KVirtualAddress{0xFFFFFF8000000000ULL},
+                    KPageHeap::CalculateManagementOverheadSize(HeapSize));
+    heap.Free(HeapAddress, HeapSize / PageSize);
+
+    // Scan the free blocks of the heap, as KMemoryManager reclaims idle pages
+    KIdlePageBitmap idle;
+    idle.Initialize(HeapSize / PageSize);
+    std::vector<u64> zeroed(HeapSize / PageSize / 64);
+    const auto scan = [&] {
+        std::vector<KIdlePageBitmap::Run> runs;
+        heap.ForEachFreeBlock([&](KPhysicalAddress block, size_t num_pages) {
+            idle.Mark((block - HeapAddress) / PageSize, num_pages,
+                      [&](size_t word) { return zeroed[word]; }, runs);
+        });
+        return runs;
+    };
+
+    std::mt19937 rng{1234};
+    std::vector<std::pair<KPhysicalAddress, size_t>> blocks;
+    for (int i = 0; i < 200; i++) {
+        const s32 index = static_cast<s32>(rng() % 2);
+        const KPhysicalAddress block = heap.AllocateBlock(index, true);
+        REQUIRE(block != 0);
+        blocks.emplace_back(block, KPageHeap::GetBlockNumPages(index));
+    }
+    REQUIRE(scan().empty());
+
+    // Free every other block and mark some pages zeroed, the rest of the free pages stayed idle
+    std::vector<u8> expected = GetFreePages(heap);
+    for (size_t i = 0; i < blocks.size(); i += 2) {
+        const auto [block, num_pages] = blocks[i];
+        const size_t first = (block - HeapAddress) / PageSize;
+        idle.Clear(first, num_pages);
+        heap.Free(block, num_pages);
+    }
+    for (size_t word = 0; word < zeroed.size(); word += 7) {
+        zeroed[word] = rng() | (u64(rng()) << 32);
+        for (size_t bit = 0; bit < 64; bit++) {
+            if ((zeroed[word] >> bit) & 1) {
+                expected[word * 64 + bit] = 0;
+            }
+        }
+    }
+    REQUIRE(GetRunPages(scan()) == expected);
+}
@@ -0,0 +1,505 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/hle/kernel/k_page_heap.h"
+#include "core/hle/kernel/k_page_heap_cache.h"
+
+namespace {
+
+using namespace Common::Literals;
+using Kernel::KPageHeap;
+using Kernel::KPageHeapCache;
+using Kernel::KPhysicalAddress;
+using Kernel::KScopedSpinLock;
+using Kernel::KSpinLock;
+using Kernel::PageSize;
+
+constexpr u64 HeapAddress = 0x80000000;
+constexpr size_t HeapSize = 64_MiB;
+constexpr size_t NumThreads = 4;
+
+/// Blocks of a page group, with the interface of KPageGroup used by the page caches
+class TestPageGroup {
+public:
+    struct Block {
+        KPhysicalAddress address;
+        size_t num_pages;
+
+        KPhysicalAddress GetAddress() const {
+            return address;
+        }
+        size_t GetNumPages() const {
+            return num_pages;
+        }
+    };
+
+    Result AddBlock(KPhysicalAddress address, size_t num_pages) {
+        m_blocks.push_back({address, num_pages});
+        return ResultSuccess;
+    }
+
+    void Finalize() {
+        m_blocks.clear();
+    }
+
+    size_t GetNumPages() const {
+        size_t num_pages = 0;
+        for (const Block& block : m_blocks) {
+            num_pages += block.num_pages;
+        }
+        return num_pages;
+    }
+
+    auto begin() const {
+        return m_blocks.begin();
+    }
+    auto end() const {
+        return m_blocks.end();
+    }
+    size_t size() const {
+        return m_blocks.size();
+    }
+
+private:
+    std::vector<Block> m_blocks;
+};
+
+/// A pool of a single page heap, the adapter KMemoryManager implements over its managers
+class TestPool {
+public:
+    TestPool() {
+        // The heap keeps its bitmaps in host memory, past any address of the guest.
+        m_heap.Initialize(HeapAddress, HeapSize, Kernel::KVirtualAddress{0xFFFFFF8000000000ULL},
+                          KPageHeap::CalculateManagementOverheadSize(HeapSize));
+        m_heap.Free(HeapAddress, HeapSize / PageSize);
+        m_page_owners = std::make_unique<std::atomic<u8>[]>(HeapSize / PageSize);
+    }
+
+    KSpinLock& GetLock() {
+        return m_lock;
+    }
+
+    bool IsCacheable() {
+        // Counted down to start tracking allocations in the middle of one
+        if (m_cacheable_checks == 0) {
+            return false;
+        }
+        if (m_cacheable_checks > 0) {
+            --m_cacheable_checks;
+        }
+        return true;
+    }
+
+    KPhysicalAddress AllocateBlock(s32 index, bool random) {
+        m_last_random = random;
+        return m_heap.AllocateBlock(index, random);
+    }
+
+    void Free(KPhysicalAddress address, size_t num_pages) {
+        m_heap.Free(address, num_pages);
+    }
+
+    /// Makes IsCacheable return true the given number of times, then false
+    void StopCachingAfter(int num_checks) {
+        m_cacheable_checks = num_checks;
+    }
+
+    size_t GetFreeSize() {
+        KScopedSpinLock lk(m_lock);
+        return m_heap.GetFreeSize();
+    }
+
+    bool GetLastRandom() const {
+        return m_last_random;
+    }
+
+    /// Marks the pages of a group as owned, counting those that already were
+    void Own(const TestPageGroup& group) {
+        for (const auto& block : group) {
+            const size_t first = (block.GetAddress() - HeapAddress) / PageSize;
+            for (size_t i = 0; i < block.GetNumPages(); i++) {
+                if (m_page_owners[first + i].exchange(1) != 0) {
+                    ++m_num_duplicates;
+                }
+            }
+        }
+    }
+
+    void Disown(KPhysicalAddress address, size_t num_pages) {
+        const size_t first = (address - HeapAddress) / PageSize;
+        for (size_t i = 0; i < num_pages; i++) {
+            m_page_owners[first + i].store(0);
+        }
+    }
+
+    size_t GetNumDuplicates() const {
+        return m_num_duplicates.load();
+    }
+
+private:
+    KSpinLock m_lock;
+    KPageHeap m_heap;
+    int m_cacheable_checks{-1};
+    bool m_last_random{};
+    std::unique_ptr<std::atomic<u8>[]> m_page_owners;
+    std::atomic<size_t> m_num_duplicates{};
+};
+
+/// Allocates a page group from the heaps of a locked pool, largest blocks first
+Result AllocateFromHeaps(TestPool& pool, TestPageGroup* out, size_t num_pages) {
+    for (s32 index = KPageHeapCache::NumCachedBlockSizes - 1; index >= 0; index--) {
+        const size_t block_pages = KPageHeap::GetBlockNumPages(index);
+        while (num_pages >= block_pages) {
+            const KPhysicalAddress block = pool.AllocateBlock(index, false);
+            if (block == 0) {
+                for (const auto& allocated : *out) {
+                    pool.Free(allocated.GetAddress(), allocated.GetNumPages());
+                }
+                out->Finalize();
+                return Kernel::ResultOutOfMemory;
+            }
+            R_TRY(out->AddBlock(block, block_pages));
+            num_pages -= block_pages;
+        }
+    }
+    return ResultSuccess;
+}
+
+/// Frees a run of pages like KMemoryManager::Impl::Free, to the cache first
+void FreeRun(TestPool& pool, KPageHeapCache* cache, KPhysicalAddress address, size_t num_pages) {
+    pool.Disown(address, num_pages);
+    if (cache != nullptr) {
+        cache->PushRun(address, num_pages, [](KPhysicalAddress, size_t) {});
+    }
+    if (num_pages > 0) {
+        KScopedSpinLock lk(pool.GetLock());
+        pool.Free(address, num_pages);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("KPageHeapCache[PushPop]", "[kernel]") {
+    KPageHeapCache cache;
+    const size_t large_pages = KPageHeap::GetBlockNumPages(1);
+
+    REQUIRE(cache.Pop(0) == 0);
+    REQUIRE(cache.Push(0, 0x1000));
+    REQUIRE(cache.Push(0, 0x2000));
+    REQUIRE(cache.Push(1, 0x200000));
+    REQUIRE(cache.GetNumCachedPages() == 2 + large_pages);
+
+    // Blocks are reused most recently freed first, and sizes don't mix
+    REQUIRE(cache.Pop(0) == 0x2000);
+    REQUIRE(cache.Pop(1) == 0x200000);
+    REQUIRE(cache.Pop(1) == 0);
+    REQUIRE(cache.GetNumCachedPages() == 1);
+
+    // A full cache refuses blocks
+    for (size_t i = 1; i < KPageHeapCache::Capacity; i++) {
+        REQUIRE(cache.Push(0, 0x1000 + i * PageSize));
+    }
+    REQUIRE(!cache.Push(0, 0x100000));
+    REQUIRE(cache.GetNumCachedPages() == KPageHeapCache::Capacity);
+}
+
+TEST_CASE("KPageHeapCache[Drain]", "[kernel]") {
+    KPageHeapCache cache;
+    const size_t large_pages = KPageHeap::GetBlockNumPages(1);
+
+    REQUIRE(cache.Push(0, 0x1000));
+    REQUIRE(cache.Push(1, 0x200000));
+    REQUIRE(cache.Push(1, 0x400000));
+
+    size_t num_blocks = 0;
+    size_t num_pages = 0;
+    REQUIRE(cache.Drain([&](KPhysicalAddress, size_t block_pages) {
+        ++num_blocks;
+        num_pages += block_pages;
+    }) == 1 + 2 * large_pages);
+    REQUIRE(num_blocks == 3);
+    REQUIRE(num_pages == 1 + 2 * large_pages);
+    REQUIRE(cache.GetNumCachedPages() == 0);
+    REQUIRE(cache.Pop(0) == 0);
+    REQUIRE(cache.Pop(1) == 0);
+}
+
+TEST_CASE("KPageHeapCache[Allocate]", "[kernel]") {
+    TestPool pool;
+    KPageHeapCache cache;
+    const size_t large_pages = KPageHeap::GetBlockNumPages(1);
+
+    // An empty cache is refilled with a batch of blocks, taken the way the caller asked for
+    TestPageGroup group;
+    REQUIRE(cache.Allocate(pool, &group, 3, true));
+    REQUIRE(pool.GetLastRandom());
+    REQUIRE(group.size() == 3);
+    REQUIRE(group.GetNumPages() == 3);
+    REQUIRE(cache.GetNumRefills() == 1);
+    REQUIRE(cache.GetNumCachedPages() == KPageHeapCache::BatchSize - 3);
+    REQUIRE(pool.GetFreeSize() == HeapSize - KPageHeapCache::BatchSize * PageSize);
+
+    // The next allocations are served without refilling
+    TestPageGroup next_group;
+    REQUIRE(cache.Allocate(pool, &next_group, 2, false));
+    REQUIRE(cache.GetNumRefills() == 1);
+
+    // Larger allocations take large blocks first
+    TestPageGroup large_group;
+    REQUIRE(cache.Allocate(pool, &large_group, large_pages + 2, false));
+    REQUIRE(!pool.GetLastRandom());
+    REQUIRE(large_group.size() == 3);
+    REQUIRE(large_group.begin()->GetNumPages() == large_pages);
+    REQUIRE(cache.GetNumRefills() == 2);
+
+    // Allocations too large for the caches are left to the heaps
+    TestPageGroup huge_group;
+    REQUIRE(!cache.Allocate(pool, &huge_group, KPageHeapCache::MaxCachedPages + 1, false));
+    REQUIRE(huge_group.size() == 0);
+}
+
+TEST_CASE("KPageHeapCache[TrackingStarted]", "[kernel]") {
+    TestPool pool;
+    KPageHeapCache cache;
+
+    // Once the pool tracks allocations, neither the cache nor a refill serves them
+    pool.StopCachingAfter(0);
+    TestPageGroup group;
+    REQUIRE(!cache.Allocate(pool, &group, 1, false));
+    REQUIRE(cache.GetNumRefills() == 0);
+
+    // Tracking starting while blocks are taken returns them, the caller allocates under the lock
+    pool.StopCachingAfter(2);
+    REQUIRE(!cache.Allocate(pool, &group, 4, false));
+    REQUIRE(group.size() == 0);
+    REQUIRE(pool.GetFreeSize() + cache.GetNumCachedPages() * PageSize == HeapSize);
+}
+
+TEST_CASE("KPageHeapCache[PushRun]", "[kernel]") {
+    KPageHeapCache cache;
+    const size_t large_pages = KPageHeap::GetBlockNumPages(1);
+
+    // Runs are cached from their start, large blocks first when aligned
+    KPhysicalAddress address = HeapAddress;
+    size_t num_pages = large_pages + 1;
+    size_t num_cached = 0;
+    cache.PushRun(address, num_pages, [&](KPhysicalAddress, size_t) { ++num_cached; });
+    REQUIRE(num_cached == 2);
+    REQUIRE(num_pages == 0);
+    REQUIRE(address == HeapAddress + (large_pages + 1) * PageSize);
+    REQUIRE(cache.GetNumCachedPages() == large_pages + 1);
+
+    // Unaligned runs are cached as single pages until the cache is full
+    address = HeapAddress + PageSize;
+    num_pages = KPageHeapCache::Capacity + 3;
+    cache.PushRun(address, num_pages, [](KPhysicalAddress, size_t) {});
+    REQUIRE(num_pages == 4);
+    REQUIRE(address == HeapAddress + (KPageHeapCache::Capacity) * PageSize);
+
+    // Runs too large for the caches are left alone
+    address = HeapAddress;
+    num_pages = KPageHeapCache::MaxCachedPages + 1;
+    cache.PushRun(address, num_pages, [](KPhysicalAddress, size_t) {});
+    REQUIRE(num_pages == KPageHeapCache::MaxCachedPages + 1);
+}
+
+TEST_CASE("KPageHeapCache[AllocateOrDrain]", "[kernel]") {
+    TestPool pool;
+    std::array<KPageHeapCache, NumThreads> caches;
+
+    // Allocate every page of the heap, filling the caches first
+    {
+        KScopedSpinLock lk(pool.GetLock());
+        size_t cache_index = 0;
+        while (const KPhysicalAddress block = pool.AllocateBlock(1, false)) {
+            while (cache_index < caches.size() && !caches[cache_index].Push(1, block)) {
+                ++cache_index;
+            }
+        }
+        REQUIRE(cache_index == caches.size());
+        REQUIRE(pool.AllocateBlock(0, false) == 0);
+    }
+
+    // An allocation from the heaps runs out of memory, then succeeds from the drained caches
+    KScopedSpinLock lk(pool.GetLock());
+    size_t num_attempts = 0;
+    const Result result = KPageHeapCache::AllocateOrDrain(pool, caches, [&]() -> Result {
+        ++num_attempts;
+        return pool.AllocateBlock(0, false) != 0 ? ResultSuccess : Kernel::ResultOutOfMemory;
+    });
+    REQUIRE(result == ResultSuccess);
+    REQUIRE(num_attempts == 2);
+    for (const auto& cache : caches) {
+        REQUIRE(cache.GetNumCachedPages() == 0);
+    }
+
+    // Nothing to drain, nothing to retry
+    num_attempts = 0;
+    REQUIRE(KPageHeapCache::AllocateOrDrain(pool, caches, [&]() -> Result {
+                ++num_attempts;
+                return Kernel::ResultOutOfMemory;
+            }) == Kernel::ResultOutOfMemory);
+    REQUIRE(num_attempts == 1);
+}
+
+TEST_CASE("KPageHeapCache[ClosePageGroup]", "[kernel]") {
+    // A lock counting how often it is taken
+    struct CountingLock {
+        void Lock() {
+            ++num_locks;
+            is_locked = true;
+        }
+        void Unlock() {
+            is_locked = false;
+        }
+        size_t num_locks{};
+        bool is_locked{};
+    };
+    std::array<CountingLock, 2> locks;
+    const auto get_lock = [&](KPhysicalAddress address) -> CountingLock& {
+        return locks[address < HeapAddress + 16_MiB ? 0 : 1];
+    };
+
+    // Blocks of the same pool are closed under one lock, blocks crossing heaps are split
+    TestPageGroup group;
+    REQUIRE(group.AddBlock(HeapAddress, 4) == ResultSuccess);
+    REQUIRE(group.AddBlock(HeapAddress + 8 * PageSize, 2) == ResultSuccess);
+    REQUIRE(group.AddBlock(HeapAddress + 16_MiB - PageSize, 3) == ResultSuccess);
+    REQUIRE(group.AddBlock(HeapAddress + 8 * PageSize, 1) == ResultSuccess);
+
+    std::vector<std::pair<KPhysicalAddress, size_t>> closed;
+    bool closed_locked = true;
+    const auto close = [&](KPhysicalAddress address, size_t num_pages) {
+        closed_locked = closed_locked && get_lock(address).is_locked;
+        const KPhysicalAddress heap_end = HeapAddress + 16_MiB;
+        const size_t cur_pages =
+            address < heap_end ? std::min(num_pages, (heap_end - address) / PageSize) : num_pages;
+        closed.emplace_back(address, cur_pages);
+        return cur_pages;
+    };
+    KPageHeapCache::ClosePageGroup(group, get_lock, close);
+
+    REQUIRE(closed_locked);
+    REQUIRE(closed.size() == 5);
+    REQUIRE(closed[2] == std::make_pair(KPhysicalAddress{HeapAddress + 16_MiB - PageSize}, 1UL));
+    REQUIRE(closed[3] == std::make_pair(KPhysicalAddress{HeapAddress + 16_MiB}, 2UL));
+    REQUIRE(locks[0].num_locks == 2);
+    REQUIRE(locks[1].num_locks == 1);
+    REQUIRE(!locks[0].is_locked);
+    REQUIRE(!locks[1].is_locked);
+}
+
+TEST_CASE("KPageHeapCache[Stress]", "[kernel]") {
+    TestPool pool;
+    std::array<KPageHeapCache, NumThreads> caches;
+    REQUIRE(pool.GetFreeSize() == HeapSize);
+
+    // Threads allocate and free groups through their caches, while the caches are drained under
+    // them, falling back to the heap like KMemoryManager does
+    std::atomic<bool> failed_allocation{};
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < NumThreads; thread++) {
+        threads.emplace_back([&, thread] {
+            std::mt19937 rng{static_cast<u32>(thread)};
+            std::vector<TestPageGroup> groups;
+            for (int i = 0; i < 20000; i++) {
+                if (groups.size() < 32 && (groups.empty() || rng() % 2 == 0)) {
+                    const size_t num_pages =
+                        rng() % 8 == 0 ? KPageHeap::GetBlockNumPages(1) + rng() % 4 : 1 + rng() % 4;
+                    TestPageGroup group;
+                    if (!caches[thread].Allocate(pool, &group, num_pages, rng() % 2 == 0)) {
+                        KScopedSpinLock lk(pool.GetLock());
+                        if (KPageHeapCache::AllocateOrDrain(pool, caches, [&] {
+                                return AllocateFromHeaps(pool, &group, num_pages);
+                            }) != ResultSuccess) {
+                            failed_allocation = true;
+                            return;
+                        }
+                    }
+                    pool.Own(group);
+                    groups.push_back(std::move(group));
+                } else {
+                    const size_t victim = rng() % groups.size();
+                    for (const auto& block : groups[victim]) {
+                        FreeRun(pool, &caches[thread], block.GetAddress(), block.GetNumPages());
+                    }
+                    groups[victim] = std::move(groups.back());
+                    groups.pop_back();
+                }
+                if (thread == 0 && i % 1000 == 0) {
+                    KScopedSpinLock lk(pool.GetLock());
+                    KPageHeapCache::DrainAll(pool, caches);
+                }
+            }
+            for (const auto& group : groups) {
+                for (const auto& block : group) {
+                    FreeRun(pool, &caches[thread], block.GetAddress(), block.GetNumPages());
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(!failed_allocation);
+    REQUIRE(pool.GetNumDuplicates() == 0);
+
+    // Every page is back in the heap once the caches are drained
+    {
+        KScopedSpinLock lk(pool.GetLock());
+        KPageHeapCache::DrainAll(pool, caches);
+    }
+    REQUIRE(pool.GetFreeSize() == HeapSize);
+}
+
+TEST_CASE("KPageHeapCache[Benchmark]", "[kernel][!benchmark]") {
+    // Several threads allocating and freeing single pages, through their caches or the heap lock
+    const auto run = [](bool use_cache) {
+        TestPool pool;
+        std::array<KPageHeapCache, NumThreads> caches;
+        std::vector<std::thread> threads;
+        for (size_t thread = 0; thread < NumThreads; thread++) {
+            threads.emplace_back([&pool, &caches, thread, use_cache] {
+                KPageHeapCache* const cache = use_cache ? &caches[thread] : nullptr;
+                std::vector<KPhysicalAddress> blocks(16);
+                for (int i = 0; i < 20000; i++) {
+                    for (auto& block : blocks) {
+                        TestPageGroup group;
+                        if (cache == nullptr || !cache->Allocate(pool, &group, 1, false)) {
+                            KScopedSpinLock lk(pool.GetLock());
+                            block = pool.AllocateBlock(0, false);
+                        } else {
+                            block = group.begin()->GetAddress();
+                        }
+                    }
+                    for (const auto block : blocks) {
+                        FreeRun(pool, cache, block, 1);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    BENCHMARK("Per-thread caches") {
+        run(true);
+    };
+    BENCHMARK("Heap lock") {
+        run(false);
+    };
+}
@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <span>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_call.h"
+#include "core/hle/kernel/svc_results.h"
+
+namespace {
+
+using Kernel::Svc::SvcId;
+
+/// Call context of a thread whose calls are handled by a small model of the kernel
+class FakeCallContext {
+public:
+    explicit FakeCallContext(bool is_64bit_, bool is_multicore_ = true, bool is_timed_ = true)
+        : is_64bit{is_64bit_}, is_multicore{is_multicore_}, is_timed{is_timed_} {}
+
+    bool IsMulticore() const {
+        return is_multicore;
+    }
+
+    bool Is64Bit() const {
+        return is_64bit;
+    }
+
+    void SaveSvcArguments(std::span<uint64_t, 8> args) {
+        std::ranges::copy(registers, args.begin());
+    }
+
+    void LoadSvcArguments(std::span<const uint64_t, 8> args) {
+        std::ranges::copy(args, registers.begin());
+    }
+
+    void EnterSVCProfile() {
+        ++profile_depth;
+    }
+
+    void ExitSVCProfile() {
+        --profile_depth;
+    }
+
+    bool IsTimingSupervisorCalls() const {
+        return is_timed;
+    }
+
+    void OnSupervisorCall(u32 imm, bool is_inline, bool is_polling,
+                          std::chrono::steady_clock::time_point,
+                          std::chrono::steady_clock::time_point) {
+        ++num_timed_calls;
+        last_timed_imm = imm;
+        last_timed_inline = is_inline;
+        last_timed_polling = is_polling;
+    }
+
+    void DisableDispatch() {
+        ++dispatch_disable_count;
+    }
+
+    void EnableDispatch() {
+        --dispatch_disable_count;
+    }
+
+    bool NeedsScheduling() {
+        return num_woken_threads != 0;
+    }
+
+    void Dispatch(u32 imm, std::span<uint64_t, 8> args) {
+        ++num_calls;
+        dispatched_with_dispatch_disabled = dispatch_disable_count != 0;
+        switch (static_cast<SvcId>(imm)) {
+        case SvcId::GetSystemTick:
+            tick += 19;
+            if (is_64bit) {
+                args[0] = tick;
+            } else {
+                args[0] = static_cast<u32>(tick);
+                args[1] = static_cast<u32>(tick >> 32);
+            }
+            break;
+        case SvcId::ArbitrateUnlock:
+            if (num_lock_waiters > 0) {
+                --num_lock_waiters;
+                ++num_woken_threads;
+            }
+            args[0] = ResultSuccess.raw;
+            break;
+        case SvcId::SignalProcessWideKey: {
+            const s32 count = static_cast<s32>(args[1]);
+            const u32 woken = count <= 0 ? num_cv_waiters
+                                         : std::min(num_cv_waiters, static_cast<u32>(count));
+            num_cv_waiters -= woken;
+            num_woken_threads += woken;
+            break;
+        }
+        case SvcId::WaitSynchronization:
+            if (signaled_index >= 0) {
+                args[0] = ResultSuccess.raw;
+                args[1] = static_cast<u32>(signaled_index);
+            } else {
+                args[0] = Kernel::ResultTimedOut.raw;
+                args[1] = static_cast<u32>(-1);
+            }
+            break;
+        case SvcId::SleepThread:
+            args[0] = 0;
+            break;
+        default:
+            FAIL("Unexpected supervisor call");
+        }
+    }
+
+    bool is_64bit;
+    bool is_multicore;
+    bool is_timed;
+    std::array<uint64_t, 8> registers{};
+
+    u64 tick{0x1'0000'0000 - 7};
+    u32 num_lock_waiters{};
+    u32 num_cv_waiters{};
+    s32 signaled_index{-1};
+
+    u32 num_calls{};
+    u32 num_woken_threads{};
+    s32 profile_depth{};
+    s32 dispatch_disable_count{};
+    bool dispatched_with_dispatch_disabled{};
+    u32 num_timed_calls{};
+    u32 last_timed_imm{};
+    bool last_timed_inline{};
+    bool last_timed_polling{};
+};
+
+std::array<uint64_t, 8> Registers(u64 seed) {
+    std::array<uint64_t, 8> registers;
+    for (size_t i = 0; i < registers.size(); ++i) {
+        registers[i] = seed * 0x9E3779B97F4A7C15ULL + i;
+    }
+    return registers;
+}
+
+/// Performs the same call on two copies of a context, one through each path, and checks that
+/// both end up in the same state
+void RequireSameAsCall(const FakeCallContext& initial, SvcId id) {
+    const u32 imm = static_cast<u32>(id);
+    FakeCallContext normal = initial;
+    FakeCallContext inlined = initial;
+
+    Kernel::Svc::PerformCall(normal, imm);
+    bool needs_scheduling = false;
+    REQUIRE(Kernel::Svc::PerformCallInline(inlined, imm, &needs_scheduling));
+
+    REQUIRE(inlined.registers == normal.registers);
+    REQUIRE(inlined.tick == normal.tick);
+    REQUIRE(inlined.num_lock_waiters == normal.num_lock_waiters);
+    REQUIRE(inlined.num_cv_waiters == normal.num_cv_waiters);
+    REQUIRE(inlined.num_woken_threads == normal.num_woken_threads);
+    REQUIRE(inlined.num_calls == 1);
+    REQUIRE(normal.num_calls == 1);
+
+    // Only the inline call runs with dispatch disabled, and reports the threads it woke
+    REQUIRE(inlined.dispatched_with_dispatch_disabled);
+    REQUIRE(!normal.dispatched_with_dispatch_disabled);
+    REQUIRE(inlined.dispatch_disable_count == 0);
+    REQUIRE(needs_scheduling == (inlined.num_woken_threads != 0));
+
+    REQUIRE(inlined.profile_depth == 0);
+    REQUIRE(normal.profile_depth == 0);
+    REQUIRE(inlined.num_timed_calls == normal.num_timed_calls);
+    if (initial.is_timed) {
+        REQUIRE(inlined.last_timed_imm == imm);
+        REQUIRE(inlined.last_timed_inline);
+        REQUIRE(!normal.last_timed_inline);
+        REQUIRE(inlined.last_timed_polling == normal.last_timed_polling);
+    }
+}
+
+/// Checks that a call is left to the normal path without touching the thread
+void RequireNotInline(const FakeCallContext& initial, SvcId id) {
+    FakeCallContext context = initial;
+    bool needs_scheduling = false;
+    REQUIRE(!Kernel::Svc::PerformCallInline(context, static_cast<u32>(id), &needs_scheduling));
+    REQUIRE(context.registers == initial.registers);
+    REQUIRE(context.num_calls == 0);
+    REQUIRE(context.profile_depth == 0);
+    REQUIRE(context.num_timed_calls == 0);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SvcCall[GetSystemTick]", "[kernel]") {
+    for (const bool is_64bit : {true, false}) {
+        for (const bool is_timed : {true, false}) {
+            FakeCallContext context{is_64bit, true, is_timed};
+            context.registers = Registers(1);
+            RequireSameAsCall(context, SvcId::GetSystemTick);
+        }
+    }
+}
+
+TEST_CASE("SvcCall[ArbitrateUnlock]", "[kernel]") {
+    for (const bool is_64bit : {true, false}) {
+        for (const u32 num_waiters : {0U, 1U, 3U}) {
+            FakeCallContext context{is_64bit};
+            context.registers = Registers(2);
+            context.num_lock_waiters = num_waiters;
+            RequireSameAsCall(context, SvcId::ArbitrateUnlock);
+        }
+    }
+}
+
+TEST_CASE("SvcCall[SignalProcessWideKey]", "[kernel]") {
+    for (const bool is_64bit : {true, false}) {
+        for (const s32 count : {-1, 1, 2}) {
+            FakeCallContext context{is_64bit};
+            context.registers = Registers(3);
+            context.registers[1] = static_cast<u32>(count);
+            context.num_cv_waiters = 3;
+            RequireSameAsCall(context, SvcId::SignalProcessWideKey);
+        }
+        FakeCallContext context{is_64bit};
+        context.registers = Registers(4);
+        context.registers[1] = 1;
+        RequireSameAsCall(context, SvcId::SignalProcessWideKey);
+    }
+}
+
+TEST_CASE("SvcCall[WaitSynchronization]", "[kernel]") {
+    for (const s32 signaled_index : {-1, 0, 2}) {
+        FakeCallContext context64{true};
+        context64.registers = Registers(5);
+        context64.registers[3] = 0;
+        context64.signaled_index = signaled_index;
+        RequireSameAsCall(context64, SvcId::WaitSynchronization);
+
+        // 32-bit threads pass the timeout split between the first and fourth registers
+        FakeCallContext context32{false};
+        context32.registers = Registers(6);
+        context32.registers[0] = 0xffffffff00000000ULL;
+        context32.registers[3] = 0xffffffff00000000ULL;
+        context32.signaled_index = signaled_index;
+        RequireSameAsCall(context32, SvcId::WaitSynchronization);
+    }
+}
+
+TEST_CASE("SvcCall[NotInline]", "[kernel]") {
+    // Waits that can block
+    FakeCallContext context64{true};
+    context64.registers = Registers(7);
+    context64.registers[3] = 1;
+    RequireNotInline(context64, SvcId::WaitSynchronization);
+    context64.registers[3] = static_cast<u64>(-1);
+    RequireNotInline(context64, SvcId::WaitSynchronization);
+
+    FakeCallContext context32{false};
+    context32.registers = Registers(8);
+    context32.registers[0] = 0;
+    context32.registers[3] = 1;
+    RequireNotInline(context32, SvcId::WaitSynchronization);
+    context32.registers[0] = 1;
+    context32.registers[3] = 0;
+    RequireNotInline(context32, SvcId::WaitSynchronization);
+
+    // Calls that are never made inline
+    RequireNotInline(context64, SvcId::SleepThread);
+    RequireNotInline(context64, SvcId::SendSyncRequest);
+
+    // Single core mode switches threads on the calling host thread
+    FakeCallContext single_core{true, false};
+    single_core.registers = Registers(9);
+    RequireNotInline(single_core, SvcId::GetSystemTick);
+}
+
+TEST_CASE("SvcCall[CanCallInline]", "[kernel]") {
+    const auto can_call_inline = [](SvcId id, std::array<uint64_t, 8> args, bool is_64bit) {
+        return Kernel::Svc::CanCallInline(static_cast<u32>(id), args, is_64bit);
+    };
+    for (const bool is_64bit : {true, false}) {
+        REQUIRE(can_call_inline(SvcId::GetSystemTick, {}, is_64bit));
+        REQUIRE(can_call_inline(SvcId::ArbitrateUnlock, {}, is_64bit));
+        REQUIRE(can_call_inline(SvcId::SignalProcessWideKey, {}, is_64bit));
+        REQUIRE(can_call_inline(SvcId::WaitSynchronization, {}, is_64bit));
+        REQUIRE(!can_call_inline(SvcId::ArbitrateLock, {}, is_64bit));
+        REQUIRE(!can_call_inline(SvcId::WaitProcessWideKeyAtomic, {}, is_64bit));
+        REQUIRE(!can_call_inline(SvcId::SleepThread, {}, is_64bit));
+    }
+    REQUIRE(!can_call_inline(SvcId::WaitSynchronization, {0, 0, 0, 1}, true));
+    REQUIRE(can_call_inline(SvcId::WaitSynchronization, {1, 0, 0, 0}, true));
+    REQUIRE(!can_call_inline(SvcId::WaitSynchronization, {1, 0, 0, 0}, false));
+}
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <memory>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/hle/kernel/svc_statistics.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("SvcStatistics[Summary]", "[core]") {
+    const auto statistics = std::make_unique<Kernel::SvcStatistics>();
+
+    // 98 fast calls spread over cores and 2 slow ones
+    for (u32 i = 0; i < 98; ++i) {
+        statistics->Record(i % 4, 0x1E, i % 2 == 0, 300ns);
+    }
+    statistics->Record(0, 0x1E, false, 5000ns);
+    statistics->Record(3, 0x1E, false, 5000ns);
+    statistics->Record(1, 0x18, false, 1ms);
+
+    const auto summary = statistics->GetSummary(0x1E);
+    REQUIRE(summary.num_calls == 100);
+    REQUIRE(summary.num_inline_calls == 49);
+    REQUIRE(summary.total_time == 98 * 300ns + 2 * 5000ns);
+    REQUIRE(summary.p50 == 512ns);
+    REQUIRE(summary.p99 == 8192ns);
+
+    REQUIRE(statistics->GetSummary(0x18).num_calls == 1);
+    REQUIRE(statistics->GetSummary(0x18).p99 == 1048576ns);
+    REQUIRE(statistics->GetSummary(0x01).num_calls == 0);
+
+    statistics->Reset();
+    REQUIRE(statistics->GetSummary(0x1E).num_calls == 0);
+}
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/memory_snapshot.h"
+
+namespace {
+
+using Core::MemorySnapshot;
+
+constexpr u64 BaseAddress = 0x8000000;
+constexpr std::size_t NumChunks = 8;
+constexpr std::size_t MemorySize = NumChunks * MemorySnapshot::MaxChunkSize;
+
+void Capture(MemorySnapshot& snapshot, std::span<const u8> memory) {
+    for (std::size_t offset = 0; offset < memory.size(); offset += MemorySnapshot::MaxChunkSize) {
+        snapshot.Capture(BaseAddress + offset,
+                         memory.subspan(offset, MemorySnapshot::MaxChunkSize));
+    }
+}
+
+std::size_t Restore(const MemorySnapshot& snapshot, std::span<u8> memory) {
+    std::size_t num_restored = 0;
+    for (std::size_t offset = 0; offset < memory.size(); offset += MemorySnapshot::MaxChunkSize) {
+        if (snapshot.Restore(BaseAddress + offset,
+                             memory.subspan(offset, MemorySnapshot::MaxChunkSize))) {
+            ++num_restored;
+        }
+    }
+    return num_restored;
+}
+
+std::vector<u8> MakeMemory() {
+    std::vector<u8> memory(MemorySize);
+    // Only the first half of the memory holds data
+    for (std::size_t i = 0; i < MemorySize / 2; ++i) {
+        memory[i] = static_cast<u8>(i * 7 + i / 251);
+    }
+    return memory;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MemorySnapshot[Restore]", "[core]") {
+    std::vector<u8> memory = MakeMemory();
+    const std::vector<u8> original = memory;
+
+    MemorySnapshot snapshot;
+    Capture(snapshot, memory);
+
+    const auto statistics = snapshot.GetStatistics();
+    REQUIRE(statistics.num_chunks == NumChunks);
+    REQUIRE(statistics.num_zero_chunks == NumChunks / 2);
+    REQUIRE(statistics.num_shared_chunks == 0);
+    REQUIRE(statistics.captured_size == MemorySize);
+    REQUIRE(statistics.compressed_size < MemorySize / 2);
+
+    // Nothing is written back while memory matches the snapshot
+    REQUIRE(Restore(snapshot, memory) == 0);
+
+    memory[10] = 0xff;
+    memory[MemorySize - 1] = 0xff;
+    REQUIRE(Restore(snapshot, memory) == 2);
+    REQUIRE(memory == original);
+}
+
+TEST_CASE("MemorySnapshot[Incremental]", "[core]") {
+    std::vector<u8> memory = MakeMemory();
+    MemorySnapshot base;
+    Capture(base, memory);
+    const std::vector<u8> base_memory = memory;
+
+    memory[3 * MemorySnapshot::MaxChunkSize + 5] ^= 0xff;
+    memory[6 * MemorySnapshot::MaxChunkSize] = 1;
+    MemorySnapshot incremental(&base);
+    Capture(incremental, memory);
+    const std::vector<u8> incremental_memory = memory;
+
+    const auto statistics = incremental.GetStatistics();
+    REQUIRE(statistics.num_chunks == NumChunks);
+    REQUIRE(statistics.num_shared_chunks == NumChunks - 2);
+    REQUIRE(statistics.num_zero_chunks == NumChunks / 2 - 1);
+    REQUIRE(statistics.compressed_size < base.GetStatistics().compressed_size);
+
+    // Each snapshot restores its own contents, shared chunks included
+    REQUIRE(Restore(base, memory) == 2);
+    REQUIRE(memory == base_memory);
+    REQUIRE(Restore(incremental, memory) == 2);
+    REQUIRE(memory == incremental_memory);
+
+    // Incremental snapshots do not depend on their base once captured
+    memory.assign(MemorySize, 0xcc);
+    {
+        MemorySnapshot moved = std::move(incremental);
+        base = MemorySnapshot{};
+        REQUIRE(Restore(moved, memory) == NumChunks);
+    }
+    REQUIRE(memory == incremental_memory);
+}
@@ -71,6 +71,10 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
               "faster or not.\n200% for a 30 FPS game is 60 FPS, and for a "
               "60 FPS game it will be 120 FPS.\nDisabling it means unlocking the framerate to the "
               "maximum your PC can reach."));
+    INSERT(Settings, reclaim_idle_memory, tr("Reclaim Idle Memory"),
+           tr("Periodically returns emulated memory that the game has left free for a while to "
+              "the system.\nReduces memory use when running several instances at once, at a small "
+              "CPU cost."));
 
     // Cpu
     INSERT(Settings, cpu_accuracy, tr("Accuracy:"),
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <filesystem>
+#include <unistd.h>
+#endif
+
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/perf_stats.h"
+#include "uzuy_cmd/benchmark.h"
+
+namespace {
+
+/// Returns the value below which the given percent of the sorted samples fall
+double Percentile(const std::vector<double>& sorted, double percent) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const double rank = percent / 100.0 * static_cast<double>(sorted.size() - 1);
+    const auto lower = static_cast<std::size_t>(std::floor(rank));
+    const auto upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+}
+
+/// Returns the CPU time spent by each thread of the process
+nlohmann::json GetThreadCpuTimes() {
+    auto threads = nlohmann::json::array();
+#ifdef __linux__
+    const double ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task", ec)) {
+        std::ifstream file(entry.path() / "stat");
+        std::string stat;
+        if (!std::getline(file, stat)) {
+            continue;
+        }
+        // The thread name may contain spaces and parentheses, it ends at the last parenthesis
+        const auto name_begin = stat.find('(');
+        const auto name_end = stat.rfind(')');
+        if (name_begin == std::string::npos || name_end == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(stat.substr(name_end + 2));
+        std::vector<std::string> values;
+        for (std::string value; fields >> value;) {
+            values.push_back(std::move(value));
+        }
+        // Fields start at the state (3rd field), utime and stime are the 14th and 15th fields
+        if (values.size() < 13) {
+            continue;
+        }
+        const double user = std::stod(values[11]) / ticks_per_second;
+        const double kernel = std::stod(values[12]) / ticks_per_second;
+        threads.push_back({
+            {"tid", std::stol(entry.path().filename().string())},
+            {"name", stat.substr(name_begin + 1, name_end - name_begin - 1)},
+            {"user_seconds", user},
+            {"system_seconds", kernel},
+        });
+    }
+#endif
+    return threads;
+}
+
+} // Anonymous namespace
+
+Benchmark::Benchmark(Core::System& system_, BenchmarkOptions options_)
+    : system{system_}, options{std::move(options_)} {}
+
+bool Benchmark::IsFirstFramePresented() const {
+    return system.GetPerfStats().GetSystemFrameCount() != 0;
+}
+
+void Benchmark::Start() {
+    const Core::PerfStats& perf_stats = system.GetPerfStats();
+    is_started = true;
+    start_time = Clock::now();
+    start_emulated_time = system.CoreTiming().GetGlobalTimeUs();
+    start_frame = perf_stats.GetSystemFrameCount();
+    start_game_frames = perf_stats.GetTotalGameFrames();
+    LOG_INFO(Frontend, "Benchmark started");
+}
+
+bool Benchmark::IsDone() const {
+    if (!is_started) {
+        return false;
+    }
+    if (options.frames != 0 &&
+        system.GetPerfStats().GetSystemFrameCount() - start_frame >= options.frames) {
+        return true;
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start_time;
+    return options.seconds != 0.0 && elapsed.count() >= options.seconds;
+}
+
+bool Benchmark::WriteReport() const {
+    if (!is_started) {
+        LOG_ERROR(Frontend, "Benchmark ended before the first frame was presented");
+        return false;
+    }
+    const Core::PerfStats& perf_stats = system.GetPerfStats();
+    const std::chrono::duration<double> elapsed = Clock::now() - start_time;
+    const std::chrono::duration<double> emulated =
+        system.CoreTiming().GetGlobalTimeUs() - start_emulated_time;
+    const u64 game_frames = perf_stats.GetTotalGameFrames() - start_game_frames;
+
+    const std::vector<double> frametimes = perf_stats.GetFrametimes(start_frame);
+    std::vector<double> sorted = frametimes;
+    std::ranges::sort(sorted);
+    const double mean =
+        sorted.empty() ? 0.0
+                       : std::accumulate(sorted.begin(), sorted.end(), 0.0) /
+                             static_cast<double>(sorted.size());
+
+    const nlohmann::json report{
+        {"build", fmt::format("{}-{}", Common::g_scm_branch, Common::g_scm_desc)},
+        {"program_id", fmt::format("{:016X}", system.GetApplicationProcessProgramID())},
+        {"renderer", Settings::values.renderer_backend.ToString()},
+        {"wall_seconds", elapsed.count()},
+        {"emulated_seconds", emulated.count()},
+        {"emulation_speed", elapsed.count() > 0.0 ? emulated.count() / elapsed.count() : 0.0},
+        {"system_frames", frametimes.size()},
+        {"game_frames", game_frames},
+        {"game_fps", elapsed.count() > 0.0 ? static_cast<double>(game_frames) / elapsed.count()
+                                           : 0.0},
+        {"frametime_ms",
+         {
+             {"mean", mean},
+             {"min", sorted.empty() ? 0.0 : sorted.front()},
+             {"max", sorted.empty() ? 0.0 : sorted.back()},
+             {"p50", Percentile(sorted, 50.0)},
+             {"p90", Percentile(sorted, 90.0)},
+             {"p99", Percentile(sorted, 99.0)},
+             {"p99_9", Percentile(sorted, 99.9)},
+         }},
+        {"frametimes_ms", frametimes},
+        {"threads", GetThreadCpuTimes()},
+    };
+
+    std::ofstream file(options.output_path);
+    if (!file.is_open()) {
+        LOG_ERROR(Frontend, "Failed to open benchmark report {}", options.output_path);
+        return false;
+    }
+    file << std::setw(4) << report << std::endl;
+    LOG_INFO(Frontend, "Benchmark finished: {} frames, {:.2f} game FPS, p99 frametime {:.2f} ms",
+             frametimes.size(), report["game_fps"].get<double>(), Percentile(sorted, 99.0));
+    return true;
+}
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+struct BenchmarkOptions {
+    /// Path of the JSON report
+    std::string output_path;
+    /// Number of system frames to run for, 0 to not limit the frames
+    u64 frames = 0;
+    /// Walltime to run for in seconds, 0 to not limit the time
+    double seconds = 0.0;
+};
+
+/**
+ * Measures a headless run and writes frametimes, their percentiles, emulated FPS and CPU time per
+ * host thread to a JSON report.
+ */
+class Benchmark {
+public:
+    explicit Benchmark(Core::System& system_, BenchmarkOptions options_);
+
+    /// Returns true once the title presented its first frame, loading before it is not measured
+    [[nodiscard]] bool IsFirstFramePresented() const;
+
+    /// Starts measuring, frames presented before this are ignored
+    void Start();
+
+    /// Returns true when the requested number of frames or time has been reached
+    [[nodiscard]] bool IsDone() const;
+
+    /// Writes the report, returns false when it could not be written
+    bool WriteReport() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Core::System& system;
+    BenchmarkOptions options;
+
+    bool is_started = false;
+    Clock::time_point start_time;
+    std::chrono::microseconds start_emulated_time{};
+    std::size_t start_frame = 0;
+    u64 start_game_frames = 0;
+};
@@ -31,7 +31,8 @@ public:
     bool IsShown() const override;
 
     /// Wait for the next event on the main thread.
-    void WaitEvent();
+    /// Returns early without handling an event if timeout_ms is not negative and elapses.
+    void WaitEvent(int timeout_ms = -1);
 
     // Sets the window icon from uzuy.bmp
     void SetWindowIcon();
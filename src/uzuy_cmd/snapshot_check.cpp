@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/snapshot.h"
+#include "uzuy_cmd/emu_window/emu_window_sdl2.h"
+#include "uzuy_cmd/snapshot_check.h"
+
+namespace {
+
+/// Lets the title run for interval, returns false if the window was closed meanwhile
+bool RunFor(EmuWindow_SDL2& window, std::chrono::seconds interval) {
+    const auto end_time = std::chrono::steady_clock::now() + interval;
+    while (window.IsOpen() && std::chrono::steady_clock::now() < end_time) {
+        window.WaitEvent(100);
+    }
+    return window.IsOpen();
+}
+
+} // Anonymous namespace
+
+bool RunSnapshotCheck(Core::System& system, EmuWindow_SDL2& window,
+                      std::chrono::seconds interval) {
+    if (!RunFor(window, interval)) {
+        return false;
+    }
+    system.Pause();
+    const auto base = Core::Snapshot::Create(system);
+    system.Run();
+    if (!base || !RunFor(window, interval)) {
+        return false;
+    }
+
+    system.Pause();
+    const auto delta = Core::Snapshot::Create(system, base.get());
+    const auto delta_statistics = delta->GetMemory().GetStatistics();
+    LOG_INFO(Frontend, "Snapshot check: {} of {} chunks dirtied in {} s, {} bytes compressed",
+             delta_statistics.num_chunks - delta_statistics.num_shared_chunks,
+             delta_statistics.num_chunks, interval.count(), delta_statistics.compressed_size);
+
+    // Once restored, every chunk has to match the first snapshot again
+    bool success = base->Restore(system);
+    if (success) {
+        const auto restored = Core::Snapshot::Create(system, base.get());
+        const auto statistics = restored->GetMemory().GetStatistics();
+        success = statistics.num_shared_chunks == statistics.num_chunks;
+        if (!success) {
+            LOG_ERROR(Frontend, "Snapshot check: {} chunks differ after restoring",
+                      statistics.num_chunks - statistics.num_shared_chunks);
+        }
+    }
+    system.Run();
+    LOG_INFO(Frontend, "Snapshot check {}", success ? "passed" : "failed");
+    return success;
+}
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+
+namespace Core {
+class System;
+}
+
+class EmuWindow_SDL2;
+
+/**
+ * Checks that the running title can be snapshotted and restored. It runs for interval, is
+ * snapshotted, runs for interval again and is snapshotted incrementally to measure the pages it
+ * dirtied. The first snapshot is then restored, and memory has to match it again before the title
+ * resumes. Meant for headless runs under the null renderer.
+ *
+ * Returns false if the window was closed early or the check failed.
+ */
+bool RunSnapshotCheck(Core::System& system, EmuWindow_SDL2& window,
+                      std::chrono::seconds interval);
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
 #include <thread>
@@ -11,6 +12,7 @@
 #include <fmt/ostream.h>
 
 #include "common/detached_tasks.h"
+#include "common/fs/path_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -20,6 +22,7 @@
 #include "common/settings.h"
 #include "common/string_util.h"
 #include "common/telemetry.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/cpu_manager.h"
@@ -31,14 +34,17 @@
 #include "core/loader/loader.h"
 #include "core/telemetry_session.h"
 #include "frontend_common/config.h"
+#include "input_common/drivers/tas_input.h"
 #include "input_common/main.h"
 #include "network/network.h"
 #include "sdl_config.h"
 #include "video_core/renderer_base.h"
+#include "uzuy_cmd/benchmark.h"
 #include "uzuy_cmd/emu_window/emu_window_sdl2.h"
 #include "uzuy_cmd/emu_window/emu_window_sdl2_gl.h"
 #include "uzuy_cmd/emu_window/emu_window_sdl2_null.h"
 #include "uzuy_cmd/emu_window/emu_window_sdl2_vk.h"
+#include "uzuy_cmd/snapshot_check.h"
 
 #ifdef _WIN32
 // windows.h needs to be included before shellapi.h
@@ -71,6 +77,9 @@ __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
 static void PrintHelp(const char* argv0) {
     std::cout << "Usage: " << argv0
               << " [options] <filename>\n"
+                 "-b, --benchmark=file  Run a benchmark and write frametime statistics to file\n"
+                 "-n, --benchmark-frames=count   Stop the benchmark after count frames\n"
+                 "-s, --benchmark-seconds=count  Stop the benchmark after count seconds (60)\n"
                  "-c, --config          Load the specified configuration file\n"
                  "-f, --fullscreen      Start in fullscreen mode\n"
                  "-g, --game            File path of the game to load\n"
@@ -78,6 +87,10 @@ static void PrintHelp(const char* argv0) {
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
                  "-p, --program         Pass following string as arguments to executable\n"
+                 "-S, --snapshot-check=seconds  Snapshot the title after seconds, restore it "
+                 "seconds later and check its memory\n"
+                 "-T, --tas=directory   Play the TAS scripts in directory from boot\n"
+                 "-t, --trace <file>    Capture a Chrome trace event file of the session to file\n"
                  "-u, --user            Select a specific user profile from 0 to 7\n"
                  "-v, --version         Output version information and exit\n";
 }
@@ -194,7 +207,6 @@ int main(int argc, char** argv) {
 
     Common::Log::Initialize();
     Common::Log::SetColorConsoleBackendEnabled(true);
-    Common::Log::Start();
     Common::DetachedTasks detached_tasks;
 
     int option_index = 0;
@@ -211,6 +223,16 @@ int main(int argc, char** argv) {
     std::optional<std::string> config_path;
     std::string program_args;
     std::optional<int> selected_user;
+    std::optional<std::string> trace_path;
+    std::optional<std::string> tas_path;
+    std::optional<std::chrono::seconds> snapshot_check_interval;
+    std::optional<BenchmarkOptions> benchmark_options;
+    const auto get_benchmark_options = [&benchmark_options]() -> BenchmarkOptions& {
+        if (!benchmark_options) {
+            benchmark_options.emplace();
+        }
+        return *benchmark_options;
+    };
 
     bool use_multiplayer = false;
     bool fullscreen = false;
@@ -221,12 +243,18 @@ int main(int argc, char** argv) {
 
     static struct option long_options[] = {
         // clang-format off
+        {"benchmark", required_argument, 0, 'b'},
+        {"benchmark-frames", required_argument, 0, 'n'},
+        {"benchmark-seconds", required_argument, 0, 's'},
         {"config", required_argument, 0, 'c'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"game", required_argument, 0, 'g'},
         {"multiplayer", required_argument, 0, 'm'},
         {"program", optional_argument, 0, 'p'},
+        {"snapshot-check", required_argument, 0, 'S'},
+        {"tas", required_argument, 0, 'T'},
+        {"trace", required_argument, 0, 't'},
         {"user", required_argument, 0, 'u'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -234,9 +262,24 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:fhvp::c:u:", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:fhvp::c:u:t:b:n:s:S:T:", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
+            case 'b':
+                get_benchmark_options().output_path = optarg;
+                break;
+            case 'n':
+                get_benchmark_options().frames = std::strtoull(optarg, nullptr, 0);
+                break;
+            case 's':
+                get_benchmark_options().seconds = std::strtod(optarg, nullptr);
+                break;
+            case 'S':
+                snapshot_check_interval = std::chrono::seconds{std::strtoll(optarg, nullptr, 0)};
+                break;
+            case 'T':
+                tas_path = optarg;
+                break;
             case 'c':
                 config_path = optarg;
                 break;
@@ -289,6 +332,9 @@ int main(int argc, char** argv) {
                 program_args = argv[optind];
                 ++optind;
                 break;
+            case 't':
+                trace_path = optarg;
+                break;
             case 'u':
                 selected_user = atoi(optarg);
                 break;
@@ -313,6 +359,8 @@ int main(int argc, char** argv) {
     Common::Log::Filter filter;
     filter.ParseFilterString(Settings::values.log_filter.GetValue());
     Common::Log::SetGlobalFilter(filter);
+    // the logger thread reads the deferred and binary logging settings when it starts
+    Common::Log::Start();
 
     if (!program_args.empty()) {
         Settings::values.program_args = program_args;
@@ -322,6 +370,24 @@ int main(int argc, char** argv) {
         Settings::values.current_user = std::clamp(*selected_user, 0, 7);
     }
 
+    if (tas_path) {
+        Common::FS::SetUzuyPath(Common::FS::UzuyPath::TASDir, *tas_path);
+        Settings::values.tas_enable = true;
+    }
+
+    if (benchmark_options) {
+        if (benchmark_options->output_path.empty()) {
+            std::cout << "--benchmark requires the path of the report\n";
+            PrintHelp(argv[0]);
+            return -1;
+        }
+        if (benchmark_options->frames == 0 && benchmark_options->seconds <= 0.0) {
+            benchmark_options->seconds = 60.0;
+        }
+        // Frametimes are measured from the presented frames, do not let the limiter skew them
+        Settings::values.use_speed_limit = false;
+    }
+
 #ifdef _WIN32
     LocalFree(argv_w);
 #endif
@@ -338,6 +404,15 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (trace_path) {
+        Common::Trace::Start();
+    }
+    const auto write_trace = [&trace_path] {
+        if (trace_path) {
+            Common::Trace::StopAndWrite(*trace_path);
+        }
+    };
+
     Core::System system{};
     system.Initialize();
 
@@ -430,8 +505,17 @@ int main(int argc, char** argv) {
             [](VideoCore::LoadCallbackStage, size_t value, size_t total) {});
     }
 
+    std::optional<Benchmark> benchmark;
+    if (benchmark_options) {
+        benchmark.emplace(system, *benchmark_options);
+    }
+
     system.RegisterExitCallback([&] {
         // Just exit right away.
+        if (benchmark) {
+            benchmark->WriteReport();
+        }
+        write_trace();
         exit(0);
     });
 
@@ -439,21 +523,42 @@ int main(int argc, char** argv) {
     Common::Linux::StartGamemode();
 #endif
 
+    if (tas_path) {
+        input_subsystem.GetTas()->Reset();
+        input_subsystem.GetTas()->StartStop();
+    }
+
     void(system.Run());
     if (system.DebuggerEnabled()) {
         system.InitializeDebugger();
     }
-    while (emu_window->IsOpen()) {
-        emu_window->WaitEvent();
+    const bool snapshot_check_failed =
+        snapshot_check_interval && !RunSnapshotCheck(system, *emu_window, *snapshot_check_interval);
+    bool benchmark_failed = false;
+    if (benchmark) {
+        // Loading is not measured, the benchmark starts with the first presented frame
+        while (emu_window->IsOpen() && !benchmark->IsFirstFramePresented()) {
+            emu_window->WaitEvent(1);
+        }
+        benchmark->Start();
+        while (emu_window->IsOpen() && !benchmark->IsDone()) {
+            emu_window->WaitEvent(100);
+        }
+        benchmark_failed = !benchmark->WriteReport();
+    } else {
+        while (emu_window->IsOpen()) {
+            emu_window->WaitEvent();
+        }
     }
     system.DetachDebugger();
     void(system.Pause());
     system.ShutdownMainProcess();
+    write_trace();
 
 #ifdef __unix__
     Common::Linux::StopGamemode();
 #endif
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return benchmark_failed || snapshot_check_failed ? -1 : 0;
 }
@@ -533,9 +533,7 @@ void BufferCache<P>::CommitAsyncFlushesHigh() {
         auto& current_intervals = *it;
         auto next_it = std::next(it);
         while (next_it != committed_gpu_modified_ranges.end()) {
-            next_it->ForEach([&current_intervals](DAddr start, DAddr end) {
-                current_intervals.Subtract(start, end - start);
-            });
+            current_intervals.Subtract(*next_it);
             next_it++;
         }
         it++;
@@ -1,7 +1,11 @@
 // SPDX-FileCopyrightText: Copyright 2018 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+#include <cstring>
+
 #include "common/algorithm.h"
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -16,10 +20,12 @@
 #include "video_core/textures/decoders.h"
 
 MICROPROFILE_DECLARE(GPU_DMAEngine);
+MICROPROFILE_DECLARE(GPU_DMAEngineLL);
 MICROPROFILE_DECLARE(GPU_DMAEngineBL);
 MICROPROFILE_DECLARE(GPU_DMAEngineLB);
 MICROPROFILE_DECLARE(GPU_DMAEngineBB);
 MICROPROFILE_DEFINE(GPU_DMAEngine, "GPU", "DMA Engine", MP_RGB(224, 224, 128));
+MICROPROFILE_DEFINE(GPU_DMAEngineLL, "GPU", "DMA Engine Linear - Linear", MP_RGB(224, 224, 128));
 MICROPROFILE_DEFINE(GPU_DMAEngineBL, "GPU", "DMA Engine Block - Linear", MP_RGB(224, 224, 128));
 MICROPROFILE_DEFINE(GPU_DMAEngineLB, "GPU", "DMA Engine Linear - Block", MP_RGB(224, 224, 128));
 MICROPROFILE_DEFINE(GPU_DMAEngineBB, "GPU", "DMA Engine Block - Block", MP_RGB(224, 224, 128));
@@ -28,6 +34,16 @@ namespace Tegra::Engines {
 
 using namespace Texture;
 
+namespace {
+/// Block linear swizzling only permutes address bits 4 to 8 within 512 byte windows
+constexpr u64 SWIZZLE_WINDOW_SIZE = 512;
+
+constexpr u64 ConvertLinearToBlockLinearAddr(u64 address) {
+    return (address & ~0x1f0ULL) | ((address & 0x40) >> 2) | ((address & 0x10) << 1) |
+           ((address & 0x180) >> 1) | ((address & 0x20) << 3);
+}
+} // Anonymous namespace
+
 MaxwellDMA::MaxwellDMA(Core::System& system_, MemoryManager& memory_manager_)
     : system{system_}, memory_manager{memory_manager_} {
     execution_mask.reset();
@@ -87,13 +103,8 @@ void MaxwellDMA::Launch() {
         }
 
         if (is_src_pitch && is_dst_pitch) {
-            for (u32 line = 0; line < regs.line_count; ++line) {
-                const GPUVAddr source_line =
-                    regs.offset_in + static_cast<size_t>(line) * regs.pitch_in;
-                const GPUVAddr dest_line =
-                    regs.offset_out + static_cast<size_t>(line) * regs.pitch_out;
-                memory_manager.CopyBlock(dest_line, source_line, regs.line_length_in);
-            }
+            MICROPROFILE_SCOPE(GPU_DMAEngineLL);
+            CopyPitchToPitch();
         } else {
             if (!is_src_pitch && is_dst_pitch) {
                 MICROPROFILE_SCOPE(GPU_DMAEngineBL);
@@ -119,39 +130,15 @@ void MaxwellDMA::Launch() {
                                             regs.line_length_in * sizeof(u32));
         } else {
             memory_manager.FlushCaching();
-            const auto convert_linear_2_blocklinear_addr = [](u64 address) {
-                return (address & ~0x1f0ULL) | ((address & 0x40) >> 2) | ((address & 0x10) << 1) |
-                       ((address & 0x180) >> 1) | ((address & 0x20) << 3);
-            };
             const auto src_kind = memory_manager.GetPageKind(regs.offset_in);
             const auto dst_kind = memory_manager.GetPageKind(regs.offset_out);
             const bool is_src_pitch = IsPitchKind(src_kind);
             const bool is_dst_pitch = IsPitchKind(dst_kind);
-            if (!is_src_pitch && is_dst_pitch) {
-                UNIMPLEMENTED_IF(regs.line_length_in % 16 != 0);
-                UNIMPLEMENTED_IF(regs.offset_in % 16 != 0);
-                UNIMPLEMENTED_IF(regs.offset_out % 16 != 0);
-                read_buffer.resize_destructive(16);
-                for (u32 offset = 0; offset < regs.line_length_in; offset += 16) {
-                    Tegra::Memory::GpuGuestMemoryScoped<
-                        u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
-                        tmp_write_buffer(memory_manager,
-                                         convert_linear_2_blocklinear_addr(regs.offset_in + offset),
-                                         16, &read_buffer);
-                    tmp_write_buffer.SetAddressAndSize(regs.offset_out + offset, 16);
-                }
-            } else if (is_src_pitch && !is_dst_pitch) {
+            if (is_src_pitch != is_dst_pitch) {
                 UNIMPLEMENTED_IF(regs.line_length_in % 16 != 0);
                 UNIMPLEMENTED_IF(regs.offset_in % 16 != 0);
                 UNIMPLEMENTED_IF(regs.offset_out % 16 != 0);
-                read_buffer.resize_destructive(16);
-                for (u32 offset = 0; offset < regs.line_length_in; offset += 16) {
-                    Tegra::Memory::GpuGuestMemoryScoped<
-                        u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
-                        tmp_write_buffer(memory_manager, regs.offset_in + offset, 16, &read_buffer);
-                    tmp_write_buffer.SetAddressAndSize(
-                        convert_linear_2_blocklinear_addr(regs.offset_out + offset), 16);
-                }
+                CopySwizzledLine(!is_src_pitch);
             } else {
                 if (!accelerate.BufferCopy(regs.offset_in, regs.offset_out, regs.line_length_in)) {
                     Tegra::Memory::GpuGuestMemoryScoped<
@@ -167,6 +154,98 @@ void MaxwellDMA::Launch() {
     ReleaseSemaphore();
 }
 
+void MaxwellDMA::CopyPitchToPitch() {
+    const u32 line_length = regs.line_length_in;
+    const u32 line_count = regs.line_count;
+    const s64 pitch_in = regs.pitch_in;
+    const s64 pitch_out = regs.pitch_out;
+    if (line_count == 0) {
+        return;
+    }
+    if (line_count == 1 || (pitch_in == line_length && pitch_out == line_length)) {
+        // Contiguous lines, copy them at once and let the buffer cache handle it if it owns them
+        const u64 size = static_cast<u64>(line_length) * line_count;
+        auto& accelerate = rasterizer->AccessAccelerateDMA();
+        if (!accelerate.BufferCopy(regs.offset_in, regs.offset_out, size)) {
+            memory_manager.CopyBlock(regs.offset_out, regs.offset_in, size);
+        }
+        return;
+    }
+    const u64 src_size = static_cast<u64>(pitch_in) * (line_count - 1) + line_length;
+    const u64 dst_size = static_cast<u64>(pitch_out) * (line_count - 1) + line_length;
+    const bool is_strided = pitch_in >= line_length && pitch_out >= line_length;
+    // Reading the gaps between source lines only pays off while they are small
+    const bool is_dense = src_size <= 2 * static_cast<u64>(line_length) * line_count;
+    const GPUVAddr src_addr = regs.offset_in;
+    const GPUVAddr dst_addr = regs.offset_out;
+    const bool regions_overlap = src_addr < dst_addr + dst_size && dst_addr < src_addr + src_size;
+    if (!is_strided || !is_dense || regions_overlap) {
+        for (u32 line = 0; line < line_count; ++line) {
+            const GPUVAddr source_line = regs.offset_in + static_cast<size_t>(line) * regs.pitch_in;
+            const GPUVAddr dest_line = regs.offset_out + static_cast<size_t>(line) * regs.pitch_out;
+            memory_manager.CopyBlock(dest_line, source_line, line_length);
+        }
+        return;
+    }
+    // Read all source lines at once, then write each line on its own so that the bytes between
+    // destination lines are left untouched
+    Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::SafeRead> tmp_read_buffer(
+        memory_manager, src_addr, src_size, &read_buffer);
+    for (u32 line = 0; line < line_count; ++line) {
+        memory_manager.WriteBlock(dst_addr + static_cast<size_t>(line * pitch_out),
+                                  &tmp_read_buffer[static_cast<size_t>(line * pitch_in)],
+                                  line_length);
+    }
+}
+
+void MaxwellDMA::CopySwizzledLine(bool from_block_linear) {
+    const u32 length = regs.line_length_in;
+    const GPUVAddr block_linear_addr = from_block_linear ? regs.offset_in : regs.offset_out;
+    const GPUVAddr pitch_addr = from_block_linear ? regs.offset_out : regs.offset_in;
+    const GPUVAddr window_start = Common::AlignDown(block_linear_addr, SWIZZLE_WINDOW_SIZE);
+    const GPUVAddr window_end = Common::AlignUp(block_linear_addr + length, SWIZZLE_WINDOW_SIZE);
+    const size_t window_size = window_end - window_start;
+    const bool regions_overlap = pitch_addr < window_end && window_start < pitch_addr + length;
+    if (regions_overlap) {
+        read_buffer.resize_destructive(16);
+        for (u32 offset = 0; offset < length; offset += 16) {
+            GPUVAddr src_addr = regs.offset_in + offset;
+            GPUVAddr dst_addr = regs.offset_out + offset;
+            if (from_block_linear) {
+                src_addr = ConvertLinearToBlockLinearAddr(src_addr);
+            } else {
+                dst_addr = ConvertLinearToBlockLinearAddr(dst_addr);
+            }
+            Tegra::Memory::GpuGuestMemoryScoped<
+                u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
+                tmp_write_buffer(memory_manager, src_addr, 16, &read_buffer);
+            tmp_write_buffer.SetAddressAndSize(dst_addr, 16);
+        }
+        return;
+    }
+    // Read and write the whole line once, swizzling the 16 byte chunks in host memory
+    if (from_block_linear) {
+        Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::SafeRead>
+            tmp_read_buffer(memory_manager, window_start, window_size, &read_buffer);
+        write_buffer.resize_destructive(length);
+        for (u32 offset = 0; offset < length; offset += 16) {
+            const GPUVAddr src_addr = ConvertLinearToBlockLinearAddr(regs.offset_in + offset);
+            std::memcpy(&write_buffer[offset], &tmp_read_buffer[src_addr - window_start], 16);
+        }
+        memory_manager.WriteBlockCached(regs.offset_out, write_buffer.data(), length);
+    } else {
+        Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::SafeRead>
+            tmp_read_buffer(memory_manager, regs.offset_in, length, &read_buffer);
+        Tegra::Memory::GpuGuestMemoryScoped<u8,
+                                            Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
+            tmp_write_buffer(memory_manager, window_start, window_size, &write_buffer);
+        for (u32 offset = 0; offset < length; offset += 16) {
+            const GPUVAddr dst_addr = ConvertLinearToBlockLinearAddr(regs.offset_out + offset);
+            std::memcpy(&tmp_write_buffer[dst_addr - window_start], &tmp_read_buffer[offset], 16);
+        }
+    }
+}
+
 void MaxwellDMA::CopyBlockLinearToPitch() {
     UNIMPLEMENTED_IF(regs.launch_dma.remap_enable != 0);
 
@@ -339,16 +418,28 @@ void MaxwellDMA::CopyBlockLinearToBlockLinear() {
     const size_t dst_size = CalculateSize(true, bytes_per_pixel, dst_width, dst.height, dst.depth,
                                           dst.block_size.height, dst.block_size.depth);
 
-    const u32 pitch = x_elements * bytes_per_pixel;
-    const size_t mid_buffer_size = pitch * regs.line_count;
-
-    intermediate_buffer.resize_destructive(mid_buffer_size);
-
     Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::SafeRead> tmp_read_buffer(
         memory_manager, regs.offset_in, src_size, &read_buffer);
     Tegra::Memory::GpuGuestMemoryScoped<u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
         tmp_write_buffer(memory_manager, regs.offset_out, dst_size, &write_buffer);
 
+    const bool fits_first_slice = src.origin.y + regs.line_count <= src.height &&
+                                  dst.origin.y + regs.line_count <= dst.height;
+    if (fits_first_slice && std::has_single_bit(bytes_per_pixel)) {
+        // Copy between the two tiled layouts directly, without a linear staging buffer
+        CopyBlockLinearSubrect(tmp_write_buffer, tmp_read_buffer, bytes_per_pixel, src_width,
+                               src_x_offset, src.origin.y, src.block_size.height,
+                               src.block_size.depth, dst_width, dst_x_offset, dst.origin.y,
+                               dst.block_size.height, dst.block_size.depth, x_elements,
+                               regs.line_count);
+        return;
+    }
+
+    const u32 pitch = x_elements * bytes_per_pixel;
+    const size_t mid_buffer_size = pitch * regs.line_count;
+
+    intermediate_buffer.resize_destructive(mid_buffer_size);
+
     UnswizzleSubrect(intermediate_buffer, tmp_read_buffer, bytes_per_pixel, src_width, src.height,
                      src.depth, src_x_offset, src.origin.y, x_elements, regs.line_count,
                      src.block_size.height, src.block_size.depth, pitch);
@@ -253,6 +253,11 @@ private:
     /// registers.
     void Launch();
 
+    void CopyPitchToPitch();
+
+    /// Copies a single line between pitch and block linear memory, swizzling 16 byte chunks
+    void CopySwizzledLine(bool from_block_linear);
+
     void CopyBlockLinearToPitch();
 
     void CopyPitchToBlockLinear();
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <vector>
 
+#include "common/assert.h"
 #include "common/scratch_buffer.h"
 #include "video_core/engines/sw_blitter/blitter.h"
 #include "video_core/engines/sw_blitter/converter.h"
@@ -28,39 +29,53 @@ namespace {
 
 constexpr size_t ir_components = 4;
 
+template <size_t bpp>
 void NearestNeighbor(std::span<const u8> input, std::span<u8> output, u32 src_width, u32 src_height,
-                     u32 dst_width, u32 dst_height, size_t bpp) {
+                     u32 dst_width, u32 dst_height) {
+    const size_t src_pitch = static_cast<size_t>(src_width) * bpp;
+    const size_t dst_pitch = static_cast<size_t>(dst_width) * bpp;
     const size_t dx_du = std::llround((static_cast<f64>(src_width) / dst_width) * (1ULL << 32));
     const size_t dy_dv = std::llround((static_cast<f64>(src_height) / dst_height) * (1ULL << 32));
     size_t src_y = 0;
+    size_t last_row = ~size_t{0};
     for (u32 y = 0; y < dst_height; y++) {
+        const size_t row = src_y >> 32;
+        u8* const write_row = &output[y * dst_pitch];
+        src_y += dy_dv;
+        if (row == last_row) {
+            // Integer vertical upscales repeat rows, copy the already scaled one
+            std::memcpy(write_row, write_row - dst_pitch, dst_pitch);
+            continue;
+        }
+        last_row = row;
+        const u8* const read_row = &input[row * src_pitch];
+        if (src_width == dst_width) {
+            std::memcpy(write_row, read_row, dst_pitch);
+            continue;
+        }
         size_t src_x = 0;
         for (u32 x = 0; x < dst_width; x++) {
-            const size_t read_from = ((src_y * src_width + src_x) >> 32) * bpp;
-            const size_t write_to = (y * dst_width + x) * bpp;
-
-            std::memcpy(&output[write_to], &input[read_from], bpp);
+            std::memcpy(&write_row[x * bpp], &read_row[(src_x >> 32) * bpp], bpp);
             src_x += dx_du;
         }
-        src_y += dy_dv;
     }
 }
 
-void NearestNeighborFast(std::span<const f32> input, std::span<f32> output, u32 src_width,
-                         u32 src_height, u32 dst_width, u32 dst_height) {
-    const size_t dx_du = std::llround((static_cast<f64>(src_width) / dst_width) * (1ULL << 32));
-    const size_t dy_dv = std::llround((static_cast<f64>(src_height) / dst_height) * (1ULL << 32));
-    size_t src_y = 0;
-    for (u32 y = 0; y < dst_height; y++) {
-        size_t src_x = 0;
-        for (u32 x = 0; x < dst_width; x++) {
-            const size_t read_from = ((src_y * src_width + src_x) >> 32) * ir_components;
-            const size_t write_to = (y * dst_width + x) * ir_components;
-
-            std::memcpy(&output[write_to], &input[read_from], sizeof(f32) * ir_components);
-            src_x += dx_du;
-        }
-        src_y += dy_dv;
+void NearestNeighbor(std::span<const u8> input, std::span<u8> output, u32 src_width, u32 src_height,
+                     u32 dst_width, u32 dst_height, size_t bpp) {
+    switch (bpp) {
+    case 1:
+        return NearestNeighbor<1>(input, output, src_width, src_height, dst_width, dst_height);
+    case 2:
+        return NearestNeighbor<2>(input, output, src_width, src_height, dst_width, dst_height);
+    case 4:
+        return NearestNeighbor<4>(input, output, src_width, src_height, dst_width, dst_height);
+    case 8:
+        return NearestNeighbor<8>(input, output, src_width, src_height, dst_width, dst_height);
+    case 16:
+        return NearestNeighbor<16>(input, output, src_width, src_height, dst_width, dst_height);
+    default:
+        UNREACHABLE_MSG("Invalid bytes per pixel {}", bpp);
     }
 }
 
@@ -131,6 +146,7 @@ struct SoftwareBlitEngine::BlitEngineImpl {
     Common::ScratchBuffer<u8> tmp_buffer;
     Common::ScratchBuffer<u8> src_buffer;
     Common::ScratchBuffer<u8> dst_buffer;
+    Common::ScratchBuffer<u8> scaled_buffer;
     Common::ScratchBuffer<f32> intermediate_src;
     Common::ScratchBuffer<f32> intermediate_dst;
     ConverterFactory converter_factory;
@@ -178,6 +194,20 @@ bool SoftwareBlitEngine::Blit(Fermi2D::Surface& src, Fermi2D::Surface& dst,
                         dst_extent_x, dst_extent_y, dst_bytes_per_pixel);
     };
 
+    // Nearest filtering only selects pixels, so scale in the source format and convert the
+    // destination pixels directly
+    const auto conversion_phase_nearest = [&]() {
+        std::span<const u8> scaled = impl->src_buffer;
+        if (src_extent_x != dst_extent_x || src_extent_y != dst_extent_y) {
+            impl->scaled_buffer.resize_destructive(
+                static_cast<size_t>(dst_extent_x) * dst_extent_y * src_bytes_per_pixel);
+            NearestNeighbor(impl->src_buffer, impl->scaled_buffer, src_extent_x, src_extent_y,
+                            dst_extent_x, dst_extent_y, src_bytes_per_pixel);
+            scaled = impl->scaled_buffer;
+        }
+        impl->converter_factory.Convert(src.format, dst.format, scaled, impl->dst_buffer);
+    };
+
     const auto conversion_phase_ir = [&]() {
         auto* input_converter = impl->converter_factory.GetFormatConverter(src.format);
         impl->intermediate_src.resize_destructive((src_copy_size / src_bytes_per_pixel) *
@@ -186,13 +216,8 @@ bool SoftwareBlitEngine::Blit(Fermi2D::Surface& src, Fermi2D::Surface& dst,
                                                   ir_components);
         input_converter->ConvertTo(impl->src_buffer, impl->intermediate_src);
 
-        if (config.filter != Fermi2D::Filter::Bilinear) {
-            NearestNeighborFast(impl->intermediate_src, impl->intermediate_dst, src_extent_x,
-                                src_extent_y, dst_extent_x, dst_extent_y);
-        } else {
-            Bilinear(impl->intermediate_src, impl->intermediate_dst, src_extent_x, src_extent_y,
-                     dst_extent_x, dst_extent_y);
-        }
+        Bilinear(impl->intermediate_src, impl->intermediate_dst, src_extent_x, src_extent_y,
+                 dst_extent_x, dst_extent_y);
 
         auto* output_converter = impl->converter_factory.GetFormatConverter(dst.format);
         output_converter->ConvertFrom(impl->intermediate_dst, impl->dst_buffer);
@@ -212,8 +237,10 @@ bool SoftwareBlitEngine::Blit(Fermi2D::Surface& src, Fermi2D::Surface& dst,
 
     // Conversion Phase
     if (no_passthrough) {
-        if (src.format != dst.format || config.filter == Fermi2D::Filter::Bilinear) {
+        if (config.filter == Fermi2D::Filter::Bilinear) {
             conversion_phase_ir();
+        } else if (src.format != dst.format) {
+            conversion_phase_nearest();
         } else {
             conversion_phase_same_format();
         }
@@ -1,8 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2022 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <span>
 #include <unordered_map>
 
@@ -20,6 +22,9 @@
 
 namespace Tegra::Engines::Blitter {
 
+using VideoCore::Surface::BytesPerBlock;
+using VideoCore::Surface::PixelFormatFromRenderTargetFormat;
+
 enum class Swizzle : size_t {
     R = 0,
     G = 1,
@@ -920,8 +925,107 @@ public:
     ~ConverterImpl() override = default;
 };
 
+/// Value the IR is initialized to, so components missing in the source format are well defined
+constexpr std::array<f32, 4> IR_DEFAULT_PIXEL{0.0f, 0.0f, 0.0f, 1.0f};
+
+/// Number of pixels converted at once through the IR, sized to stay within L1
+constexpr size_t IR_BATCH_PIXELS = 256;
+
+template <class ConverterTraits>
+constexpr bool IsUnorm8x4() {
+    if constexpr (ConverterTraits::num_components != 4) {
+        return false;
+    } else {
+        for (size_t i = 0; i < 4; i++) {
+            if (ConverterTraits::component_types[i] != ComponentType::UNORM ||
+                ConverterTraits::component_sizes[i] != 8) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/// 8-bit UNORM components round trip exactly through the IR, so conversions between these
+/// formats are byte shuffles
+template <class SrcTraits, class DstTraits>
+void ConvertUnorm8x4(std::span<const u8> input, std::span<u8> output) {
+    static_assert(IsUnorm8x4<SrcTraits>() && IsUnorm8x4<DstTraits>());
+    static constexpr size_t no_source = 4;
+    static constexpr auto source_bytes = [] {
+        std::array<size_t, 4> result;
+        for (size_t dst = 0; dst < 4; dst++) {
+            result[dst] = no_source;
+            for (size_t src = 0; src < 4; src++) {
+                if (DstTraits::component_swizzle[dst] != Swizzle::None &&
+                    SrcTraits::component_swizzle[src] == DstTraits::component_swizzle[dst]) {
+                    result[dst] = src;
+                }
+            }
+        }
+        return result;
+    }();
+    static constexpr u32 fill_mask = [] {
+        u32 result = 0;
+        for (size_t dst = 0; dst < 4; dst++) {
+            if (source_bytes[dst] == no_source &&
+                DstTraits::component_swizzle[dst] == Swizzle::A) {
+                result |= 0xffU << (dst * 8);
+            }
+        }
+        return result;
+    }();
+    const size_t num_pixels = output.size() / sizeof(u32);
+    for (size_t pixel = 0; pixel < num_pixels; pixel++) {
+        u32 src_word;
+        std::memcpy(&src_word, &input[pixel * sizeof(u32)], sizeof(u32));
+        u32 dst_word = fill_mask;
+        for (size_t dst = 0; dst < 4; dst++) {
+            if (source_bytes[dst] != no_source) {
+                dst_word |= ((src_word >> (source_bytes[dst] * 8)) & 0xffU) << (dst * 8);
+            }
+        }
+        std::memcpy(&output[pixel * sizeof(u32)], &dst_word, sizeof(u32));
+    }
+}
+
+using DirectConvertFunc = void (*)(std::span<const u8>, std::span<u8>);
+
+template <class SrcTraits>
+DirectConvertFunc GetUnorm8x4Converter(RenderTargetFormat dst_format) {
+    switch (dst_format) {
+    case RenderTargetFormat::A8R8G8B8_UNORM:
+        return &ConvertUnorm8x4<SrcTraits, A8R8G8B8_UNORMTraits>;
+    case RenderTargetFormat::A8B8G8R8_UNORM:
+        return &ConvertUnorm8x4<SrcTraits, A8B8G8R8_UNORMTraits>;
+    case RenderTargetFormat::X8R8G8B8_UNORM:
+        return &ConvertUnorm8x4<SrcTraits, X8R8G8B8_UNORMTraits>;
+    case RenderTargetFormat::X8B8G8R8_UNORM:
+        return &ConvertUnorm8x4<SrcTraits, X8B8G8R8_UNORMTraits>;
+    default:
+        return nullptr;
+    }
+}
+
+DirectConvertFunc GetDirectConverter(RenderTargetFormat src_format,
+                                     RenderTargetFormat dst_format) {
+    switch (src_format) {
+    case RenderTargetFormat::A8R8G8B8_UNORM:
+        return GetUnorm8x4Converter<A8R8G8B8_UNORMTraits>(dst_format);
+    case RenderTargetFormat::A8B8G8R8_UNORM:
+        return GetUnorm8x4Converter<A8B8G8R8_UNORMTraits>(dst_format);
+    case RenderTargetFormat::X8R8G8B8_UNORM:
+        return GetUnorm8x4Converter<X8R8G8B8_UNORMTraits>(dst_format);
+    case RenderTargetFormat::X8B8G8R8_UNORM:
+        return GetUnorm8x4Converter<X8B8G8R8_UNORMTraits>(dst_format);
+    default:
+        return nullptr;
+    }
+}
+
 struct ConverterFactory::ConverterFactoryImpl {
     std::unordered_map<RenderTargetFormat, std::unique_ptr<Converter>> converters_cache;
+    std::array<f32, IR_BATCH_PIXELS * 4> ir_batch;
 };
 
 ConverterFactory::ConverterFactory() {
@@ -938,6 +1042,33 @@ Converter* ConverterFactory::GetFormatConverter(RenderTargetFormat format) {
     return it->second.get();
 }
 
+void ConverterFactory::Convert(RenderTargetFormat src_format, RenderTargetFormat dst_format,
+                               std::span<const u8> input, std::span<u8> output) {
+    if (src_format == dst_format) {
+        std::memcpy(output.data(), input.data(), output.size());
+        return;
+    }
+    if (const DirectConvertFunc direct = GetDirectConverter(src_format, dst_format)) {
+        direct(input, output);
+        return;
+    }
+    const size_t src_bpp = BytesPerBlock(PixelFormatFromRenderTargetFormat(src_format));
+    const size_t dst_bpp = BytesPerBlock(PixelFormatFromRenderTargetFormat(dst_format));
+    const size_t num_pixels = output.size() / dst_bpp;
+    Converter* const input_converter = GetFormatConverter(src_format);
+    Converter* const output_converter = GetFormatConverter(dst_format);
+    for (size_t pixel = 0; pixel < num_pixels; pixel += IR_BATCH_PIXELS) {
+        const size_t batch_pixels = std::min(IR_BATCH_PIXELS, num_pixels - pixel);
+        const std::span<f32> ir(impl->ir_batch.data(), batch_pixels * 4);
+        for (size_t i = 0; i < ir.size(); i += 4) {
+            std::memcpy(&ir[i], IR_DEFAULT_PIXEL.data(), sizeof(IR_DEFAULT_PIXEL));
+        }
+        input_converter->ConvertTo(input.subspan(pixel * src_bpp, batch_pixels * src_bpp), ir);
+        output_converter->ConvertFrom(ir,
+                                      output.subspan(pixel * dst_bpp, batch_pixels * dst_bpp));
+    }
+}
+
 class NullConverter : public Converter {
 public:
     void ConvertTo([[maybe_unused]] std::span<const u8> input, std::span<f32> output) override {
@@ -26,6 +26,14 @@ public:
 
     Converter* GetFormatConverter(RenderTargetFormat format);
 
+    /**
+     * Converts pixels between two formats in batches that stay in cache, using byte shuffles
+     * instead of the float IR when the conversion is exact.
+     * The number of pixels is deduced from the size of the output.
+     */
+    void Convert(RenderTargetFormat src_format, RenderTargetFormat dst_format,
+                 std::span<const u8> input, std::span<u8> output);
+
 private:
     Converter* BuildConverter(RenderTargetFormat format);
 
@@ -112,19 +112,22 @@ void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
         }
 
         auto hle_program = hle_macros->GetHLEProgram(cache_info.hash);
-        if (!hle_program || Settings::values.disable_macro_hle) {
-            maxwell3d.RefreshParameters();
-            cache_info.lle_program->Execute(parameters, method);
-        } else {
+        if (hle_program && !Settings::values.disable_macro_hle) {
             cache_info.has_hle_program = true;
             cache_info.hle_program = std::move(hle_program);
-            MICROPROFILE_SCOPE(MacroHLE);
-            cache_info.hle_program->Execute(parameters, method);
         }
-
         if (Settings::values.dump_macros) {
             Dump(cache_info.hash, macro_code->second, cache_info.has_hle_program);
         }
+
+        // Executing may compile other macros and move cache_info, only the program is stable
+        if (cache_info.has_hle_program) {
+            MICROPROFILE_SCOPE(MacroHLE);
+            cache_info.hle_program->Execute(parameters, method);
+        } else {
+            maxwell3d.RefreshParameters();
+            cache_info.lle_program->Execute(parameters, method);
+        }
     }
 }
 
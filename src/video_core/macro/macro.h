@@ -8,6 +8,7 @@
 #include <vector>
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/flat_hash_map.h"
 
 namespace Tegra {
 
@@ -134,7 +135,7 @@ private:
         bool has_hle_program{};
     };
 
-    std::unordered_map<u32, CacheInfo> macro_cache;
+    Common::FlatHashMap<u32, CacheInfo> macro_cache;
     std::unordered_map<u32, std::vector<u32>> uploaded_macro_code;
     std::unique_ptr<HLEMacro> hle_macros;
     Engines::Maxwell3D& maxwell3d;
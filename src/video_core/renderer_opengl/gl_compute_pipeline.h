@@ -27,6 +27,7 @@ struct Info;
 namespace OpenGL {
 
 class Device;
+class ProgramBinaryCache;
 class ProgramManager;
 
 struct ComputePipelineKey {
@@ -50,7 +51,8 @@ class ComputePipeline {
 public:
     explicit ComputePipeline(const Device& device, TextureCache& texture_cache_,
                              BufferCache& buffer_cache_, ProgramManager& program_manager_,
-                             const Shader::Info& info_, std::string code, std::vector<u32> code_v,
+                             ProgramBinaryCache* binary_cache, const Shader::Info& info_,
+                             std::string code, std::vector<u32> code_v,
                              bool force_context_flush = false);
 
     void Configure();
@@ -236,6 +236,13 @@ Device::Device(Core::Frontend::EmuWindow& emu_window) {
         }
     }
     has_lmem_perf_bug = is_nvidia;
+    has_program_binary = GetInteger<GLint>(GL_NUM_PROGRAM_BINARY_FORMATS) > 0;
+    has_parallel_shader_compile = GLAD_GL_KHR_parallel_shader_compile;
+    if (has_parallel_shader_compile) {
+        // Let the driver pick as many compiler threads as it deems appropriate
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    driver_identifier = fmt::format("{}|{}|{}", vendor_name, renderer, version);
 
     strict_context_required = emu_window.StrictContextRequired();
     // Blocks Intel OpenGL drivers on Windows from using asynchronous shader compilation.
@@ -251,6 +258,7 @@ Device::Device(Core::Frontend::EmuWindow& emu_window) {
     LOG_INFO(Render_OpenGL, "Renderer_PreciseBug: {}", has_precise_bug);
     LOG_INFO(Render_OpenGL, "Renderer_BrokenTextureViewFormats: {}",
              has_broken_texture_view_formats);
+    LOG_INFO(Render_OpenGL, "Renderer_ParallelShaderCompile: {}", has_parallel_shader_compile);
     if (Settings::values.use_asynchronous_shaders.GetValue() && !use_asynchronous_shaders) {
         LOG_WARNING(Render_OpenGL, "Asynchronous shader compilation enabled but not supported");
     }
@@ -196,6 +196,19 @@ public:
         return has_lmem_perf_bug;
     }
 
+    bool HasProgramBinary() const {
+        return has_program_binary;
+    }
+
+    bool HasParallelShaderCompile() const {
+        return has_parallel_shader_compile;
+    }
+
+    /// Returns a string identifying the driver build, used to invalidate program binaries
+    const std::string& GetDriverIdentifier() const {
+        return driver_identifier;
+    }
+
 private:
     static bool TestVariableAoffi();
     static bool TestPreciseBug();
@@ -243,8 +256,11 @@ private:
     bool strict_context_required{};
     bool supports_conditional_barriers{};
     bool has_lmem_perf_bug{};
+    bool has_program_binary{};
+    bool has_parallel_shader_compile{};
 
     std::string vendor_name;
+    std::string driver_identifier;
 };
 
 } // namespace OpenGL
@@ -10,6 +10,7 @@
 #include "common/thread_worker.h"
 #include "shader_recompiler/shader_info.h"
 #include "video_core/renderer_opengl/gl_graphics_pipeline.h"
+#include "video_core/renderer_opengl/gl_program_binary_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_state_tracker.h"
@@ -172,13 +173,14 @@ ConfigureFuncPtr ConfigureFunc(const std::array<Shader::Info, 5>& infos, u32 ena
 GraphicsPipeline::GraphicsPipeline(const Device& device, TextureCache& texture_cache_,
                                    BufferCache& buffer_cache_, ProgramManager& program_manager_,
                                    StateTracker& state_tracker_, ShaderWorker* thread_worker,
+                                   ProgramBinaryCache* binary_cache_,
                                    VideoCore::ShaderNotify* shader_notify,
                                    std::array<std::string, 5> sources,
                                    std::array<std::vector<u32>, 5> sources_spirv,
                                    const std::array<const Shader::Info*, 5>& infos,
                                    const GraphicsPipelineKey& key_, bool force_context_flush)
     : texture_cache{texture_cache_}, buffer_cache{buffer_cache_}, program_manager{program_manager_},
-      state_tracker{state_tracker_}, key{key_} {
+      state_tracker{state_tracker_}, key{key_}, binary_cache{binary_cache_} {
     if (shader_notify) {
         shader_notify->MarkShaderBuilding();
     }
@@ -231,14 +233,31 @@ GraphicsPipeline::GraphicsPipeline(const Device& device, TextureCache& texture_c
         GenerateTransformFeedbackState();
     }
     const bool in_parallel = thread_worker != nullptr;
+    // Without a worker thread, let the driver link in its own threads when it can do so and
+    // poll for completion instead of blocking the GPU thread on first use
+    uses_parallel_link =
+        !in_parallel && !force_context_flush && device.HasParallelShaderCompile() &&
+        backend != Settings::ShaderBackend::Glasm;
     auto func{[this, sources_ = std::move(sources), sources_spirv_ = std::move(sources_spirv),
                shader_notify, backend, in_parallel,
                force_context_flush](ShaderContext::Context*) mutable {
+        const auto create_program{[this](size_t stage, const auto& source) {
+            if (!binary_cache) {
+                source_programs[stage] = CreateProgram(source, Stage(stage));
+                return;
+            }
+            const u64 binary_key{ProgramBinaryCache::Key(source, Stage(stage))};
+            source_programs[stage] = binary_cache->LoadProgram(binary_key);
+            if (source_programs[stage].handle == 0) {
+                source_programs[stage] = CreateProgram(source, Stage(stage), true);
+                pending_binary_keys[stage] = binary_key;
+            }
+        }};
         for (size_t stage = 0; stage < 5; ++stage) {
             switch (backend) {
             case Settings::ShaderBackend::Glsl:
                 if (!sources_[stage].empty()) {
-                    source_programs[stage] = CreateProgram(sources_[stage], Stage(stage));
+                    create_program(stage, std::string_view{sources_[stage]});
                 }
                 break;
             case Settings::ShaderBackend::Glasm:
@@ -249,12 +268,14 @@ GraphicsPipeline::GraphicsPipeline(const Device& device, TextureCache& texture_c
                 break;
             case Settings::ShaderBackend::SpirV:
                 if (!sources_spirv_[stage].empty()) {
-                    source_programs[stage] = CreateProgram(sources_spirv_[stage], Stage(stage));
+                    create_program(stage, std::span<const u32>{sources_spirv_[stage]});
                 }
                 break;
             }
         }
-        if (force_context_flush || in_parallel) {
+        if (uses_parallel_link) {
+            // Built state is polled in IsBuilt
+        } else if (force_context_flush || in_parallel) {
             std::scoped_lock lock{built_mutex};
             built_fence.Create();
             // Flush this context to ensure compilation commands and fence are in the GPU pipe.
@@ -263,6 +284,9 @@ GraphicsPipeline::GraphicsPipeline(const Device& device, TextureCache& texture_c
         } else {
             is_built = true;
         }
+        if (!uses_parallel_link) {
+            StoreProgramBinaries();
+        }
         if (shader_notify) {
             shader_notify->MarkShaderComplete();
         }
@@ -615,6 +639,11 @@ void GraphicsPipeline::GenerateTransformFeedbackState() {
 }
 
 void GraphicsPipeline::WaitForBuild() {
+    if (uses_parallel_link) {
+        // The driver blocks on first use of a program that is still being linked
+        FinishParallelLink();
+        return;
+    }
     if (built_fence.handle == 0) {
         std::unique_lock lock{built_mutex};
         built_condvar.wait(lock, [this] { return built_fence.handle != 0; });
@@ -627,6 +656,15 @@ bool GraphicsPipeline::IsBuilt() noexcept {
     if (is_built) {
         return true;
     }
+    if (uses_parallel_link) {
+        const bool is_linked{std::ranges::all_of(source_programs, [](const OGLProgram& program) {
+            return program.handle == 0 || IsProgramLinked(program.handle);
+        })};
+        if (is_linked) {
+            FinishParallelLink();
+        }
+        return is_built;
+    }
     if (built_fence.handle == 0) {
         return false;
     }
@@ -634,4 +672,21 @@ bool GraphicsPipeline::IsBuilt() noexcept {
     return is_built;
 }
 
+void GraphicsPipeline::FinishParallelLink() {
+    StoreProgramBinaries();
+    is_built = true;
+}
+
+void GraphicsPipeline::StoreProgramBinaries() {
+    if (!binary_cache) {
+        return;
+    }
+    for (size_t stage = 0; stage < source_programs.size(); ++stage) {
+        if (pending_binary_keys[stage] != 0) {
+            binary_cache->StoreProgram(pending_binary_keys[stage], source_programs[stage].handle);
+            pending_binary_keys[stage] = 0;
+        }
+    }
+}
+
 } // namespace OpenGL
@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <fstream>
+
+#include "common/cityhash.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "video_core/renderer_opengl/gl_device.h"
+#include "video_core/renderer_opengl/gl_program_binary_cache.h"
+
+namespace OpenGL {
+namespace {
+constexpr std::array<char, 8> MAGIC_NUMBER{'u', 'z', 'u', 'y', 'g', 'l', 'p', 'b'};
+constexpr u32 CACHE_VERSION = 1;
+
+/// Binaries larger than this are considered corrupted
+constexpr u32 MAX_BINARY_SIZE = 64 * 1024 * 1024;
+} // Anonymous namespace
+
+ProgramBinaryCache::ProgramBinaryCache(const Device& device)
+    : enabled{device.HasProgramBinary() &&
+              device.GetShaderBackend() != Settings::ShaderBackend::Glasm},
+      driver_hash{Common::CityHash64(device.GetDriverIdentifier().data(),
+                                     device.GetDriverIdentifier().size())} {}
+
+ProgramBinaryCache::~ProgramBinaryCache() {
+    if (num_hits > 0) {
+        LOG_INFO(Render_OpenGL, "Program binary cache hits: {}", num_hits);
+    }
+}
+
+void ProgramBinaryCache::Load(const std::filesystem::path& filename) try {
+    if (!enabled) {
+        return;
+    }
+    std::scoped_lock lock{mutex};
+    cache_filename = filename;
+    entries.clear();
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return;
+    }
+    file.exceptions(std::ifstream::failbit);
+    const auto end{file.tellg()};
+    file.seekg(0, std::ios::beg);
+
+    std::array<char, 8> magic_number;
+    u32 cache_version;
+    u64 file_driver_hash;
+    file.read(magic_number.data(), magic_number.size())
+        .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version))
+        .read(reinterpret_cast<char*>(&file_driver_hash), sizeof(file_driver_hash));
+    if (magic_number != MAGIC_NUMBER || cache_version != CACHE_VERSION ||
+        file_driver_hash != driver_hash) {
+        file.close();
+        LOG_INFO(Render_OpenGL, "Program binary cache is outdated, removing it");
+        if (!Common::FS::RemoveFile(filename)) {
+            LOG_ERROR(Common_Filesystem, "Failed to delete program binary cache file {}",
+                      Common::FS::PathToUTF8String(filename));
+        }
+        return;
+    }
+    while (file.tellg() != end) {
+        u64 key;
+        Entry entry;
+        u32 size;
+        file.read(reinterpret_cast<char*>(&key), sizeof(key))
+            .read(reinterpret_cast<char*>(&entry.format), sizeof(entry.format))
+            .read(reinterpret_cast<char*>(&size), sizeof(size));
+        if (size > MAX_BINARY_SIZE) {
+            throw std::ios_base::failure("Invalid program binary size");
+        }
+        entry.data.resize(size);
+        file.read(reinterpret_cast<char*>(entry.data.data()), size);
+        entries.insert_or_assign(key, std::move(entry));
+    }
+    LOG_INFO(Render_OpenGL, "Loaded {} program binaries", entries.size());
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    entries.clear();
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete program binary cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+    }
+}
+
+u64 ProgramBinaryCache::Key(std::string_view code, GLenum stage) {
+    return Common::CityHash64WithSeed(code.data(), code.size(), static_cast<u64>(stage));
+}
+
+u64 ProgramBinaryCache::Key(std::span<const u32> code, GLenum stage) {
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(code.data()),
+                                      code.size_bytes(), static_cast<u64>(stage));
+}
+
+OGLProgram ProgramBinaryCache::LoadProgram(u64 key) {
+    OGLProgram program;
+    if (!enabled) {
+        return program;
+    }
+    std::scoped_lock lock{mutex};
+    const auto it{entries.find(key)};
+    if (it == entries.end()) {
+        return program;
+    }
+    const Entry& entry{it->second};
+    program.handle = glCreateProgram();
+    glProgramParameteri(program.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramBinary(program.handle, entry.format, entry.data.data(),
+                    static_cast<GLsizei>(entry.data.size()));
+    GLint link_status{};
+    glGetProgramiv(program.handle, GL_LINK_STATUS, &link_status);
+    if (link_status == GL_FALSE) {
+        // The driver may reject binaries after an update that keeps the same version string
+        LOG_WARNING(Render_OpenGL, "Program binary 0x{:016x} rejected by the driver", key);
+        entries.erase(it);
+        program.Release();
+        return program;
+    }
+    ++num_hits;
+    return program;
+}
+
+void ProgramBinaryCache::StoreProgram(u64 key, GLuint program) {
+    if (!enabled) {
+        return;
+    }
+    GLint link_status{};
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+    if (link_status == GL_FALSE) {
+        return;
+    }
+    GLint length{};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    Entry entry;
+    entry.data.resize(static_cast<size_t>(length));
+    glGetProgramBinary(program, length, nullptr, &entry.format, entry.data.data());
+
+    std::scoped_lock lock{mutex};
+    const auto [it, is_new]{entries.try_emplace(key, std::move(entry))};
+    if (is_new) {
+        Append(key, it->second);
+    }
+}
+
+void ProgramBinaryCache::Append(u64 key, const Entry& entry) try {
+    if (cache_filename.empty()) {
+        return;
+    }
+    std::ofstream file(cache_filename, std::ios::binary | std::ios::ate | std::ios::app);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open program binary cache file {}",
+                  Common::FS::PathToUTF8String(cache_filename));
+        return;
+    }
+    file.exceptions(std::ofstream::failbit);
+    if (file.tellp() == 0) {
+        // Write header
+        file.write(MAGIC_NUMBER.data(), MAGIC_NUMBER.size())
+            .write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION))
+            .write(reinterpret_cast<const char*>(&driver_hash), sizeof(driver_hash));
+    }
+    const u32 size{static_cast<u32>(entry.data.size())};
+    file.write(reinterpret_cast<const char*>(&key), sizeof(key))
+        .write(reinterpret_cast<const char*>(&entry.format), sizeof(entry.format))
+        .write(reinterpret_cast<const char*>(&size), sizeof(size))
+        .write(reinterpret_cast<const char*>(entry.data.data()), size);
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    if (!Common::FS::RemoveFile(cache_filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete program binary cache file {}",
+                  Common::FS::PathToUTF8String(cache_filename));
+    }
+}
+
+} // namespace OpenGL
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+class Device;
+
+/// Persistent cache of linked GL program binaries.
+/// Programs are keyed by a hash of their stage and source, binaries are only reused on the same
+/// driver identifier they were retrieved from.
+class ProgramBinaryCache {
+public:
+    explicit ProgramBinaryCache(const Device& device);
+    ~ProgramBinaryCache();
+
+    /// Loads all binaries stored in the given file and appends new binaries to it.
+    /// Discards the file contents when they were generated by a different driver.
+    void Load(const std::filesystem::path& filename);
+
+    /// Returns true when binaries can be retrieved and stored
+    [[nodiscard]] bool IsEnabled() const noexcept {
+        return enabled;
+    }
+
+    /// Returns the cache key of a GLSL program
+    [[nodiscard]] static u64 Key(std::string_view code, GLenum stage);
+
+    /// Returns the cache key of a SPIR-V program
+    [[nodiscard]] static u64 Key(std::span<const u32> code, GLenum stage);
+
+    /// Creates a program from a cached binary, returns an empty program on miss or when the
+    /// driver rejects the binary
+    [[nodiscard]] OGLProgram LoadProgram(u64 key);
+
+    /// Retrieves the binary of a linked program and stores it, blocks until linking finishes
+    void StoreProgram(u64 key, GLuint program);
+
+    /// Number of programs created from cached binaries
+    [[nodiscard]] size_t NumHits() const noexcept {
+        return num_hits;
+    }
+
+private:
+    struct Entry {
+        GLenum format{};
+        std::vector<u8> data;
+    };
+
+    void Append(u64 key, const Entry& entry);
+
+    bool enabled{};
+    u64 driver_hash{};
+
+    std::mutex mutex;
+    std::filesystem::path cache_filename;
+    std::unordered_map<u64, Entry> entries;
+    size_t num_hits{};
+};
+
+} // namespace OpenGL
@@ -247,7 +247,8 @@ ShaderCache::ShaderCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
           .min_ssbo_alignment = static_cast<u32>(device.GetShaderStorageBufferAlignment()),
           .support_geometry_shader_passthrough = device.HasGeometryShaderPassthrough(),
           .support_conditional_barrier = device.SupportsConditionalBarriers(),
-      } {
+      },
+      program_binary_cache{device} {
     if (use_asynchronous_shaders) {
         workers = CreateWorkers();
     }
@@ -267,6 +268,7 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         return;
     }
     shader_cache_filename = base_dir / "opengl.bin";
+    program_binary_cache.Load(base_dir / "opengl_binaries.bin");
 
     if (!workers && !strict_context_required) {
         workers = CreateWorkers();
@@ -287,7 +289,7 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         if (strict_context_required) {
             work(&strict_context.value());
         } else {
-            workers->QueueWork(std::move(work));
+            workers->QueueWork(std::move(work), Common::WorkPriority::Background);
         }
     }};
     const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
@@ -542,10 +544,13 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline(
         }
         previous_program = &program;
     }
-    auto* const thread_worker{use_shader_workers ? workers.get() : nullptr};
-    return std::make_unique<GraphicsPipeline>(device, texture_cache, buffer_cache, program_manager,
-                                              state_tracker, thread_worker, &shader_notify, sources,
-                                              sources_spirv, infos, key, force_context_flush);
+    // Drivers with GL_KHR_parallel_shader_compile link in their own threads, building from the
+    // GPU thread and polling for completion avoids the shared context worker round trip
+    const bool use_driver_threads{device.HasParallelShaderCompile() && !use_glasm};
+    auto* const thread_worker{use_shader_workers && !use_driver_threads ? workers.get() : nullptr};
+    return std::make_unique<GraphicsPipeline>(
+        device, texture_cache, buffer_cache, program_manager, state_tracker, thread_worker,
+        BinaryCache(), &shader_notify, sources, sources_spirv, infos, key, force_context_flush);
 
 } catch (Shader::Exception& exception) {
     LOG_ERROR(Render_OpenGL, "{}", exception.what());
@@ -601,12 +606,17 @@ std::unique_ptr<ComputePipeline> ShaderCache::CreateComputePipeline(
     }
 
     return std::make_unique<ComputePipeline>(device, texture_cache, buffer_cache, program_manager,
-                                             program.info, code, code_spirv, force_context_flush);
+                                             BinaryCache(), program.info, code, code_spirv,
+                                             force_context_flush);
 } catch (Shader::Exception& exception) {
     LOG_ERROR(Render_OpenGL, "{}", exception.what());
     return nullptr;
 }
 
+ProgramBinaryCache* ShaderCache::BinaryCache() noexcept {
+    return program_binary_cache.IsEnabled() ? &program_binary_cache : nullptr;
+}
+
 std::unique_ptr<ShaderWorker> ShaderCache::CreateWorkers() const {
     return std::make_unique<ShaderWorker>(std::max(std::thread::hardware_concurrency(), 2U) - 1,
                                           "GlShaderBuilder",
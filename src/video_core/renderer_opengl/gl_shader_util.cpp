@@ -11,10 +11,13 @@
 
 namespace OpenGL {
 
-static OGLProgram LinkSeparableProgram(GLuint shader) {
+static OGLProgram LinkSeparableProgram(GLuint shader, bool retrievable) {
     OGLProgram program;
     program.handle = glCreateProgram();
     glProgramParameteri(program.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    if (retrievable) {
+        glProgramParameteri(program.handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glAttachShader(program.handle, shader);
     glLinkProgram(program.handle);
     glDetachShader(program.handle, shader);
@@ -62,7 +65,7 @@ static void LogShader(GLuint shader, std::string_view code = {}) {
     }
 }
 
-OGLProgram CreateProgram(std::string_view code, GLenum stage) {
+OGLProgram CreateProgram(std::string_view code, GLenum stage, bool retrievable) {
     OGLShader shader;
     shader.handle = glCreateShader(stage);
 
@@ -73,10 +76,10 @@ OGLProgram CreateProgram(std::string_view code, GLenum stage) {
     if (Settings::values.renderer_debug) {
         LogShader(shader.handle, code);
     }
-    return LinkSeparableProgram(shader.handle);
+    return LinkSeparableProgram(shader.handle, retrievable);
 }
 
-OGLProgram CreateProgram(std::span<const u32> code, GLenum stage) {
+OGLProgram CreateProgram(std::span<const u32> code, GLenum stage, bool retrievable) {
     OGLShader shader;
     shader.handle = glCreateShader(stage);
 
@@ -86,7 +89,16 @@ OGLProgram CreateProgram(std::span<const u32> code, GLenum stage) {
     if (Settings::values.renderer_debug) {
         LogShader(shader.handle);
     }
-    return LinkSeparableProgram(shader.handle);
+    return LinkSeparableProgram(shader.handle, retrievable);
+}
+
+bool IsProgramLinked(GLuint program) {
+    if (!GLAD_GL_KHR_parallel_shader_compile) {
+        return true;
+    }
+    GLint completion_status{};
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completion_status);
+    return completion_status == GL_TRUE;
 }
 
 OGLAssemblyProgram CompileProgram(std::string_view code, GLenum target) {
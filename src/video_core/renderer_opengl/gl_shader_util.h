@@ -12,9 +12,15 @@
 
 namespace OpenGL {
 
-OGLProgram CreateProgram(std::string_view code, GLenum stage);
+/// Compiles and links a separable program. When retrievable is true, the driver is hinted that the
+/// program binary will be queried with glGetProgramBinary after linking.
+OGLProgram CreateProgram(std::string_view code, GLenum stage, bool retrievable = false);
 
-OGLProgram CreateProgram(std::span<const u32> code, GLenum stage);
+OGLProgram CreateProgram(std::span<const u32> code, GLenum stage, bool retrievable = false);
+
+/// Returns true when the program has finished linking, never blocks when
+/// GL_KHR_parallel_shader_compile is available
+bool IsProgramLinked(GLuint program);
 
 OGLAssemblyProgram CompileProgram(std::string_view code, GLenum target);
 
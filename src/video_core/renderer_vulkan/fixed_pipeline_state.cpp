@@ -5,8 +5,8 @@
 #include <cstring>
 
 #include "common/bit_cast.h"
-#include "common/cityhash.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/polyfill_ranges.h"
 #include "video_core/engines/draw_manager.h"
 #include "video_core/renderer_vulkan/fixed_pipeline_state.h"
@@ -261,7 +261,7 @@ void FixedPipelineState::DynamicState::Refresh3(const Maxwell& regs) {
 }
 
 size_t FixedPipelineState::Hash() const noexcept {
-    const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(this), Size());
+    const u64 hash = Common::HashFast64(this, Size());
     return static_cast<size_t>(hash);
 }
 
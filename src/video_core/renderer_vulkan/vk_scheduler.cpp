@@ -10,6 +10,7 @@
 
 #include "common/microprofile.h"
 #include "common/thread.h"
+#include "common/trace.h"
 #include "video_core/renderer_vulkan/vk_command_pool.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
@@ -180,6 +181,7 @@ void Scheduler::WorkerThread(std::stop_token stop_token) {
 
             // Perform the work, tracking whether the chunk was a submission
             // before executing.
+            TRACE_SCOPE("Vulkan worker: Execute chunk");
             const bool has_submit = work->HasSubmit();
             work->ExecuteAll(current_cmdbuf, current_upload_cmdbuf);
 
@@ -16,6 +16,7 @@
 #include <queue>
 
 #include "common/common_types.h"
+#include "common/flat_hash_map.h"
 #include "common/hash.h"
 #include "common/literals.h"
 #include "common/lru_cache.h"
@@ -63,7 +64,8 @@ struct AsyncDecodeContext {
     std::atomic_bool complete;
 };
 
-using TextureCacheGPUMap = std::unordered_map<u64, std::vector<ImageId>, Common::IdentityHash<u64>>;
+using TextureCacheGPUMap =
+    Common::FlatHashMap<u64, std::vector<ImageId>, Common::IdentityHash<u64>>;
 
 class TextureCacheChannelInfo : public ChannelInfo {
 public:
@@ -82,8 +84,8 @@ public:
     std::vector<SamplerId> compute_sampler_ids;
     std::vector<ImageViewId> compute_image_view_ids;
 
-    std::unordered_map<TICEntry, ImageViewId> image_views;
-    std::unordered_map<TSCEntry, SamplerId> samplers;
+    Common::FlatHashMap<TICEntry, ImageViewId> image_views;
+    Common::FlatHashMap<TSCEntry, SamplerId> samplers;
 
     TextureCacheGPUMap* gpu_page_table;
     TextureCacheGPUMap* sparse_page_table;
@@ -431,7 +433,7 @@ private:
 
     std::unordered_map<RenderTargets, FramebufferId> framebuffers;
 
-    std::unordered_map<u64, std::vector<ImageMapId>, Common::IdentityHash<u64>> page_table;
+    Common::FlatHashMap<u64, std::vector<ImageMapId>, Common::IdentityHash<u64>> page_table;
     std::unordered_map<ImageId, boost::container::small_vector<ImageViewId, 16>> sparse_views;
 
     DAddr virtual_invalid_space{};
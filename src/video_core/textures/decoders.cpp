@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2018 uzuy Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstring>
@@ -174,6 +175,29 @@ void Swizzle(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixe
     }
 }
 
+/// Swizzled layout of the rows of the first slice of a block linear surface
+struct BlockLinearRows {
+    explicit BlockLinearRows(u32 width_in_bytes, u32 block_height_, u32 block_depth)
+        : block_height{block_height_}, block_height_mask{(1U << block_height_) - 1},
+          x_shift{GOB_SIZE_SHIFT + block_height_ + block_depth},
+          block_size{Common::DivCeilLog2(width_in_bytes, GOB_SIZE_X_SHIFT) << x_shift} {}
+
+    u32 RowOffset(u32 y) const {
+        const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
+        return (block_y >> block_height) * block_size +
+               ((block_y & block_height_mask) << GOB_SIZE_SHIFT) + pdep<SWIZZLE_Y_BITS>(y);
+    }
+
+    u32 ColumnOffset(u32 x) const {
+        return ((x >> GOB_SIZE_X_SHIFT) << x_shift) + pdep<SWIZZLE_X_BITS>(x);
+    }
+
+    u32 block_height;
+    u32 block_height_mask;
+    u32 x_shift;
+    u32 block_size;
+};
+
 } // Anonymous namespace
 
 void UnswizzleTexture(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
@@ -246,6 +270,36 @@ void UnswizzleSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes
     }
 }
 
+void CopyBlockLinearSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
+                            u32 src_width, u32 src_origin_x, u32 src_origin_y,
+                            u32 src_block_height, u32 src_block_depth, u32 dst_width,
+                            u32 dst_origin_x, u32 dst_origin_y, u32 dst_block_height,
+                            u32 dst_block_depth, u32 extent_x, u32 extent_y) {
+    // The lower 4 bits of the swizzled X coordinate are linear, so both surfaces are contiguous in
+    // runs of up to 16 bytes. Copy the runs directly instead of pixel by pixel.
+    static constexpr u32 RUN_SIZE = 16;
+    static_assert((SWIZZLE_X_BITS & (RUN_SIZE - 1)) == RUN_SIZE - 1);
+
+    const BlockLinearRows src{src_width * bytes_per_pixel, src_block_height, src_block_depth};
+    const BlockLinearRows dst{dst_width * bytes_per_pixel, dst_block_height, dst_block_depth};
+    const u32 line_size = extent_x * bytes_per_pixel;
+    for (u32 line = 0; line < extent_y; ++line) {
+        const u32 src_row = src.RowOffset(src_origin_y + line);
+        const u32 dst_row = dst.RowOffset(dst_origin_y + line);
+        u32 src_x = src_origin_x * bytes_per_pixel;
+        u32 dst_x = dst_origin_x * bytes_per_pixel;
+        for (u32 copied = 0; copied < line_size;) {
+            const u32 run = std::min({RUN_SIZE - (src_x % RUN_SIZE), RUN_SIZE - (dst_x % RUN_SIZE),
+                                      line_size - copied});
+            std::memcpy(&output[dst_row + dst.ColumnOffset(dst_x)],
+                        &input[src_row + src.ColumnOffset(src_x)], run);
+            src_x += run;
+            dst_x += run;
+            copied += run;
+        }
+    }
+}
+
 std::size_t CalculateSize(bool tiled, u32 bytes_per_pixel, u32 width, u32 height, u32 depth,
                           u32 block_height, u32 block_depth) {
     if (tiled) {
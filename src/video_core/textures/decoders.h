@@ -65,6 +65,14 @@ void UnswizzleSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes
                       u32 width, u32 height, u32 depth, u32 origin_x, u32 origin_y, u32 extent_x,
                       u32 extent_y, u32 block_height, u32 block_depth, u32 pitch_linear);
 
+/// Copies a tiled subrectangle into another tiled surface without going through linear memory.
+/// Only the first slice of both surfaces is accessed, bytes_per_pixel must be a power of two.
+void CopyBlockLinearSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
+                            u32 src_width, u32 src_origin_x, u32 src_origin_y,
+                            u32 src_block_height, u32 src_block_depth, u32 dst_width,
+                            u32 dst_origin_x, u32 dst_origin_y, u32 dst_block_height,
+                            u32 dst_block_depth, u32 extent_x, u32 extent_y);
+
 /// Obtains the offset of the gob for positions 'dst_x' & 'dst_y'
 u64 GetGOBOffset(u32 width, u32 height, u32 dst_x, u32 dst_y, u32 block_height,
                  u32 bytes_per_pixel);
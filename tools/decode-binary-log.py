@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: Copyright 2024 uzuy Emulator Project
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# Converts a binary log written with binary_logging enabled (uzuy_log.bin) to the text format
+# of uzuy_log.txt. Usage: decode-binary-log.py uzuy_log.bin [output.txt]
+
+import struct
+import sys
+
+MAGIC = b'UZLOGBIN'
+VERSION = 1
+
+RECORD_STRING = 0
+RECORD_MESSAGE = 1
+RECORD_TEXT = 2
+
+ARG_BOOL, ARG_CHAR, ARG_SIGNED, ARG_UNSIGNED, ARG_FLOAT, ARG_DOUBLE, ARG_POINTER = range(7)
+
+
+class Bool:
+    def __init__(self, value):
+        self.value = value
+
+    def __format__(self, spec):
+        if spec and spec[-1] in 'bBdoxXc':
+            return format(int(self.value), spec)
+        return format('true' if self.value else 'false', spec)
+
+
+class Pointer:
+    def __init__(self, value):
+        self.value = value
+
+    def __format__(self, spec):
+        return format('0x{:x}'.format(self.value), spec)
+
+
+class Float:
+    def __init__(self, value):
+        self.value = value
+
+    def __format__(self, spec):
+        if spec:
+            return format(self.value, spec)
+        # fmt prints the shortest representation that round-trips as a float
+        for precision in range(1, 10):
+            text = '{:.{}g}'.format(self.value, precision)
+            if struct.unpack('<f', struct.pack('<f', float(text)))[0] == self.value:
+                return text
+        return repr(self.value)
+
+
+def decode_arg(arg_type, value):
+    if arg_type == ARG_BOOL:
+        return Bool(value != 0)
+    if arg_type == ARG_CHAR:
+        return chr(value & 0xff)
+    if arg_type == ARG_SIGNED:
+        return struct.unpack('<q', struct.pack('<Q', value))[0]
+    if arg_type == ARG_UNSIGNED:
+        return value
+    if arg_type == ARG_FLOAT:
+        return Float(struct.unpack('<f', struct.pack('<I', value & 0xffffffff))[0])
+    if arg_type == ARG_DOUBLE:
+        return struct.unpack('<d', struct.pack('<Q', value))[0]
+    if arg_type == ARG_POINTER:
+        return Pointer(value)
+    raise ValueError('Unknown argument type {}'.format(arg_type))
+
+
+def format_message(format_string, args):
+    try:
+        return format_string.format(*args)
+    except (ValueError, IndexError, KeyError) as e:
+        return '{} (format error: {})'.format(format_string, e)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def done(self):
+        return self.offset >= len(self.data)
+
+    def read(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += struct.calcsize(fmt)
+        return values
+
+    def read_string(self):
+        (length,) = self.read('<I')
+        text = self.data[self.offset:self.offset + length].decode('utf-8', errors='replace')
+        self.offset += length
+        return text
+
+
+def decode(data, out):
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError('Not a binary log file')
+    reader = Reader(data)
+    reader.offset = len(MAGIC)
+    (version,) = reader.read('<I')
+    if version != VERSION:
+        raise ValueError('Unsupported binary log version {}'.format(version))
+
+    strings = {}
+    while not reader.done():
+        (record_type,) = reader.read('<B')
+        if record_type == RECORD_STRING:
+            (string_id,) = reader.read('<Q')
+            strings[string_id] = reader.read_string()
+            continue
+
+        timestamp, class_id, level_id, filename_id, line_num, function_id = reader.read('<QQQQIQ')
+        if record_type == RECORD_MESSAGE:
+            format_id, num_args = reader.read('<QB')
+            args = [decode_arg(*reader.read('<BQ')) for _ in range(num_args)]
+            message = format_message(strings[format_id], args)
+        elif record_type == RECORD_TEXT:
+            message = reader.read_string()
+        else:
+            raise ValueError('Unknown record type {} at offset {}'.format(record_type,
+                                                                          reader.offset - 1))
+
+        out.write('[{:4d}.{:06d}] {} <{}> {}:{}:{}: {}\n'.format(
+            timestamp // 1000000, timestamp % 1000000, strings[class_id], strings[level_id],
+            strings[filename_id], strings[function_id], line_num, message))
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        print('Usage: {} uzuy_log.bin [output.txt]'.format(sys.argv[0]), file=sys.stderr)
+        return 1
+    with open(sys.argv[1], 'rb') as f:
+        data = f.read()
+    if len(sys.argv) == 3:
+        with open(sys.argv[2], 'w', encoding='utf-8') as out:
+            decode(data, out)
+    else:
+        decode(data, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())